@@ -43,6 +43,10 @@ echo Compiling Tests...
 
 clang -o sloth_tests $CompilerFlags ../tests/sloth_tests.c $LinkerLibraries
 
+echo Compiling Benchmarks...
+
+clang -o sloth_bench -fdiagnostics-absolute-paths -O2 -g ../tests/sloth_bench.c
+
 echo Compiling Examples...
 
 clang -o sloth_sokol_ft_sample $CompilerFlags ../examples/sloth_sokol_ft_sample.c $LinkerLibraries
@@ -10,7 +10,8 @@
 #include "../sloth/sloth.h"
 
 Sloth_Ctx sloth = {
-  .per_frame_memory.name = "PFM",
+  .per_frame_memory[0].name = "PFM0",
+  .per_frame_memory[1].name = "PFM1",
   .scratch = "scratch",
 };
 
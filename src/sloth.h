@@ -53,8 +53,6 @@
 //
 // TODO
 //   
-// - CLEANUP
-//   - use u16 indices in teh vertex buffer
 // - STYLE IMPROVEMENTS
 //   - border radius, in a way that works with outlines too, regardless
 //     size on screen
@@ -65,9 +63,6 @@
 //   - I suspect this will involve ignoring "value" while the mouse is
 //     down
 // - copying selected text
-// - UTF-8 and UTF-32 Support in fonts and glyphs
-//   - Glpyh IDs should have an 8 bit family and a 32 bit id, so that
-//     the id supports utf8 
 // - Figure out things like weight and bold/italics for font rendering
 // - glyph atlas should use premultiplied alpha
 // - if we use a separate texture for different glyph families, is there 
@@ -85,8 +80,6 @@
 //     based on the number of z-indices used. ie if the z-indices used are 
 //     0 (default), 1 and 2, then z-index 1 gets to take from 75% -> 87.5%, and
 //     z-index 2 gets to take from 87.5% -> 100% of the visible range
-// - widget pool growing reallocates in the middle of a frame. We need to 
-//   turn it into a buffer arena
 // - multi-font-property line heights - right now the last line height used
 //   will be what the entire text block is treated like. Need a more sophisticated
 //   solution.
@@ -94,39 +87,19 @@
 //   - also will require lookahead for each line, since the baseline would be
 //     decided by the highest offset
 // - ability to load in a whole sprite atlas, along with glyph data prebaked
+//   - sloth_glyph_cache_load covers caches sloth wrote itself, but not
+//     atlases from other tools
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 // 
 // OPTIMIZATION CANDIDATES:
 //
-// - widgets currently contain their entire style, layout, and input 
-//   descriptors. Creating pointers to these will make the structure
-//   size of each widget much smaller (especially as style and layout 
-//   continue to grow). 
-//   - One downside is that you'd want to force users to register 
-//     these descriptors so that they have known memory lifetimes. 
-//     On the other hand, this would also reduce duplicate memory
-//     storage of the same descriptor.
-//   - One thing that could work is to hash the descriptors when they
-//     are provided, and either point to an existing one thats already
-//     stored, or store the new one. 
-//     This would require some eviction strategy.
-//   - This might make things like style composability an option
-//     ie. The default for fields becomes (INHERIT OR DEFAULT)
-//     On the other hand, having to loop looking upwards in a hierarchy
-//     isn't great. Maybe at registration time, the actual values for
-//     every field are computed (a styles parent would have to be known
-//     at registration time)
-// 
 // - Turn Glyph_Layout's into a discriminated union that serves one of
 //   several purposes:
 //   - Describe a glyph
 //   - Change active font properties like typeface, size, bold, color, etc.
 //     (effectively, start a span)
-// 
-// - Long Text - odds are, long blocks of text will not all be visible
-//   at once. 
 
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -154,7 +127,7 @@ int main(int argc, char** args)
       
       // Create the widget, and allocate space for the "Button" string glyphs
       Sloth_Widget_Result widget_result = sloth_push_widget_id(sloth, multi_font_widget_desc, id_result.id);
-      sloth_widget_allocate_text(S, widget_result, id_result.display_len);
+      sloth_widget_allocate_text(S, widget_result, sloth_utf8_glyph_count(id_result.formatted, id_result.display_len));
       
       // pushes the 'B' character onto the glyph array as a font_a glyph
       sloth_widget_text_to_glyphs_append(sloth, widget_result, font_a, id_result.formatted, 1);
@@ -187,6 +160,10 @@ int main(int argc, char** args)
 #  define Sloth_U8 unsigned char
 #endif
 
+#ifndef Sloth_U16
+#  define Sloth_U16 unsigned short
+#endif
+
 #ifndef Sloth_U32
 #  define Sloth_U32 unsigned int
 #endif
@@ -229,10 +206,105 @@ int main(int argc, char** args)
 #  define Sloth_Temp_String_Memory_Size 512
 #endif
 
+#ifndef SLOTH_HASHTABLE_CAP_DEFAULT
+#  define SLOTH_HASHTABLE_CAP_DEFAULT 2048
+#endif
+
+#ifndef SLOTH_HASHTABLE_MAX_LOAD_DEFAULT
+#  define SLOTH_HASHTABLE_MAX_LOAD_DEFAULT 0.75f
+#endif
+
+// Set to 1 to back every Sloth_Hashtable (widget_cache_lut, the glyph
+// table, the descriptor luts) with the group probed implementation 
+// rather than the Robin Hood one. See HASHTABLE below
+#ifndef SLOTH_HASHTABLE_SWISS
+#  define SLOTH_HASHTABLE_SWISS 0
+#endif
+
+// The number of frames an interned layout or style can go unused
+// before it is evicted. Can be overridden per Sloth_Ctx
+#ifndef SLOTH_DESC_EVICT_AFTER_FRAMES_DEFAULT
+#  define SLOTH_DESC_EVICT_AFTER_FRAMES_DEFAULT 120
+#endif
+
+// The number of frames an id can go without being pushed before its
+// Sloth_Widget_Cached (including any persistent values) is freed. 
+// Can be overridden per Sloth_Ctx
+#ifndef SLOTH_WIDGET_CACHE_EVICT_AFTER_FRAMES_DEFAULT
+#  define SLOTH_WIDGET_CACHE_EVICT_AFTER_FRAMES_DEFAULT 600
+#endif
+
+// Set to 1 to store vertices as 20 bytes rather than 36. See 
+// Sloth_Vertex_Color
+#ifndef SLOTH_VERTEX_PACKED
+#  define SLOTH_VERTEX_PACKED 0
+#endif
+
+// Set to 1 to draw every glyph atlas from one merged texture, so a
+// frame renders in a single draw call, in painter's order. See 
+// sloth_glyph_atlases_layout_merged_
+#ifndef SLOTH_ATLAS_MERGED
+#  define SLOTH_ATLAS_MERGED 0
+#endif
+
+// The largest the merged texture can get, in pixels on a side. Past
+// this, SLOTH_ATLAS_MERGED falls back to a texture and a draw per
+// atlas. Renderers can lower it with glyph_atlases_merged_max_dim
+#ifndef SLOTH_ATLAS_MERGED_MAX_DIM
+#  define SLOTH_ATLAS_MERGED_MAX_DIM 8192
+#endif
+
+// Set to 0 to back every Sloth_Arena with a list of 1MB heap buckets
+// rather than one reserved range of virtual memory that is committed
+// as it is used. See ARENA below
+#ifndef SLOTH_ARENA_VIRTUAL
+#  if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+#    define SLOTH_ARENA_VIRTUAL 1
+#  else
+#    define SLOTH_ARENA_VIRTUAL 0
+#  endif
+#endif
+
+// The address space reserved by each virtual arena. Nothing is 
+// committed until it is pushed. Can be overridden per arena by 
+// setting Sloth_Arena::reserved before the first push
+#ifndef SLOTH_ARENA_RESERVE_DEFAULT
+#  if defined(_WIN64) || defined(__LP64__)
+#    define SLOTH_ARENA_RESERVE_DEFAULT (1024u * 1024u * 1024u) // 1 GB
+#  else
+#    define SLOTH_ARENA_RESERVE_DEFAULT (64u * 1024u * 1024u)
+#  endif
+#endif
+
+// The granularity virtual arenas commit and decommit memory at
+#ifndef SLOTH_ARENA_COMMIT_SIZE
+#  define SLOTH_ARENA_COMMIT_SIZE (64u * 1024u)
+#endif
+
 #ifndef SLOTH_PROFILE_BEGIN
 #  define SLOTH_PROFILE_BEGIN
 #endif
 
+// NOTE: These wrap each individual pass inside of sloth_frame_prepare
+// and sloth_frame_advance. name is a string literal identifying the
+// pass. See tests/sloth_bench.c for an example of using them to time
+// each pass.
+#ifndef SLOTH_PROFILE_PASS_BEGIN
+#  define SLOTH_PROFILE_PASS_BEGIN(name)
+#endif
+
+#ifndef SLOTH_PROFILE_PASS_END
+#  define SLOTH_PROFILE_PASS_END(name)
+#endif
+
+// By default, sloth_frame_advance computes layout in as few tree
+// walks as possible, handling both axes in a single visit where it can.
+// Defining this as 1 switches to walking the tree once per step, per
+// axis, which is slower but useful for comparison.
+#ifndef SLOTH_LAYOUT_MULTI_PASS
+#  define SLOTH_LAYOUT_MULTI_PASS 0
+#endif
+
 #ifndef SLOTH_FORCE_NO_STDARG
 #  include <stdarg.h>
 #endif
@@ -309,6 +381,25 @@ enum {
 //   a suitable empty slot
 // - Robin Hood Hashing - when probing, keys that will probe more times
 //   are stored first, increasing lookup speed.
+// - Backward Shift Deletion - removing a key shifts the keys after it
+//   back into place, rather than leaving a tombstone behind, so a table
+//   with lots of churn doesn't fill up with dead slots.
+// - Growth - once used slots pass max_load * cap the table is rehashed
+//   into twice as many slots.
+//
+// There is a second, Swiss table style, implementation (the 
+// sloth_hashtable_swiss_ functions) which SLOTH_HASHTABLE_SWISS selects:
+// - Control Bytes - each slot has a byte that is either empty, deleted,
+//   or 7 bits of the key's hash. 
+// - Groups - a key hashes to a group of 16 slots, and all 16 control 
+//   bytes are compared against the key's 7 bits at once with SSE2 or 
+//   NEON, so most lookups only compare one key. Full groups overflow 
+//   into the next group.
+// - Deletion leaves a tombstone only if the slot's group is full, since
+//   a lookup never probes past a group with an empty slot. Tombstones 
+//   count against max_load, and are dropped when the table is rehashed.
+// Both sets of functions are always available, but a table must only 
+// be used with one of them.
 typedef struct Sloth_Hashtable Sloth_Hashtable;
 struct Sloth_Hashtable
 {
@@ -321,25 +412,113 @@ struct Sloth_Hashtable
   
   // The total number of registered values
   Sloth_U32  used;
+  
+  // One control byte per slot, and the number of slots holding 
+  // tombstones. Only used by the swiss implementation
+  Sloth_U8*  ctrl;
+  Sloth_U32  deleted;
+  
+  // The fraction of cap that can be used before the table is
+  // rehashed. 0 uses SLOTH_HASHTABLE_MAX_LOAD_DEFAULT
+  Sloth_R32  max_load;
+  
+  // Probe Statistics
+  // Running totals since the last sloth_hashtable_stats_reset
+  Sloth_U64  stats_lookups;
+  Sloth_U64  stats_probes;
+  Sloth_U32  stats_probe_max;
+  Sloth_U32  stats_rehashes;
+};
+
+typedef struct Sloth_Hashtable_Stats Sloth_Hashtable_Stats;
+struct Sloth_Hashtable_Stats
+{
+  Sloth_U32 cap;
+  Sloth_U32 used;
+  Sloth_U32 rehashes;
+  Sloth_R32 load;
+  
+  // slots (or, in the swiss implementation, groups) probed past 
+  // per lookup, since the last reset
+  Sloth_U64 lookups;
+  Sloth_R32 lookup_probe_avg;
+  Sloth_U32 lookup_probe_max;
+  
+  // distance of each stored key from the slot it hashes to
+  Sloth_R32 key_dist_avg;
+  Sloth_U32 key_dist_max;
 };
 
 // ARENA
 // A push buffer arena - only supports push/pop memory and clearing
+
+// What an arena did between two clears. For per frame arenas this
+// is one frame's worth of allocation
+typedef struct Sloth_Arena_Cycle_Stats Sloth_Arena_Cycle_Stats;
+struct Sloth_Arena_Cycle_Stats
+{
+  Sloth_U32 pushes;
+  Sloth_U64 pushed; // bytes, including anything later popped
+  Sloth_U64 peak;   // furthest the arena's position got
+  
+  // times the arena had to allocate (a new bucket, or more committed 
+  // pages) to satisfy a push
+  Sloth_U32 grows;
+  
+  // bytes left unused at the end of buckets when a push didn't fit
+  // and moved on to the next one. Always 0 for virtual arenas
+  Sloth_U64 wasted;
+};
+
 typedef struct Sloth_Arena Sloth_Arena;
 struct Sloth_Arena
 {
   char* name;
+  
+  // !SLOTH_ARENA_VIRTUAL
   Sloth_U8** buckets;
   Sloth_U32 buckets_cap;
   Sloth_U32 buckets_len;
   Sloth_U32 bucket_cap;
   Sloth_U32 curr_bucket_len;
+  
+  // SLOTH_ARENA_VIRTUAL
+  // one contiguous range, [0, at) is in use, [0, committed) is
+  // backed by pages. high_water is the largest at since the last
+  // clear, anything committed past it is returned on clear
+  Sloth_U8* base;
+  Sloth_U32 reserved;
+  Sloth_U32 committed;
+  Sloth_U32 at;
+  Sloth_U32 high_water;
+  
+  // Statistics
+  // stats_cycle accumulates until the next sloth_arena_clear, which
+  // moves it into stats_last_cycle
+  Sloth_Arena_Cycle_Stats stats_cycle;
+  Sloth_Arena_Cycle_Stats stats_last_cycle;
+  Sloth_U64 stats_peak_max;
+};
+
+typedef struct Sloth_Arena_Stats Sloth_Arena_Stats;
+struct Sloth_Arena_Stats
+{
+  Sloth_U64 used;      // current position
+  Sloth_U64 committed; // bytes currently backed by memory
+  Sloth_U64 reserved;  // address space held. Equal to committed for bucket arenas
+  Sloth_U32 buckets;   // allocated buckets. 0 for virtual arenas
+  
+  Sloth_Arena_Cycle_Stats cycle;
+  Sloth_Arena_Cycle_Stats last_cycle;
+  
+  // largest peak of any cycle since the arena was created
+  Sloth_U64 peak_max;
 };
 
 typedef struct Sloth_Arena_Loc Sloth_Arena_Loc;
 struct Sloth_Arena_Loc
 {
-  Sloth_U32 bucket_index;
+  Sloth_U32 bucket_index; // always 0 for virtual arenas
   Sloth_U32 bucket_at; // pos in bucket
 };
 
@@ -348,6 +527,7 @@ union Sloth_Glyph_ID
 {
   Sloth_U32 value;
   struct {
+    // 24 bits covers every unicode codepoint (up to U+10FFFF)
     Sloth_U8 id[3];
     Sloth_U8 family;
   };
@@ -390,6 +570,26 @@ struct Sloth_Font
 typedef Sloth_U8*      Sloth_Font_Renderer_Load_Font(Sloth_Ctx* sloth, Sloth_Font* font, Sloth_U8* font_data, Sloth_U32 font_data_size, Sloth_U32 font_index, Sloth_R32 pixel_height);
 typedef Sloth_Glyph_ID Sloth_Font_Renderer_Register_Glyph(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint);
 
+// A codepoint that was first seen this frame, waiting to be 
+// rasterized. See sloth_font_request_codepoint
+typedef struct Sloth_Glyph_Request Sloth_Glyph_Request;
+struct Sloth_Glyph_Request
+{
+  Sloth_Font_ID font;
+  Sloth_U32 codepoint;
+};
+
+// Optional. Rasterizes and registers every request. Renderers that
+// don't provide it have font_renderer_register_glyph called for 
+// each request instead
+typedef void Sloth_Font_Renderer_Register_Glyphs(Sloth_Ctx* sloth, Sloth_Glyph_Request* requests, Sloth_U32 requests_len);
+
+// Optional. Calls job for every index in [0, count), on as many 
+// threads as the application likes, and returns once they're all
+// done. Used to rasterize batches of glyphs
+typedef void Sloth_Parallel_Job(Sloth_Ctx* sloth, Sloth_U32 index, Sloth_U8* user_data);
+typedef void Sloth_Parallel_For(Sloth_Ctx* sloth, Sloth_U32 count, Sloth_Parallel_Job* job, Sloth_U8* user_data);
+
 typedef Sloth_U32 Sloth_Glyph_Data_Format;
 enum 
 {
@@ -450,11 +650,25 @@ struct Sloth_Glyph
   Sloth_R32 lsb;
   Sloth_R32 x_advance;
   Sloth_R32 baseline_offset_y;
+  
+  // index into Sloth_Ctx::glyph_atlases of the atlas this glyph
+  // was packed into
+  Sloth_U32 atlas_index;
 };
 
 // The starting dimensions of a newly created Sloth_Glyph_Atlas
 #define SLOTH_GLYPH_ATLAS_START_DIM 1024
 
+// Atlases double in size as they fill up, until they reach this 
+// size. Past that, glyphs spill into another atlas page
+#ifndef SLOTH_GLYPH_ATLAS_MAX_DIM
+#  define SLOTH_GLYPH_ATLAS_MAX_DIM 4096
+#endif
+
+// Atlas pages are stored after the atlases of every possible glyph
+// family, so they never collide with a family registered later
+#define SLOTH_GLYPH_ATLAS_FIRST_PAGE 256
+
 // The minimum number of Sloth_Glyph_Atlases that can be allocated
 // (The starting number is, naturally, zero. And if you never register
 //  a glyph, then these will never get allocated)
@@ -468,6 +682,32 @@ enum
   Sloth_GlyphAtlas_Dirty_Grow,
 };
 
+// One span of an atlas' skyline: every pixel in [x, x + width)
+// below y is taken
+typedef struct Sloth_Skyline_Node Sloth_Skyline_Node;
+struct Sloth_Skyline_Node
+{
+  Sloth_U32 x;
+  Sloth_U32 y;
+  Sloth_U32 width;
+};
+
+// A region of an atlas that changed since it was last uploaded
+typedef struct Sloth_Glyph_Atlas_Dirty_Rect Sloth_Glyph_Atlas_Dirty_Rect;
+struct Sloth_Glyph_Atlas_Dirty_Rect
+{
+  Sloth_U32 x;
+  Sloth_U32 y;
+  Sloth_U32 width;
+  Sloth_U32 height;
+};
+
+// The most dirty rects an atlas tracks between uploads. Past this, 
+// new rects are merged into whichever existing one grows the least
+#ifndef SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX
+# define SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX 16
+#endif
+
 // The in-memory representation of a texture where
 // width == height, and the width is a power of 2.
 typedef struct Sloth_Glyph_Atlas Sloth_Glyph_Atlas;
@@ -475,8 +715,25 @@ struct Sloth_Glyph_Atlas
 {
   Sloth_U8* data;
   Sloth_U32 dim;
-  Sloth_U32 last_glyph;
-  Sloth_U32 last_row_first_glyph;
+  
+  // the used space, as spans sorted by x that cover [0, dim)
+  Sloth_Skyline_Node* skyline;
+  Sloth_U32 skyline_len;
+  Sloth_U32 skyline_cap;
+  
+  // the index of the page glyphs of this family go in once this 
+  // atlas is full, or 0 if there isn't one yet
+  Sloth_U32 next_page;
+  
+  // this atlas's place in the merged texture. Atlases are assigned
+  // tiles in the order they're created
+  Sloth_U32 merged_tile;
+  
+  // the regions written since the last upload. Only meaningful when
+  // dirty_state is Dirty_UpdateData - a grown atlas is uploaded whole
+  Sloth_Glyph_Atlas_Dirty_Rect dirty_rects[SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX];
+  Sloth_U32 dirty_rects_len;
+  
   Sloth_Glyph_Atlas_Dirty_State dirty_state;
   Sloth_U8  id;
 };
@@ -487,8 +744,29 @@ struct Sloth_Glyph_Store
   Sloth_Glyph* glyphs;
   Sloth_U32 glyphs_cap;
   Sloth_Hashtable glyphs_table;
+  
+  // the id of each glyph in glyphs, so the table can be rebuilt 
+  // when glyphs moves, and glyphs can be written to a cache
+  Sloth_Glyph_ID* ids;
+  
+  // Bumped every time a glyph is registered. A new glyph can grow
+  // its atlas, which moves the uvs of every glyph already in it, 
+  // so anything derived from glyph infos is stale once this changes
+  Sloth_U32 generation;
 };
 
+// Codepoints [first, one_past_last). See sloth_font_prewarm
+typedef struct Sloth_Codepoint_Range Sloth_Codepoint_Range;
+struct Sloth_Codepoint_Range
+{
+  Sloth_U32 first;
+  Sloth_U32 one_past_last;
+};
+
+#define SLOTH_CODEPOINTS_DIGITS (Sloth_Codepoint_Range){ 0x30, 0x3A }
+#define SLOTH_CODEPOINTS_ASCII  (Sloth_Codepoint_Range){ 0x20, 0x7F }
+#define SLOTH_CODEPOINTS_LATIN1 (Sloth_Codepoint_Range){ 0xA0, 0x100 }
+
 typedef struct Sloth_Glyph_Info Sloth_Glyph_Info;
 struct Sloth_Glyph_Info
 {
@@ -496,7 +774,11 @@ struct Sloth_Glyph_Info
   Sloth_Rect uv;
 };
 
-typedef void Sloth_Renderer_Atlas_Updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index);
+// rects are the regions of the atlas that changed, so a renderer
+// that can update part of a texture only needs to upload those. A 
+// new or grown atlas is passed as a single rect covering the whole
+// thing. The sokol renderer can't, and uploads whole textures
+typedef void Sloth_Renderer_Atlas_Updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index, Sloth_Glyph_Atlas_Dirty_Rect* rects, Sloth_U32 rects_len);
 typedef void Sloth_Renderer_Render(Sloth_Ctx* sloth, Sloth_U32 glyph_atlas_index);
 
 typedef Sloth_U8 Sloth_Size_Kind;
@@ -658,6 +940,22 @@ char* sloth_text_style_flag_strs[] = {
   "NoWrapText",
 };
 
+typedef Sloth_U32 Sloth_Style_Inherit_Flags;
+enum
+{
+  Sloth_StyleInherit_None             = 0,
+  Sloth_StyleInherit_DrawFlags        = 1,
+  Sloth_StyleInherit_ColorBg          = 2,
+  Sloth_StyleInherit_ColorText        = 4,
+  Sloth_StyleInherit_ColorOutline     = 8,
+  Sloth_StyleInherit_BgGlyph          = 16,
+  Sloth_StyleInherit_OutlineThickness = 32,
+  Sloth_StyleInherit_BorderRadius     = 64,
+  Sloth_StyleInherit_TextStyle        = 128,
+  Sloth_StyleInherit_Font             = 256,
+  Sloth_StyleInherit_All              = 511,
+};
+
 typedef struct Sloth_Widget_Style Sloth_Widget_Style;
 struct Sloth_Widget_Style
 {
@@ -675,6 +973,11 @@ struct Sloth_Widget_Style
   
   Sloth_Text_Style_Flags text_style;
   Sloth_Font_ID font;
+  
+  // Fields flagged here are copied from the parent widget's style
+  // when the style is interned, rather than read from this struct.
+  // Interned styles always have inherit == 0
+  Sloth_Style_Inherit_Flags inherit;
 };
 
 typedef Sloth_U32 Sloth_Widget_Input_Flags;
@@ -699,6 +1002,53 @@ struct Sloth_Widget_Desc
   Sloth_Widget_Layout layout;
   Sloth_Widget_Style  style;
   Sloth_Widget_Input  input;
+  
+  // Handles returned from sloth_layout_register and 
+  // sloth_style_register. If non-zero, these are used instead
+  // of layout and style, which skips hashing them on every push
+  Sloth_U32 layout_handle;
+  Sloth_U32 style_handle;
+};
+
+// DESCRIPTOR TABLE
+// Interns fixed size descriptors (Sloth_Widget_Layout and 
+// Sloth_Widget_Style) by content, so that every widget with the
+// same descriptor shares one record, and the widget only has
+// to store a 32 bit handle to it.
+// Handles are indices into records. Handle 0 is reserved to
+// mean 'no descriptor'
+// Records that haven't been interned for a number of frames
+// are evicted (see Sloth_Ctx.desc_evict_after_frames), unless 
+// they were registered, in which case they are pinned for the 
+// lifetime of the table.
+#define SLOTH_DESC_PINNED 0xFFFFFFFF
+
+// How deeply sloth_push_id_scope can be nested
+#define SLOTH_ID_SCOPES_CAP 32
+
+typedef struct Sloth_Desc_Table Sloth_Desc_Table;
+struct Sloth_Desc_Table
+{
+  Sloth_U8*  records;
+  Sloth_U32  record_size;
+  
+  // content hash of each record. 0 if the record is free
+  Sloth_U32* hashes;
+  
+  // next record whose hash maps to the same lut entry,
+  // or the next free record if this one is free
+  Sloth_U32* chain_next;
+  
+  // the frame this record was last interned on, or SLOTH_DESC_PINNED
+  Sloth_U32* last_used;
+  
+  Sloth_U32  cap;
+  Sloth_U32  len;
+  Sloth_U32  live;
+  Sloth_U32  free_first;
+  
+  // hash -> index of the first record in that hash's chain
+  Sloth_Hashtable lut;
 };
 
 typedef Sloth_U8 Sloth_Glyph_Layout_Flags;
@@ -720,6 +1070,94 @@ struct Sloth_Glyph_Layout
   Sloth_Glyph_Layout_Flags flags;
 };
 
+// One line of a widget's laid out text
+typedef struct Sloth_Text_Line Sloth_Text_Line;
+struct Sloth_Text_Line
+{
+  // the line is glyphs [first, one_past_last). A line ended by a
+  // newline includes the newline glyph
+  Sloth_U32 first;
+  Sloth_U32 one_past_last;
+  
+  // distance from the text's left edge to the right edge of the
+  // line's last glyph, before alignment
+  Sloth_R32 width;
+  
+  // y of the line's baseline, relative to the top of the text
+  Sloth_R32 baseline;
+};
+
+// Everything the result of sloth_layout_text_in_widget depends on,
+// besides the glyph ids themselves (see Sloth_Widget_Text::hash)
+typedef struct Sloth_Text_Layout_Key Sloth_Text_Layout_Key;
+struct Sloth_Text_Layout_Key
+{
+  Sloth_U32 text_hash;
+  Sloth_U32 glyphs_len;
+  Sloth_U32 glyphs_generation;
+  Sloth_U32 text_style;
+  Sloth_U32 color_text;
+  Sloth_R32 bounds_min_x;
+  Sloth_R32 bounds_max_x;
+};
+
+typedef struct Sloth_Widget_Text Sloth_Widget_Text;
+struct Sloth_Widget_Text
+{
+  Sloth_Glyph_Layout* glyphs;
+  Sloth_U32           glyphs_cap;
+  Sloth_U32           glyphs_len;
+  Sloth_V2            dim;
+  
+  // written by sloth_layout_text_in_widget, in the same arena as glyphs
+  Sloth_Text_Line*    lines;
+  Sloth_U32           lines_len;
+  
+  // hash of every glyph id appended so far, which covers the
+  // text and the fonts it is in
+  Sloth_U32           hash;
+  
+  // the key glyphs were last laid out with, and its hash, which
+  // is checked first. layout_hash is 0 if not laid out yet
+  Sloth_Text_Layout_Key layout_key;
+  Sloth_U32           layout_hash;
+  
+  // Set by sloth_push_widget_long_text. The text isn't copied, and
+  // glyphs are only made for the lines that end up visible, during
+  // sloth_offset_and_clip_text. first_visible_line is the line 
+  // lines[0] is in the whole text
+  Sloth_Char*         long_text;
+  Sloth_U32           long_text_len;
+  Sloth_U32           long_text_first_visible_line;
+};
+
+// Where each line of a long text widget starts, so that only the
+// visible lines need to be laid out. See sloth_push_widget_long_text
+typedef struct Sloth_Long_Text_Index Sloth_Long_Text_Index;
+struct Sloth_Long_Text_Index
+{
+  // byte offset into the text of the first glyph of each line
+  Sloth_U32* line_starts;
+  Sloth_U32  line_starts_cap;
+  Sloth_U32  lines_len;
+  
+  // bytes [0, indexed_len) of the text have been broken into lines
+  // with whatever key hashes. Text that only grows is indexed from
+  // the start of its last line onward. tail_hash is the hash of the
+  // indexed part of the last line, so edits to it are caught
+  Sloth_U32  indexed_len;
+  Sloth_U32  key;
+  Sloth_U32  tail_hash;
+  
+  // the widest line seen since the index was last rebuilt. Rewrapping
+  // the last line as text is appended can't shrink it
+  Sloth_R32  max_width;
+  
+  Sloth_R32  line_advance;
+  Sloth_R32  to_baseline;
+  Sloth_R32  align_width;
+};
+
 typedef struct Sloth_Widget_Cached Sloth_Widget_Cached;
 struct Sloth_Widget_Cached
 {
@@ -743,49 +1181,92 @@ struct Sloth_Widget_Cached
   Sloth_U8  cached_value[SLOTH_WIDGET_PERSISTENT_VALUE_CAP];
   Sloth_U32 cached_value_len;
   
+  // Retained Text Layout
+  // The laid out (but not yet offset into place) glyphs of this 
+  // id's text, reused by sloth_layout_text_in_widget for as long as
+  // the text, its bounds and its style produce the same key
+  Sloth_Glyph_Layout* text_layout_glyphs;
+  Sloth_U32           text_layout_cap;
+  Sloth_U32           text_layout_len;
+  Sloth_Text_Line*    text_layout_lines;
+  Sloth_U32           text_layout_lines_cap;
+  Sloth_U32           text_layout_lines_len;
+  Sloth_Text_Layout_Key text_layout_key;
+  Sloth_U32           text_layout_hash;
+  Sloth_V2            text_layout_dim;
+  
+  // This id's text as it was laid out last frame. The glyphs live
+  // in sloth_last_frame_arena so they stay valid until the next
+  // sloth_frame_prepare. Zero if the widget had no text.
+  // text_last_frame_index is the frame it was retained on, since 
+  // an id that skips a frame keeps a snapshot whose arena is gone
+  Sloth_Widget_Text text_last_frame;
+  Sloth_U32 text_last_frame_index;
+  
+  // The layouts this id was given last frame, as pushed and as 
+  // resized to fit its text. While they still match, they're reused
+  // rather than hashed and interned again
+  Sloth_U32 layout_handle;
+  Sloth_U32 layout_text_handle;
+  
+  // Only allocated for ids pushed with sloth_push_widget_long_text
+  Sloth_Long_Text_Index* long_text;
+  
+  // the id this cache belongs to, and the last frame it was
+  // used on. id is 0 if the cache is in the free list
+  Sloth_ID  id;
+  Sloth_U32 last_used;
+  
   // only used if in free list
   Sloth_Widget_Cached* free_next;
   
   Sloth_U8 canary_end_;
 };
 
+// NOTE: Sloth_Widget only holds the data every layout pass needs.
+// Everything else about a widget lives in parallel arrays in 
+// Sloth_Widget_Pool, at the same index (see sloth_widget_input, 
+// sloth_widget_text), or in the descriptor tables in Sloth_Ctx
+// (see sloth_widget_layout, sloth_widget_style)
 typedef struct Sloth_Widget Sloth_Widget;
 struct Sloth_Widget
 {
   // Tree Structuring
-  Sloth_Widget* child_first;
-  Sloth_Widget* child_last;
-  Sloth_Widget* sibling_next;
-  Sloth_Widget* sibling_prev;
-  Sloth_Widget* parent;
+  // Widgets are stored in sloth->widgets in the order they were
+  // pushed, which is preorder. So a widget's first child, if it
+  // has one, is always the widget right after it, and its subtree
+  // is the next subtree_size widgets (including itself).
+  // These are indices into sloth->widgets. Index 0 is reserved to
+  // mean 'no widget'
+  Sloth_U32 parent;
+  Sloth_U32 sibling_next;
+  Sloth_U32 subtree_size;
   
   Sloth_ID id;
-  Sloth_U32 touched_last_frame;
   
   Sloth_Widget_Cached* cached;
   
   // Primed Desc
-  // Fields that describe how to render the 
-  // widget, and which will be used for interaction
-  // next frame
-  Sloth_Widget_Layout layout;
-  Sloth_Widget_Style  style;
-  Sloth_Widget_Input  input;
-  
-  Sloth_Glyph_Layout* text;
-  Sloth_U32           text_cap;
-  Sloth_U32           text_len;
-  Sloth_V2            text_dim;
+  // Handles into sloth->layouts and sloth->styles
+  // (see sloth_widget_layout and sloth_widget_style)
+  Sloth_U32 layout_handle;
+  Sloth_U32 style_handle;
 };
 
 typedef struct Sloth_Widget_Pool Sloth_Widget_Pool;
 struct Sloth_Widget_Pool
 {
+  // Hot - touched by every layout pass
   Sloth_Widget* values;
+  
+  // Cold - only touched by text layout, rendering, 
+  // and input handling. 
+  // Fields which will be used for interaction next frame
+  Sloth_Widget_Input* inputs;
+  Sloth_Widget_Text*  texts;
+  
   Sloth_U32 cap;
   Sloth_U32 len;
-  
-  Sloth_Widget* free_list;
 };
 
 typedef struct Sloth_Widget_Cached_Pool Sloth_Widget_Cached_Pool;
@@ -799,12 +1280,19 @@ struct Sloth_Widget_Cached_Pool
   Sloth_U32 bucket_cap;
   
   Sloth_Widget_Cached* free_list;
+  
+  // where the next eviction sweep picks up
+  // see sloth_widget_cached_pool_evict
+  Sloth_U32 sweep_at;
 };
 
 typedef struct Sloth_Widget_Result Sloth_Widget_Result;
 struct Sloth_Widget_Result
 {
+  // widget is only valid until the next push. widget_index
+  // is valid for the rest of the frame
   Sloth_Widget* widget;
+  Sloth_U32     widget_index;
   
   // mouse input
   Sloth_U8 released;
@@ -819,7 +1307,35 @@ struct Sloth_Widget_Result
   Sloth_U32 glyph_cursor_pos;
 };
 
-#define SLOTH_VERTEX_STRIDE 9
+// Vertices are a position (3 x Sloth_R32), uv and color.
+// By default, uv is 2 x Sloth_R32 and color is 4 x Sloth_R32.
+// When SLOTH_VERTEX_PACKED is set, uv is 2 x Sloth_U16 and color is
+// 4 x Sloth_U8 (r, g, b, a), each 0 -> 1 normalized, so each fits in
+// a single Sloth_R32 slot of Sloth_VIBuffer::verts. Renderers read 
+// them as normalized attributes (ie. SG_VERTEXFORMAT_USHORT2N and 
+// SG_VERTEXFORMAT_UBYTE4N) so the same shader works for both layouts
+#if SLOTH_VERTEX_PACKED
+#  define SLOTH_VERTEX_STRIDE 5
+typedef Sloth_U32 Sloth_Vertex_Color;
+#else
+#  define SLOTH_VERTEX_STRIDE 9
+typedef Sloth_V4 Sloth_Vertex_Color;
+#endif
+
+// Indices are Sloth_U16, relative to the first vertex of the batch
+// they belong to. A new batch is started whenever the current one 
+// can't address the next vertex, and renderers issue one draw per 
+// batch, binding the vertex buffer at the batch's first_vert.
+// Use sloth_vibuffer_reserve_verts to keep the verts of a single
+// shape from straddling two batches.
+#define SLOTH_VIBUFFER_BATCH_VERTS 65536
+
+typedef struct Sloth_VIBuffer_Batch Sloth_VIBuffer_Batch;
+struct Sloth_VIBuffer_Batch
+{
+  Sloth_U32 first_vert;
+  Sloth_U32 first_index;
+};
 
 typedef struct Sloth_VIBuffer Sloth_VIBuffer;
 struct Sloth_VIBuffer
@@ -828,9 +1344,13 @@ struct Sloth_VIBuffer
   Sloth_U32  verts_cap;
   Sloth_U32  verts_len;
   
-  Sloth_U32* indices;
+  Sloth_U16* indices;
   Sloth_U32  indices_cap;
   Sloth_U32  indices_len;
+  
+  Sloth_VIBuffer_Batch* batches;
+  Sloth_U32  batches_cap;
+  Sloth_U32  batches_len;
 };
 
 enum {
@@ -862,40 +1382,89 @@ typedef void Sloth_Render_VIBuffer(Sloth_Ctx* sloth, Sloth_VIBuffer buffer);
 
 struct Sloth_Ctx
 {
-  Sloth_Arena per_frame_memory;
+  // Two per frame arenas that alternate each frame, so whatever
+  // was pushed last frame survives through this one. Use 
+  // sloth_frame_arena and sloth_last_frame_arena to get at them
+  Sloth_Arena per_frame_memory[2];
   Sloth_Arena scratch;
   
   Sloth_Widget_Pool widgets;
   Sloth_Widget_Cached_Pool widget_caches;
   Sloth_Hashtable widget_cache_lut;
   
+  // Interned Descriptors
+  Sloth_Desc_Table layouts;
+  Sloth_Desc_Table styles;
+  
+  // descriptors that haven't been used for this many frames are 
+  // evicted in sloth_frame_prepare. 0 uses 
+  // SLOTH_DESC_EVICT_AFTER_FRAMES_DEFAULT.
+  // Set to SLOTH_DESC_PINNED to never evict
+  Sloth_U32 desc_evict_after_frames;
+  Sloth_U32 frame_index;
+  
+  // widget caches whose id hasn't been used for this many frames
+  // are freed in sloth_frame_prepare. 0 uses 
+  // SLOTH_WIDGET_CACHE_EVICT_AFTER_FRAMES_DEFAULT.
+  // Set to SLOTH_DESC_PINNED to never free them
+  Sloth_U32 widget_cache_evict_after_frames;
+  
   // Fonts
   Sloth_U8* font_renderer_data;
   Sloth_Font_Renderer_Load_Font* font_renderer_load_font;
   Sloth_Font_Renderer_Register_Glyph* font_renderer_register_glyph;  
+  Sloth_Font_Renderer_Register_Glyphs* font_renderer_register_glyphs;
+  Sloth_Parallel_For* parallel_for;
   Sloth_Font* fonts;
   Sloth_U32   fonts_cap;
   Sloth_U32   fonts_len;
   Sloth_Font_ID font_active;
   
   // the actual root of the current tree
-  Sloth_Widget* widget_tree_root;
-  Sloth_Widget* widget_tree_parent_cur;
+  // These are indices into widgets
+  Sloth_U32 widget_tree_root;
+  Sloth_U32 widget_tree_parent_cur;
   
-  // what the tree expects the next child will
-  // be, based on the tree layout cached from the 
-  // previous frame. 
-  Sloth_Widget* widget_tree_next_child;
+  // the most recently closed child of widget_tree_parent_cur,
+  // or 0 if it doesn't have any yet
+  Sloth_U32 widget_tree_child_last;
   Sloth_U32 widget_tree_depth_cur;
   Sloth_U32 widget_tree_depth_max;
   
+  // Id Scopes
+  // Each entry is already combined with the ones before it, so 
+  // the last one is the only one applied to new ids.
+  // see sloth_push_id_scope
+  Sloth_ID  id_scopes[SLOTH_ID_SCOPES_CAP];
+  Sloth_U32 id_scopes_len;
+  
   // Glyphs & Fonts
   Sloth_Glyph_Atlas* glyph_atlases;
   Sloth_VIBuffer*    vibuffers;
   Sloth_U32          glyph_atlases_cap;
   
+  // The merged texture every atlas is a tile of. It is 
+  // glyph_atlases_merged_dim square, and tiles are 
+  // glyph_atlases_tile_dim square, laid out in rows.
+  // glyph_atlases_merged is false if it would be bigger than
+  // glyph_atlases_merged_max_dim, in which case merged_dim is 0
+  Sloth_U32          glyph_atlases_merged_tiles;
+  Sloth_U32          glyph_atlases_merged_tiles_per_row;
+  Sloth_U32          glyph_atlases_tile_dim;
+  Sloth_U32          glyph_atlases_merged_dim;
+  Sloth_U32          glyph_atlases_merged_max_dim;
+  Sloth_Bool         glyph_atlases_merged;
+  
   Sloth_Glyph_Store  glyph_store;
   
+  // Codepoints first seen this frame, which are rasterized together
+  // at the start of sloth_frame_advance. The lut only records which
+  // glyph ids have been requested, so none is requested twice
+  Sloth_Glyph_Request* glyph_requests;
+  Sloth_U32            glyph_requests_cap;
+  Sloth_U32            glyph_requests_len;
+  Sloth_Hashtable      glyph_requests_lut;
+  
   Sloth_Font_ID      active_text_glyph_family;
   Sloth_Renderer_Atlas_Updated* renderer_atlas_updated;
   
@@ -936,12 +1505,85 @@ struct Sloth_Ctx
 // will be returned as a display string;
 // If ### appears in the input string, the id will be constructed
 // only of everything after the ###.
+// Strings without any format specifiers aren't copied or formatted,
+// only scanned for ## and hashed.
 Sloth_Function Sloth_ID_Result sloth_make_id_v(Sloth_Arena* arena, Sloth_Char* fmt, va_list args);
 Sloth_Function Sloth_ID_Result sloth_make_id_f(Sloth_Arena* arena, Sloth_Char* fmt, ...);
 Sloth_Function Sloth_ID_Result sloth_make_id_len(Sloth_Arena* arena, Sloth_U32 len, Sloth_Char* str);
 Sloth_Function Sloth_ID_Result sloth_make_id(Sloth_Arena* scratch, Sloth_Char* str);
 Sloth_Function Sloth_Bool      sloth_ids_equal(Sloth_ID a, Sloth_ID b);
 
+// Hashes exactly len bytes of str, with no ## handling.
+// This is the hash the functions above use, so 
+// sloth_make_id_hash("Foo", 3) is the id of a widget labeled "Foo"
+// or "Bar###Foo", outside of any id scope
+Sloth_Function Sloth_ID        sloth_make_id_hash(Sloth_Char* str, Sloth_U32 len);
+
+// Combines two ids into a new one. Used to apply id scopes
+Sloth_Function Sloth_ID        sloth_id_combine(Sloth_ID scope, Sloth_ID id);
+
+// SLOTH_ID("literal") is the same id as sloth_make_id_hash, but 
+// computed at compile time in C++14 and later. In C it is a call
+// to sloth_make_id_hash with the length known at compile time,
+// which can be hoisted into a static if it shows up in a profile.
+// murmur3 (32 bit, seed 0), with 0 remapped to 1 since an id of 0
+// means 'no widget'
+#define SLOTH_ID_HASH_C1 0xcc9e2d51u
+#define SLOTH_ID_HASH_C2 0x1b873593u
+#if defined(__cplusplus) && __cplusplus >= 201402L
+constexpr Sloth_U32
+sloth_id_hash_rotl_constexpr_(Sloth_U32 x, Sloth_U32 r)
+{
+  return (x << r) | (x >> (32 - r));
+}
+
+constexpr Sloth_U32
+sloth_id_hash_constexpr_(const char* str, Sloth_U32 len)
+{
+  Sloth_U32 h = 0;
+  Sloth_U32 blocks = len / 4;
+  for (Sloth_U32 i = 0; i < blocks; i++)
+  {
+    const char* b = str + (i * 4);
+    Sloth_U32 k = ((Sloth_U32)(Sloth_U8)b[0] | 
+      ((Sloth_U32)(Sloth_U8)b[1] << 8) | 
+      ((Sloth_U32)(Sloth_U8)b[2] << 16) | 
+      ((Sloth_U32)(Sloth_U8)b[3] << 24));
+    k *= SLOTH_ID_HASH_C1;
+    k = sloth_id_hash_rotl_constexpr_(k, 15);
+    k *= SLOTH_ID_HASH_C2;
+    h ^= k;
+    h = sloth_id_hash_rotl_constexpr_(h, 13);
+    h = (h * 5) + 0xe6546b64u;
+  }
+  
+  const char* tail = str + (blocks * 4);
+  Sloth_U32 k = 0;
+  Sloth_U32 tail_len = len & 3;
+  if (tail_len >= 3) k ^= (Sloth_U32)(Sloth_U8)tail[2] << 16;
+  if (tail_len >= 2) k ^= (Sloth_U32)(Sloth_U8)tail[1] << 8;
+  if (tail_len >= 1) 
+  {
+    k ^= (Sloth_U32)(Sloth_U8)tail[0];
+    k *= SLOTH_ID_HASH_C1;
+    k = sloth_id_hash_rotl_constexpr_(k, 15);
+    k *= SLOTH_ID_HASH_C2;
+    h ^= k;
+  }
+  
+  h ^= len;
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h == 0 ? 1 : h;
+}
+#  define SLOTH_ID(lit) (Sloth_ID{ sloth_id_hash_constexpr_((lit), sizeof(lit) - 1) })
+#else
+#  define SLOTH_ID(lit) sloth_make_id_hash((Sloth_Char*)(lit), sizeof(lit) - 1)
+#endif
+
 // Sloth Vector and Rect
 Sloth_Function Sloth_V2 sloth_make_v2(Sloth_R32 x, Sloth_R32 y);
 Sloth_Function Sloth_V2 sloth_v2_add(Sloth_V2 a, Sloth_V2 b);
@@ -972,6 +1614,20 @@ Sloth_Function void       sloth_hashtable_add(Sloth_Hashtable* table, Sloth_U32
 Sloth_Function Sloth_Bool sloth_hashtable_rem(Sloth_Hashtable* table, Sloth_U32 key);
 Sloth_Function Sloth_U8*  sloth_hashtable_get(Sloth_Hashtable* table, Sloth_U32 key);
 Sloth_Function void       sloth_hashtable_free(Sloth_Hashtable* table);
+Sloth_Function void       sloth_hashtable_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap);
+Sloth_Function Sloth_Hashtable_Stats sloth_hashtable_stats(Sloth_Hashtable* table);
+Sloth_Function void       sloth_hashtable_stats_reset(Sloth_Hashtable* table);
+
+// The sloth_hashtable_ functions above forward to one of these 
+// depending on SLOTH_HASHTABLE_SWISS
+Sloth_Function void       sloth_hashtable_rh_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value);
+Sloth_Function Sloth_Bool sloth_hashtable_rh_rem(Sloth_Hashtable* table, Sloth_U32 key);
+Sloth_Function Sloth_U8*  sloth_hashtable_rh_get(Sloth_Hashtable* table, Sloth_U32 key);
+Sloth_Function void       sloth_hashtable_rh_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap);
+Sloth_Function void       sloth_hashtable_swiss_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value);
+Sloth_Function Sloth_Bool sloth_hashtable_swiss_rem(Sloth_Hashtable* table, Sloth_U32 key);
+Sloth_Function Sloth_U8*  sloth_hashtable_swiss_get(Sloth_Hashtable* table, Sloth_U32 key);
+Sloth_Function void       sloth_hashtable_swiss_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap);
 
 // Arena Functions
 Sloth_Function void      sloth_arena_grow(Sloth_Arena* arena, Sloth_U32 min_size);
@@ -983,6 +1639,7 @@ Sloth_Function Sloth_U8* sloth_arena_push(Sloth_Arena* arena, Sloth_U32 size);
 Sloth_Function void            sloth_arena_pop(Sloth_Arena* arena, Sloth_Arena_Loc to);
 Sloth_Function Sloth_Arena_Loc sloth_arena_at(Sloth_Arena* arena);
 Sloth_Function void            sloth_arena_clear(Sloth_Arena* arena);
+Sloth_Function Sloth_Arena_Stats sloth_arena_stats(Sloth_Arena* arena);
 Sloth_Function void            sloth_arena_free(Sloth_Arena* arena);
 
 // Fonts
@@ -990,6 +1647,15 @@ Sloth_Function Sloth_Font_ID  sloth_font_load(Sloth_Ctx* sloth, char* path, Slot
 Sloth_Function Sloth_Font_ID  sloth_font_load_from_memory(Sloth_Ctx* sloth, char* font_name, Sloth_U32 font_name_len, Sloth_U8* data, Sloth_U32 data_size, Sloth_R32 pixel_height);
 Sloth_Function Sloth_Font_ID  sloth_font_register_family(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 weight, Sloth_U32 family);
 Sloth_Function Sloth_Glyph_ID sloth_font_register_codepoint(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint);
+// Queues codepoint to be rasterized at the start of the next 
+// sloth_frame_advance, along with every other codepoint requested 
+// before then. Requesting a glyph that is already registered or 
+// already requested does nothing
+Sloth_Function void           sloth_font_request_codepoint(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint);
+// Registers every codepoint in ranges now, as one batch (see 
+// Sloth_Ctx::parallel_for), rather than as each is first displayed.
+// Meant to be called at startup, after the font is loaded
+Sloth_Function void           sloth_font_prewarm(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_Codepoint_Range* ranges, Sloth_U32 ranges_len);
 Sloth_Function Sloth_Font*    sloth_glyph_to_font(Sloth_Ctx* sloth, Sloth_Glyph_ID glyph_id);
 Sloth_Function void           sloth_font_set_metrics(Sloth_Ctx* sloth, Sloth_Font_ID id, Sloth_Font_Metrics metrics);
 
@@ -1001,6 +1667,15 @@ Sloth_Function void           sloth_font_set_metrics(Sloth_Ctx* sloth, Sloth_Fon
 Sloth_Function Sloth_Glyph_ID sloth_make_glyph_id(Sloth_U32 family, Sloth_U32 id);
 Sloth_Function Sloth_Bool           sloth_glyph_id_matches_charcode(Sloth_Glyph_ID id, Sloth_U32 charcode);
 
+// UTF-8
+// Widget text is UTF-8. Each glyph is decoded from one byte that 
+// isn't a continuation byte (10xxxxxx) and every continuation byte
+// after it, so the glyph count doesn't depend on decoding. 
+// Truncated sequences, overlong encodings and surrogates decode to 
+// U+FFFD. at is advanced past the decoded glyph
+Sloth_Function Sloth_U32 sloth_utf8_decode(Sloth_Char* text, Sloth_U32 text_len, Sloth_U32* at);
+Sloth_Function Sloth_U32 sloth_utf8_glyph_count(Sloth_Char* text, Sloth_U32 text_len);
+
 // Glyph Atlas
 Sloth_Function void sloth_glyph_atlas_resize(Sloth_Glyph_Atlas* atlas, Sloth_U32 new_dim);
 Sloth_Function Sloth_Glyph_Atlas* sloth_create_atlas(Sloth_Ctx* sloth, Sloth_U8 family, Sloth_U32 min_dim);
@@ -1008,6 +1683,20 @@ Sloth_Function Sloth_Glyph_Atlas* sloth_create_atlas(Sloth_Ctx* sloth, Sloth_U8
 Sloth_Function Sloth_Bool sloth_glyph_store_contains(Sloth_Glyph_Store* store, Sloth_Glyph_ID id);
 Sloth_Function void sloth_glyph_store_free(Sloth_Glyph_Store* store);
 
+// Glyph Cache
+// Every atlas and registered glyph, written to a block of memory
+// that can be saved to disk and handed to sloth_glyph_cache_load on
+// a later run, so nothing has to be rasterized again. The cache 
+// records the loaded fonts and the dpi scale, and only loads if they
+// match, into a context that hasn't registered any glyphs yet.
+// The data is copied, so a memory mapped file can be unmapped 
+// right after loading
+Sloth_Function Sloth_U32  sloth_glyph_cache_size(Sloth_Ctx* sloth);
+Sloth_Function Sloth_U32  sloth_glyph_cache_write(Sloth_Ctx* sloth, Sloth_U8* dst, Sloth_U32 dst_size);
+Sloth_Function Sloth_Bool sloth_glyph_cache_load(Sloth_Ctx* sloth, Sloth_U8* data, Sloth_U32 data_size);
+Sloth_Function Sloth_Bool sloth_glyph_cache_save_file(Sloth_Ctx* sloth, char* path);
+Sloth_Function Sloth_Bool sloth_glyph_cache_load_file(Sloth_Ctx* sloth, char* path);
+
 // Glyph Registration
 Sloth_Function Sloth_Glyph_Atlas* sloth_get_atlas_for_glyph(Sloth_Ctx* sloth, Sloth_Glyph_ID glyph);
 Sloth_Function Sloth_VIBuffer*    sloth_get_vibuffer_for_glyph(Sloth_Ctx* sloth, Sloth_Glyph_ID glyph);
@@ -1047,10 +1736,60 @@ Sloth_Function void      sloth_persistent_value_set_(Sloth_Ctx* sloth, Sloth_ID
 // Widget Pool Functions
 //
 Sloth_Function Sloth_Widget* sloth_widget_pool_take(Sloth_Ctx* sloth);
-Sloth_Function void          sloth_widget_pool_give(Sloth_Ctx* sloth, Sloth_Widget* widget);
 Sloth_Function void          sloth_widget_pool_grow(Sloth_Widget_Pool* pool);
 Sloth_Function void          sloth_widget_pool_free(Sloth_Widget_Pool* pool);
 
+//
+// Widget Tree Functions
+//
+// NOTE: Sloth_Widget* are only valid until the next widget is 
+// pushed, since the pool may need to grow. Hold onto the index
+// if you need to get back to a widget later in the frame.
+Sloth_Function Sloth_Widget* sloth_widget_get(Sloth_Ctx* sloth, Sloth_U32 index);
+Sloth_Function Sloth_U32     sloth_widget_index(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget* sloth_widget_parent(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget* sloth_widget_child_first(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget* sloth_widget_sibling_next(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget* sloth_widget_sibling_prev(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget_Input* sloth_widget_input(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget_Text*  sloth_widget_text(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget_Text*  sloth_widget_text_last_frame(Sloth_Ctx* sloth, Sloth_Widget* widget);
+
+Sloth_Function Sloth_Arena* sloth_frame_arena(Sloth_Ctx* sloth);
+Sloth_Function Sloth_Arena* sloth_last_frame_arena(Sloth_Ctx* sloth);
+
+// NOTE: layouts and styles are shared between every widget that 
+// uses the same one, so the pointers returned here are read only,
+// and only valid until the next push. To change a widget's layout 
+// or style after it has been pushed, use the _set functions, which 
+// intern a new descriptor for just that widget.
+Sloth_Function Sloth_Widget_Layout* sloth_widget_layout(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function Sloth_Widget_Style*  sloth_widget_style(Sloth_Ctx* sloth, Sloth_Widget* widget);
+Sloth_Function void                 sloth_widget_layout_set(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Widget_Layout layout);
+Sloth_Function void                 sloth_widget_style_set(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Widget_Style style);
+
+//
+// Descriptor Registration
+//
+// Interns a layout or style once and pins it, so the returned handle
+// can be stored and passed in Sloth_Widget_Desc.layout_handle / 
+// style_handle for as long as the ctx lives. 
+// Inherited style fields are resolved against parent_style here,
+// once, rather than every time a widget uses the style. 
+// parent_style may be 0, in which case inherited fields fall back
+// to their defaults.
+Sloth_Function Sloth_U32 sloth_layout_register(Sloth_Ctx* sloth, Sloth_Widget_Layout layout);
+Sloth_Function Sloth_U32 sloth_style_register(Sloth_Ctx* sloth, Sloth_Widget_Style style, Sloth_U32 parent_style);
+
+//
+// Descriptor Table
+//
+Sloth_Function Sloth_U32 sloth_desc_table_intern(Sloth_Desc_Table* table, Sloth_U8* record, Sloth_U32 record_size, Sloth_U32 frame_index);
+Sloth_Function Sloth_U8* sloth_desc_table_get(Sloth_Desc_Table* table, Sloth_U32 handle);
+Sloth_Function void      sloth_desc_table_touch(Sloth_Desc_Table* table, Sloth_U32 handle, Sloth_U32 frame_index);
+Sloth_Function Sloth_U32 sloth_desc_table_evict(Sloth_Desc_Table* table, Sloth_U32 frame_index, Sloth_U32 max_age);
+Sloth_Function void      sloth_desc_table_free(Sloth_Desc_Table* table);
+
 //
 // Widget Cached Pool
 //
@@ -1058,6 +1797,7 @@ Sloth_Function Sloth_Widget_Cached* sloth_widget_cached_pool_take(Sloth_Ctx* slo
 Sloth_Function void                 sloth_widget_cached_pool_give(Sloth_Ctx* sloth, Sloth_Widget_Cached* widget);
 Sloth_Function void                 sloth_widget_cached_pool_grow(Sloth_Widget_Cached_Pool* pool);
 Sloth_Function void                 sloth_widget_cached_pool_free(Sloth_Widget_Cached_Pool* pool);
+Sloth_Function Sloth_U32            sloth_widget_cached_pool_evict(Sloth_Ctx* sloth, Sloth_U32 max_age);
 Sloth_Function Sloth_Widget_Cached* sloth_get_cached_data_for_id(Sloth_Ctx* sloth, Sloth_ID id);
 
 //
@@ -1082,9 +1822,9 @@ Sloth_Function Sloth_Widget* sloth_pop_widget_off_tree(Sloth_Ctx* sloth);
 
 // Walking
 typedef Sloth_Tree_Walk_Result Sloth_Tree_Walk_Cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data);
-Sloth_Function void sloth_tree_walk_inorder_(Sloth_Ctx* sloth, Sloth_Widget* start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
-Sloth_Function void sloth_tree_walk_preorder_(Sloth_Ctx* sloth, Sloth_Widget* start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
-Sloth_Function void sloth_tree_walk_postorder_(Sloth_Ctx* sloth, Sloth_Widget* start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
+Sloth_Function void sloth_tree_walk_inorder_(Sloth_Ctx* sloth, Sloth_U32 start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
+Sloth_Function void sloth_tree_walk_preorder_(Sloth_Ctx* sloth, Sloth_U32 start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
+Sloth_Function void sloth_tree_walk_postorder_(Sloth_Ctx* sloth, Sloth_U32 start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
 Sloth_Function void sloth_tree_walk_inorder(Sloth_Ctx* sloth, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
 Sloth_Function void sloth_tree_walk_preorder(Sloth_Ctx* sloth, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
 Sloth_Function void sloth_tree_walk_postorder(Sloth_Ctx* sloth, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data);
@@ -1095,6 +1835,34 @@ Sloth_Function void sloth_tree_walk_postorder(Sloth_Ctx* sloth, Sloth_Tree_Walk_
 Sloth_Function Sloth_Widget_Result sloth_push_widget_v(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* fmt, va_list args);
 Sloth_Function Sloth_Widget_Result sloth_push_widget_f(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* fmt, ...);
 Sloth_Function Sloth_Widget_Result sloth_push_widget(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* text);
+
+// Pushes a widget with a precomputed id (ie. SLOTH_ID("Save") or 
+// sloth_make_id_hash) that displays label as is. Nothing is 
+// formatted or hashed, and ## has no special meaning in label.
+// The id is still combined with the current id scope
+Sloth_Function Sloth_Widget_Result sloth_push_widget_id_label(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, Sloth_ID id, char* label);
+
+// Pushes a widget for text too long to lay out every frame, like a
+// log. Line starts are indexed in the widget's cache (extended, not
+// rebuilt, while the same text pointer only grows), and glyphs are
+// only made for the lines that intersect the widget's clipped bounds.
+// text is not copied, so it must stay valid until sloth_frame_advance
+// returns. Text is in the style's font, and the id is scoped as in
+// sloth_push_widget_id_label
+// NOTE: text at the same pointer must be append only. Editing its
+// last line is detected, but editing any line before that without
+// shrinking the text keeps the old line starts. Pass a new pointer,
+// or a new id, to have it indexed again
+Sloth_Function Sloth_Widget_Result sloth_push_widget_long_text(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, Sloth_ID id, Sloth_Char* text, Sloth_U32 text_len);
+
+// Id Scopes
+// Every id made while a scope is pushed is combined with it (and 
+// with any scopes it is nested in), so the same label can be used
+// in each row of a list, for example, by pushing a scope seeded 
+// with the row index. Scopes must be popped before sloth_frame_advance
+Sloth_Function void      sloth_push_id_scope(Sloth_Ctx* sloth, Sloth_ID seed);
+Sloth_Function void      sloth_pop_id_scope(Sloth_Ctx* sloth);
+Sloth_Function Sloth_ID  sloth_id_scoped(Sloth_Ctx* sloth, Sloth_ID id);
 Sloth_Function void                sloth_pop_widget(Sloth_Ctx* sloth);
 Sloth_Function void                sloth_pop_widget_safe(Sloth_Ctx* sloth, Sloth_Widget_Result result);
 
@@ -1105,11 +1873,14 @@ Sloth_Function Sloth_Widget_Result sloth_widget(Sloth_Ctx* sloth, Sloth_Widget_D
 //
 // VIBuffer Operations
 //
-Sloth_Function void      sloth_vibuffer_set_vert(Sloth_VIBuffer* buf, Sloth_U32 vert_index, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_V4 c);
-Sloth_Function Sloth_U32 sloth_vibuffer_push_vert(Sloth_VIBuffer* buf, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_V4 c);
+Sloth_Function Sloth_Vertex_Color sloth_vertex_color(Sloth_U32 color);
+Sloth_Function void      sloth_vibuffer_set_vert(Sloth_VIBuffer* buf, Sloth_U32 vert_index, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_Vertex_Color c);
+Sloth_Function void      sloth_vibuffer_reserve_verts(Sloth_VIBuffer* buf, Sloth_U32 count);
+Sloth_Function Sloth_U32 sloth_vibuffer_push_vert(Sloth_VIBuffer* buf, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_Vertex_Color c);
 Sloth_Function Sloth_U32 sloth_vibuffer_push_tri(Sloth_VIBuffer* buf, Sloth_U32 a, Sloth_U32 b, Sloth_U32 c);
 Sloth_Function void      sloth_vibuffer_push_quad(Sloth_VIBuffer* buf, Sloth_U32 a, Sloth_U32 b, Sloth_U32 c, Sloth_U32 d);
 Sloth_Function void      sloth_vibuffer_reset(Sloth_VIBuffer* buf);
+Sloth_Function Sloth_U32 sloth_vibuffer_batch_indices_len(Sloth_VIBuffer* buf, Sloth_U32 batch_index);
 Sloth_Function void      sloth_vibuffer_free(Sloth_VIBuffer* buf);
 
 //
@@ -1283,24 +2054,22 @@ sloth_round_to_pow2_u32(Sloth_U32 v)
   return r;
 }
 
-Sloth_Function Sloth_ID_Result 
-sloth_make_id_v(Sloth_Arena* arena, Sloth_Char* fmt, va_list args)
+// Splits an already formatted string into what to display and 
+// what to hash. The result points into str
+Sloth_Function Sloth_ID_Result
+sloth_make_id_from_str_(Sloth_U32 len, Sloth_Char* str)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_U32 temp_str_cap = Sloth_Temp_String_Memory_Size;
-  Sloth_Char* temp_str = sloth_arena_push_array(arena, Sloth_Char, temp_str_cap);
-  Sloth_U32 len = (Sloth_U32)sloth_vsnprintf(temp_str, temp_str_cap, (char*)fmt, args);
-  
   // Break up formatted string into its parts
   // (what to display, what to discard)
   Sloth_U32 discard_to = 0;
   Sloth_U32 display_before = len;
   for (Sloth_U32 i = 0; i < len; i++) 
   {
-    if (temp_str[i] == '#') {
-      if (i + 1 < len && temp_str[i + 1] == '#')
+    if (str[i] == '#') {
+      if (i + 1 < len && str[i + 1] == '#')
       {
-        if (i + 2 < len && temp_str[i + 2] == '#' && (i + 3) > discard_to)
+        if (i + 2 < len && str[i + 2] == '#' && (i + 3) > discard_to)
         {
           discard_to = i + 3;
           display_before = i;
@@ -1315,20 +2084,32 @@ sloth_make_id_v(Sloth_Arena* arena, Sloth_Char* fmt, va_list args)
   }
   
   // Hash the non-discarded formatted string
-  // djb2 hash - http://www.cse.yorku.ca/~oz/hash.html
-  Sloth_U32 hash = 5381;
-  for (Sloth_U32 i = discard_to; i < len; i++)
-  {
-    hash = ((hash << 5) + hash) + (Sloth_U8)temp_str[i];
-  }
-  
   Sloth_ID_Result result;
-  result.id.value = hash;
+  result.id = sloth_make_id_hash(str + discard_to, len - discard_to);
   result.display_len = display_before;
-  result.formatted = (Sloth_Char*)&temp_str[0];
+  result.formatted = str;
   return result;
 }
 
+Sloth_Function Sloth_ID_Result 
+sloth_make_id_v(Sloth_Arena* arena, Sloth_Char* fmt, va_list args)
+{
+  SLOTH_PROFILE_BEGIN;
+  
+  // Constant labels are used as they are, rather than being 
+  // copied through vsnprintf
+  Sloth_Bool needs_format = false;
+  Sloth_U32 len = 0;
+  for (; fmt[len] != 0; len++) needs_format |= fmt[len] == '%';
+  if (!needs_format) return sloth_make_id_from_str_(len, fmt);
+  
+  Sloth_U32 temp_str_cap = Sloth_Temp_String_Memory_Size;
+  Sloth_Char* temp_str = sloth_arena_push_array(arena, Sloth_Char, temp_str_cap);
+  len = (Sloth_U32)sloth_vsnprintf(temp_str, temp_str_cap, (char*)fmt, args);
+  len = Sloth_Min(len, temp_str_cap - 1);
+  return sloth_make_id_from_str_(len, temp_str);
+}
+
 Sloth_Function Sloth_ID_Result 
 sloth_make_id_f(Sloth_Arena* arena, Sloth_Char* fmt, ...)
 {
@@ -1344,7 +2125,7 @@ Sloth_Function Sloth_ID_Result
 sloth_make_id_len(Sloth_Arena* arena, Sloth_U32 len, Sloth_Char* str)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_ID_Result result = sloth_make_id_f(arena, (char*)"%.*s", len, str);
+  Sloth_ID_Result result = sloth_make_id_from_str_(len, str);
   return result;
 }
 
@@ -1352,7 +2133,77 @@ Sloth_Function Sloth_ID_Result
 sloth_make_id(Sloth_Arena* arena, Sloth_Char* str)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_ID_Result result = sloth_make_id_f(arena, (char*)"%s", str);
+  Sloth_U32 len = 0;
+  while (str[len] != 0) len++;
+  Sloth_ID_Result result = sloth_make_id_from_str_(len, str);
+  return result;
+}
+
+#define sloth_id_hash_rotl_(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+// NOTE: This has to match sloth_id_hash_constexpr_ exactly, so
+// that SLOTH_ID gives the same ids in C and C++.
+// Blocks are assembled a byte at a time so the result doesn't 
+// depend on endianness or alignment. Compilers turn it into a 
+// single load where they can
+Sloth_Function Sloth_ID
+sloth_make_id_hash(Sloth_Char* str, Sloth_U32 len)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U8* bytes = (Sloth_U8*)str;
+  Sloth_U32 h = 0;
+  Sloth_U32 blocks = len / 4;
+  for (Sloth_U32 i = 0; i < blocks; i++)
+  {
+    Sloth_U8* b = bytes + (i * 4);
+    Sloth_U32 k = ((Sloth_U32)b[0] | ((Sloth_U32)b[1] << 8) | ((Sloth_U32)b[2] << 16) | ((Sloth_U32)b[3] << 24));
+    k *= SLOTH_ID_HASH_C1;
+    k = sloth_id_hash_rotl_(k, 15);
+    k *= SLOTH_ID_HASH_C2;
+    h ^= k;
+    h = sloth_id_hash_rotl_(h, 13);
+    h = (h * 5) + 0xe6546b64u;
+  }
+  
+  Sloth_U8* tail = bytes + (blocks * 4);
+  Sloth_U32 k = 0;
+  switch (len & 3)
+  {
+    case 3: k ^= (Sloth_U32)tail[2] << 16; // fallthrough
+    case 2: k ^= (Sloth_U32)tail[1] << 8;  // fallthrough
+    case 1: 
+    {
+      k ^= (Sloth_U32)tail[0];
+      k *= SLOTH_ID_HASH_C1;
+      k = sloth_id_hash_rotl_(k, 15);
+      k *= SLOTH_ID_HASH_C2;
+      h ^= k;
+    } break;
+  }
+  
+  h ^= len;
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  
+  Sloth_ID result;
+  result.value = h == 0 ? 1 : h;
+  return result;
+}
+
+Sloth_Function Sloth_ID
+sloth_id_combine(Sloth_ID scope, Sloth_ID id)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 h = id.value ^ (scope.value + 0x9e3779b9u + (id.value << 6) + (id.value >> 2));
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  
+  Sloth_ID result;
+  result.value = h == 0 ? 1 : h;
   return result;
 }
 
@@ -1527,47 +2378,28 @@ sloth_zero_size__(Sloth_U32 size, Sloth_U8* base)
   for (Sloth_U32 i = 0; i < size; i++) base[i] = 0;
 }
 
-Sloth_Function void
-sloth_hashtable_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap)
+#define SLOTH_HASHTABLE_CAP_MASK(table) ((table)->cap - 1)
+
+// The number of slots that can be filled before the table is rehashed
+Sloth_Function Sloth_U32
+sloth_hashtable_load_limit_(Sloth_Hashtable* table)
 {
-  table->keys = sloth_realloc_array(table->keys, Sloth_U32, old_cap, new_cap);
-  table->values = (Sloth_U8**)sloth_realloc_array(
-      table->values, Sloth_U8*, old_cap, new_cap
-  );
-  
-  Sloth_U32 indices_to_zero = new_cap - old_cap;
-  sloth_zero_size__(
-      sizeof(Sloth_U32) * indices_to_zero, 
-    (Sloth_U8*)(table->keys + old_cap)
-  );
-  sloth_zero_size__(
-      sizeof(Sloth_U8*) * indices_to_zero, 
-    (Sloth_U8*)(table->values + old_cap)
-  );
-  
-  table->cap = new_cap;
+  Sloth_R32 max_load = table->max_load;
+  if (max_load <= 0 || max_load >= 1) max_load = SLOTH_HASHTABLE_MAX_LOAD_DEFAULT;
+  return (Sloth_U32)((Sloth_R32)table->cap * max_load);
 }
 
-#define SLOTH_HASHTABLE_TOMBSTONE (1 << 31)
-// Since this hashtable takes any 32 bit integer as a key, this 
-// macro simply masks off the tombstone bit if it was present
-#define SLOTH_HASHTABLE_VALIDATE_KEY(key) ((key) & ~SLOTH_HASHTABLE_TOMBSTONE)
-
-#define SLOTH_HASHTABLE_CAP_MASK(table) ((table)->cap - 1)
-
 // effectively key % table->cap
 // this will be true so long as cap is a power of two
 Sloth_Function Sloth_U32
 sloth_hashtable_desired_pos(Sloth_Hashtable* table, Sloth_U32 key)
 {
-  Sloth_U32 result = key & SLOTH_HASHTABLE_CAP_MASK(table); 
-  if (result == 0) result = 1;
-  return result;
+  return key & SLOTH_HASHTABLE_CAP_MASK(table);
 }
 
-#define SLOTH_HASHTABLE_PROBE_DISTANCE(table, key, pos) (pos) - (sloth_hashtable_desired_pos((table), (key)))
-
-#define SLOTH_HASHTABLE_KEY_IS_DELETED(key) ((key) & SLOTH_HASHTABLE_TOMBSTONE)
+// How far the key stored at pos is from its desired position,
+// including probes that wrapped around the end of the table
+#define SLOTH_HASHTABLE_PROBE_DISTANCE(table, key, pos) (((pos) - sloth_hashtable_desired_pos((table), (key))) & SLOTH_HASHTABLE_CAP_MASK(table))
 
 Sloth_Function void
 sloth_hashtable_insert_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value, Sloth_U32 index)
@@ -1576,12 +2408,11 @@ sloth_hashtable_insert_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value,
   table->values[index] = value;
 }
 
+// Robin Hood insertion into a table that is known to have room
 Sloth_Function void
-sloth_hashtable_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
+sloth_hashtable_rh_add_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
 {
-  if (table->cap == 0) sloth_hashtable_realloc(table, 0, 2048);
-  
-  Sloth_U32 active_key = SLOTH_HASHTABLE_VALIDATE_KEY(key);
+  Sloth_U32 active_key = key;
   Sloth_U8* active_value = value;
   Sloth_U32 index = sloth_hashtable_desired_pos(table, active_key);
   Sloth_U32 dist = 0;
@@ -1598,12 +2429,6 @@ sloth_hashtable_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
         table, existing_key, index
     );
     if (existing_dist < dist) {
-      if (SLOTH_HASHTABLE_KEY_IS_DELETED(table->keys[index]))
-      {
-        sloth_hashtable_insert_(table, active_key, active_value, index);
-        break;
-      }
-      
       // swap existing with the insertion and keep probing
       Sloth_U8* existing_value = table->values[index];
       table->values[index] = active_value;
@@ -1620,61 +2445,855 @@ sloth_hashtable_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
   table->used += 1;
 }
 
-Sloth_Function Sloth_U32
-sloth_hashtable_lookup_index_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_Bool* is_empty)
+// Reallocates the table to new_cap slots and reinserts everything
+// that was in it. new_cap must be a power of two
+Sloth_Function void
+sloth_hashtable_rh_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap)
 {
-  if (!table->keys) {
-    if (is_empty) *is_empty = true;
-    return 0;
-  }
-  key = SLOTH_HASHTABLE_VALIDATE_KEY(key);
-  Sloth_U32 index = sloth_hashtable_desired_pos(table, key);
-  while (table->keys[index] != 0 && table->keys[index] != key) {
-    index = (index + 1) & SLOTH_HASHTABLE_CAP_MASK(table);
-  }
-  Sloth_U32 fkey = table->keys[index];  
-  if (is_empty) {
-    if (fkey == 0) *is_empty = true;
-    if (SLOTH_HASHTABLE_KEY_IS_DELETED(fkey)) *is_empty = true;
-  } else {
-    if (fkey == 0) return 0;
-    if (SLOTH_HASHTABLE_KEY_IS_DELETED(fkey)) return 0;
+  SLOTH_PROFILE_BEGIN;
+  sloth_assert(old_cap == table->cap);
+  sloth_assert(sloth_is_pow2(new_cap));
+  sloth_assert(new_cap > table->used);
+  
+  Sloth_U32* old_keys = table->keys;
+  Sloth_U8** old_values = table->values;
+  
+  table->keys = sloth_realloc_array(0, Sloth_U32, 0, new_cap);
+  table->values = (Sloth_U8**)sloth_realloc_array(0, Sloth_U8*, 0, new_cap);
+  sloth_zero_size__(sizeof(Sloth_U32) * new_cap, (Sloth_U8*)table->keys);
+  sloth_zero_size__(sizeof(Sloth_U8*) * new_cap, (Sloth_U8*)table->values);
+  table->cap = new_cap;
+  table->used = 0;
+  
+  for (Sloth_U32 i = 0; i < old_cap; i++)
+  {
+    if (old_keys[i] == 0) continue;
+    sloth_hashtable_rh_add_(table, old_keys[i], old_values[i]);
   }
-  return index;
+  
+  sloth_realloc_array(old_keys, Sloth_U32, old_cap, 0);
+  sloth_realloc_array(old_values, Sloth_U8*, old_cap, 0);
+  
+  if (old_cap > 0) table->stats_rehashes += 1;
 }
 
-Sloth_Function Sloth_Bool 
-sloth_hashtable_rem(Sloth_Hashtable* table, Sloth_U32 key)
+Sloth_Function void
+sloth_hashtable_rh_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
 {
-  Sloth_Bool unused = false;
-  Sloth_U32 index = sloth_hashtable_lookup_index_(table, key, &unused);
-  if (index == 0) return false;
-  table->keys[index] = table->keys[index] | SLOTH_HASHTABLE_TOMBSTONE;
-  table->values[index] = 0;
-  table->used -= 1;
-  return true;
+  // 0 marks an empty slot, so it can't be used as a key
+  sloth_assert(key != 0);
+  if (table->cap == 0) sloth_hashtable_rh_realloc(table, 0, SLOTH_HASHTABLE_CAP_DEFAULT);
+  
+  if (table->used + 1 > sloth_hashtable_load_limit_(table))
+  {
+    sloth_hashtable_rh_realloc(table, table->cap, table->cap * 2);
+  }
+  
+  sloth_hashtable_rh_add_(table, key, value);
 }
 
-Sloth_Function Sloth_U8*  
-sloth_hashtable_get(Sloth_Hashtable* table, Sloth_U32 key)
+// Returns whether key is in the table, and if so, writes the
+// slot it is stored in to index
+Sloth_Function Sloth_Bool
+sloth_hashtable_rh_lookup_index_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U32* index)
 {
-  Sloth_U32 index = sloth_hashtable_lookup_index_(table, key, 0);
-  if (index == 0) return 0;
+  if (!table->keys || key == 0) return false;
+  
+  Sloth_Bool result = false;
+  Sloth_U32 at = sloth_hashtable_desired_pos(table, key);
+  Sloth_U32 dist = 0;
+  for (;;)
+  {
+    Sloth_U32 existing_key = table->keys[at];
+    if (existing_key == key) 
+    {
+      result = true;
+      break;
+    }
+    
+    // Robin Hood insertion never leaves a key further from its 
+    // desired position than the keys it probed past. So once we 
+    // reach a key that is closer to its desired position than we 
+    // are to ours, the key we're looking for isn't in the table
+    if (existing_key == 0) break;
+    if (SLOTH_HASHTABLE_PROBE_DISTANCE(table, existing_key, at) < dist) break;
+    
+    at = (at + 1) & SLOTH_HASHTABLE_CAP_MASK(table);
+    dist += 1;
+  }
+  table->stats_lookups += 1;
+  table->stats_probes += dist;
+  table->stats_probe_max = Sloth_Max(table->stats_probe_max, dist);
+  
+  if (result && index) *index = at;
+  return result;
+}
+
+// Backward shift deletion - rather than leaving a tombstone in the
+// removed key's slot, each key after it that isn't in its desired 
+// position is moved back by one, until an empty slot or a key that 
+// is already where it wants to be.
+Sloth_Function Sloth_Bool 
+sloth_hashtable_rh_rem(Sloth_Hashtable* table, Sloth_U32 key)
+{
+  Sloth_U32 index = 0;
+  if (!sloth_hashtable_rh_lookup_index_(table, key, &index)) return false;
+  
+  Sloth_U32 next = (index + 1) & SLOTH_HASHTABLE_CAP_MASK(table);
+  while (table->keys[next] != 0 && 
+      SLOTH_HASHTABLE_PROBE_DISTANCE(table, table->keys[next], next) > 0)
+  {
+    sloth_hashtable_insert_(table, table->keys[next], table->values[next], index);
+    index = next;
+    next = (next + 1) & SLOTH_HASHTABLE_CAP_MASK(table);
+  }
+  sloth_hashtable_insert_(table, 0, 0, index);
+  table->used -= 1;
+  return true;
+}
+
+Sloth_Function Sloth_U8*  
+sloth_hashtable_rh_get(Sloth_Hashtable* table, Sloth_U32 key)
+{
+  Sloth_U32 index = 0;
+  if (!sloth_hashtable_rh_lookup_index_(table, key, &index)) return 0;
+  return table->values[index];
+}
+
+//////// SWISS HASHTABLE ////////
+
+#if !defined(SLOTH_HASHTABLE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define SLOTH_HASHTABLE_SSE2 1
+#elif !defined(SLOTH_HASHTABLE_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64)) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define SLOTH_HASHTABLE_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+#define SLOTH_HASHTABLE_GROUP_SIZE 16
+#define SLOTH_HASHTABLE_CTRL_EMPTY   0x80
+#define SLOTH_HASHTABLE_CTRL_DELETED 0xFE
+
+// index of the lowest set bit. v must not be 0
+Sloth_Function Sloth_U32
+sloth_ctz_u32_(Sloth_U32 v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return (Sloth_U32)__builtin_ctz(v);
+#elif defined(_MSC_VER)
+  unsigned long result;
+  _BitScanForward(&result, v);
+  return (Sloth_U32)result;
+#else
+  Sloth_U32 result = 0;
+  while (!(v & 1)) { v >>= 1; result += 1; }
+  return result;
+#endif
+}
+
+// Keys are often ids with structure in them (glyph ids are a
+// family and a codepoint) so they're mixed before being split
+// into the group index and the 7 bits stored in ctrl
+Sloth_Function Sloth_U32
+sloth_hashtable_swiss_hash_(Sloth_U32 key)
+{
+  Sloth_U32 h = key;
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+#define SLOTH_HASHTABLE_SWISS_GROUP_MASK(table) (((table)->cap / SLOTH_HASHTABLE_GROUP_SIZE) - 1)
+#define SLOTH_HASHTABLE_SWISS_H1(table, hash) (((hash) >> 7) & SLOTH_HASHTABLE_SWISS_GROUP_MASK(table))
+#define SLOTH_HASHTABLE_SWISS_H2(hash) ((Sloth_U8)((hash) & 0x7F))
+
+// How many groups past the one it hashes to the key stored at pos is
+#define SLOTH_HASHTABLE_SWISS_GROUP_DISTANCE(table, key, pos) \
+(((pos) / SLOTH_HASHTABLE_GROUP_SIZE - SLOTH_HASHTABLE_SWISS_H1((table), sloth_hashtable_swiss_hash_(key))) & SLOTH_HASHTABLE_SWISS_GROUP_MASK(table))
+
+#if SLOTH_HASHTABLE_NEON
+// NEON has no movemask, so each lane is reduced to its own bit
+// and the two halves are summed into a byte each
+Sloth_Function Sloth_U32
+sloth_hashtable_neon_movemask_(uint8x16_t lanes)
+{
+  static const Sloth_U8 bits[SLOTH_HASHTABLE_GROUP_SIZE] = {
+    1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+  };
+  uint8x16_t masked = vandq_u8(lanes, vld1q_u8(bits));
+  Sloth_U32 lo = (Sloth_U32)vaddv_u8(vget_low_u8(masked));
+  Sloth_U32 hi = (Sloth_U32)vaddv_u8(vget_high_u8(masked));
+  return lo | (hi << 8);
+}
+#endif
+
+// Returns a mask with bit i set for each control byte i in the
+// group that is equal to tag
+Sloth_Function Sloth_U32
+sloth_hashtable_group_match_(Sloth_U8* group, Sloth_U8 tag)
+{
+#if SLOTH_HASHTABLE_SSE2
+  __m128i ctrl = _mm_loadu_si128((__m128i*)group);
+  return (Sloth_U32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#elif SLOTH_HASHTABLE_NEON
+  uint8x16_t ctrl = vld1q_u8(group);
+  return sloth_hashtable_neon_movemask_(vceqq_u8(ctrl, vdupq_n_u8(tag)));
+#else
+  Sloth_U32 result = 0;
+  for (Sloth_U32 i = 0; i < SLOTH_HASHTABLE_GROUP_SIZE; i++)
+  {
+    if (group[i] == tag) result |= 1 << i;
+  }
+  return result;
+#endif
+}
+
+// Returns a mask with bit i set for each slot in the group that
+// is empty or deleted. Both have the high bit set, full slots don't
+Sloth_Function Sloth_U32
+sloth_hashtable_group_match_free_(Sloth_U8* group)
+{
+#if SLOTH_HASHTABLE_SSE2
+  return (Sloth_U32)_mm_movemask_epi8(_mm_loadu_si128((__m128i*)group));
+#elif SLOTH_HASHTABLE_NEON
+  uint8x16_t ctrl = vld1q_u8(group);
+  return sloth_hashtable_neon_movemask_(vtstq_u8(ctrl, vdupq_n_u8(0x80)));
+#else
+  Sloth_U32 result = 0;
+  for (Sloth_U32 i = 0; i < SLOTH_HASHTABLE_GROUP_SIZE; i++)
+  {
+    if (group[i] & 0x80) result |= 1 << i;
+  }
+  return result;
+#endif
+}
+
+// Inserts into the first free slot along key's probe sequence.
+// Assumes the table has room and key isn't already present
+Sloth_Function void
+sloth_hashtable_swiss_add_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
+{
+  Sloth_U32 hash = sloth_hashtable_swiss_hash_(key);
+  Sloth_U32 group = SLOTH_HASHTABLE_SWISS_H1(table, hash);
+  for (;;)
+  {
+    Sloth_U8* ctrl = table->ctrl + (group * SLOTH_HASHTABLE_GROUP_SIZE);
+    Sloth_U32 free_slots = sloth_hashtable_group_match_free_(ctrl);
+    if (free_slots)
+    {
+      Sloth_U32 index = (group * SLOTH_HASHTABLE_GROUP_SIZE) + sloth_ctz_u32_(free_slots);
+      if (table->ctrl[index] == SLOTH_HASHTABLE_CTRL_DELETED) table->deleted -= 1;
+      table->ctrl[index] = SLOTH_HASHTABLE_SWISS_H2(hash);
+      table->keys[index] = key;
+      table->values[index] = value;
+      table->used += 1;
+      break;
+    }
+    group = (group + 1) & SLOTH_HASHTABLE_SWISS_GROUP_MASK(table);
+  }
+}
+
+// Reallocates the table to new_cap slots and reinserts everything
+// that was in it, dropping any tombstones. new_cap must be a power
+// of two, and is rounded up to at least one group
+Sloth_Function void
+sloth_hashtable_swiss_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_assert(old_cap == table->cap);
+  sloth_assert(sloth_is_pow2(new_cap));
+  new_cap = Sloth_Max(new_cap, SLOTH_HASHTABLE_GROUP_SIZE);
+  sloth_assert(new_cap > table->used);
+  
+  Sloth_U32* old_keys = table->keys;
+  Sloth_U8** old_values = table->values;
+  Sloth_U8*  old_ctrl = table->ctrl;
+  
+  table->keys = sloth_realloc_array(0, Sloth_U32, 0, new_cap);
+  table->values = (Sloth_U8**)sloth_realloc_array(0, Sloth_U8*, 0, new_cap);
+  table->ctrl = sloth_realloc_array(0, Sloth_U8, 0, new_cap);
+  sloth_zero_size__(sizeof(Sloth_U32) * new_cap, (Sloth_U8*)table->keys);
+  sloth_zero_size__(sizeof(Sloth_U8*) * new_cap, (Sloth_U8*)table->values);
+  for (Sloth_U32 i = 0; i < new_cap; i++) table->ctrl[i] = SLOTH_HASHTABLE_CTRL_EMPTY;
+  table->cap = new_cap;
+  table->used = 0;
+  table->deleted = 0;
+  
+  for (Sloth_U32 i = 0; i < old_cap; i++)
+  {
+    if (old_ctrl[i] & 0x80) continue;
+    sloth_hashtable_swiss_add_(table, old_keys[i], old_values[i]);
+  }
+  
+  sloth_realloc_array(old_keys, Sloth_U32, old_cap, 0);
+  sloth_realloc_array(old_values, Sloth_U8*, old_cap, 0);
+  sloth_realloc_array(old_ctrl, Sloth_U8, old_cap, 0);
+  
+  if (old_cap > 0) table->stats_rehashes += 1;
+}
+
+Sloth_Function void
+sloth_hashtable_swiss_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
+{
+  // kept consistent with the robin hood table, which uses 0 as empty
+  sloth_assert(key != 0);
+  if (table->cap == 0) sloth_hashtable_swiss_realloc(table, 0, SLOTH_HASHTABLE_CAP_DEFAULT);
+  
+  // Tombstones still end probes, so they count against the load.
+  // If they make up most of it, rehashing in place is enough
+  if (table->used + table->deleted + 1 > sloth_hashtable_load_limit_(table))
+  {
+    Sloth_U32 new_cap = table->cap * 2;
+    if (table->deleted >= table->used) new_cap = table->cap;
+    sloth_hashtable_swiss_realloc(table, table->cap, new_cap);
+  }
+  
+  sloth_hashtable_swiss_add_(table, key, value);
+}
+
+// Returns whether key is in the table, and if so, writes the
+// slot it is stored in to index
+Sloth_Function Sloth_Bool
+sloth_hashtable_swiss_lookup_index_(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U32* index)
+{
+  if (!table->ctrl || key == 0) return false;
+  
+  Sloth_U32 hash = sloth_hashtable_swiss_hash_(key);
+  Sloth_U8  tag = SLOTH_HASHTABLE_SWISS_H2(hash);
+  Sloth_U32 group_mask = SLOTH_HASHTABLE_SWISS_GROUP_MASK(table);
+  Sloth_U32 group = SLOTH_HASHTABLE_SWISS_H1(table, hash);
+  Sloth_Bool result = false;
+  Sloth_U32 at = 0;
+  Sloth_U32 dist = 0;
+  for (;;)
+  {
+    Sloth_U8* ctrl = table->ctrl + (group * SLOTH_HASHTABLE_GROUP_SIZE);
+    Sloth_U32 matches = sloth_hashtable_group_match_(ctrl, tag);
+    while (matches)
+    {
+      at = (group * SLOTH_HASHTABLE_GROUP_SIZE) + sloth_ctz_u32_(matches);
+      if (table->keys[at] == key)
+      {
+        result = true;
+        break;
+      }
+      matches &= matches - 1;
+    }
+  
+    // A key is only ever stored past a group that was full when it
+    // was inserted, and deletion never empties a slot in a full group,
+    // so a group with an empty slot ends the probe
+    if (result || sloth_hashtable_group_match_(ctrl, SLOTH_HASHTABLE_CTRL_EMPTY)) break;
+    if (dist == group_mask) break;
+  
+    group = (group + 1) & group_mask;
+    dist += 1;
+  }
+  table->stats_lookups += 1;
+  table->stats_probes += dist;
+  table->stats_probe_max = Sloth_Max(table->stats_probe_max, dist);
+  
+  if (result && index) *index = at;
+  return result;
+}
+
+Sloth_Function Sloth_Bool
+sloth_hashtable_swiss_rem(Sloth_Hashtable* table, Sloth_U32 key)
+{
+  Sloth_U32 index = 0;
+  if (!sloth_hashtable_swiss_lookup_index_(table, key, &index)) return false;
+  
+  // If the group still has an empty slot, no probe has ever gone
+  // past it, so this slot can go straight back to empty
+  Sloth_U8* group = table->ctrl + (index & ~(SLOTH_HASHTABLE_GROUP_SIZE - 1));
+  if (sloth_hashtable_group_match_(group, SLOTH_HASHTABLE_CTRL_EMPTY)) {
+    table->ctrl[index] = SLOTH_HASHTABLE_CTRL_EMPTY;
+  } else {
+    table->ctrl[index] = SLOTH_HASHTABLE_CTRL_DELETED;
+    table->deleted += 1;
+  }
+  table->keys[index] = 0;
+  table->values[index] = 0;
+  table->used -= 1;
+  return true;
+}
+
+Sloth_Function Sloth_U8*
+sloth_hashtable_swiss_get(Sloth_Hashtable* table, Sloth_U32 key)
+{
+  Sloth_U32 index = 0;
+  if (!sloth_hashtable_swiss_lookup_index_(table, key, &index)) return 0;
   return table->values[index];
 }
 
+//////// HASHTABLE INTERFACE ////////
+
+#if SLOTH_HASHTABLE_SWISS
+#  define sloth_hashtable_impl_(name) sloth_hashtable_swiss_##name
+#else
+#  define sloth_hashtable_impl_(name) sloth_hashtable_rh_##name
+#endif
+
+Sloth_Function void
+sloth_hashtable_add(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value)
+{
+  sloth_hashtable_impl_(add)(table, key, value);
+}
+
+Sloth_Function Sloth_Bool
+sloth_hashtable_rem(Sloth_Hashtable* table, Sloth_U32 key)
+{
+  return sloth_hashtable_impl_(rem)(table, key);
+}
+
+Sloth_Function Sloth_U8*
+sloth_hashtable_get(Sloth_Hashtable* table, Sloth_U32 key)
+{
+  return sloth_hashtable_impl_(get)(table, key);
+}
+
+Sloth_Function void
+sloth_hashtable_realloc(Sloth_Hashtable* table, Sloth_U32 old_cap, Sloth_U32 new_cap)
+{
+  sloth_hashtable_impl_(realloc)(table, old_cap, new_cap);
+}
+
+Sloth_Function void
+sloth_hashtable_free(Sloth_Hashtable* table)
+{
+  Sloth_U8* unused;
+  unused = sloth_realloc(table->keys, sizeof(Sloth_U32) * table->cap, 0);
+  unused = sloth_realloc(table->values, sizeof(Sloth_U8*) * table->cap, 0);
+  if (table->ctrl) unused = sloth_realloc(table->ctrl, table->cap, 0);
+}
+
+Sloth_Function Sloth_Hashtable_Stats
+sloth_hashtable_stats(Sloth_Hashtable* table)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Hashtable_Stats result = SLOTH_ZII;
+  result.cap = table->cap;
+  result.used = table->used;
+  result.rehashes = table->stats_rehashes;
+  if (table->cap > 0) result.load = (Sloth_R32)table->used / (Sloth_R32)table->cap;
+  
+  result.lookups = table->stats_lookups;
+  result.lookup_probe_max = table->stats_probe_max;
+  if (table->stats_lookups > 0) {
+    result.lookup_probe_avg = (Sloth_R32)((double)table->stats_probes / (double)table->stats_lookups);
+  }
+  
+  // how far each stored key currently sits from the slot (or group)
+  // it hashes to
+  Sloth_U64 dist_total = 0;
+  for (Sloth_U32 i = 0; i < table->cap; i++)
+  {
+    Sloth_U32 key = table->keys[i];
+    if (key == 0) continue;
+    Sloth_U32 dist = 0;
+    if (table->ctrl) {
+      dist = SLOTH_HASHTABLE_SWISS_GROUP_DISTANCE(table, key, i);
+    } else {
+      dist = SLOTH_HASHTABLE_PROBE_DISTANCE(table, key, i);
+    }
+    dist_total += dist;
+    result.key_dist_max = Sloth_Max(result.key_dist_max, dist);
+  }
+  if (table->used > 0) result.key_dist_avg = (Sloth_R32)((double)dist_total / (double)table->used);
+  
+  return result;
+}
+
+Sloth_Function void
+sloth_hashtable_stats_reset(Sloth_Hashtable* table)
+{
+  table->stats_lookups = 0;
+  table->stats_probes = 0;
+  table->stats_probe_max = 0;
+}
+
+// NOTE: the lut stores record indices in place of pointers
+#define sloth_desc_table_lut_value_(index) ((Sloth_U8*)(Sloth_U64)(index))
+#define sloth_desc_table_lut_index_(value) ((Sloth_U32)(Sloth_U64)(value))
+
+Sloth_Function Sloth_U32
+sloth_desc_hash_(Sloth_U8* record, Sloth_U32 record_size)
+{
+  // FNV-1a, a word at a time. Descriptors are all made of 
+  // 4 byte aligned fields
+  sloth_assert((record_size & 3) == 0);
+  Sloth_U32* words = (Sloth_U32*)record;
+  Sloth_U32 hash = 2166136261u;
+  for (Sloth_U32 i = 0; i < record_size / 4; i++)
+  {
+    hash = (hash ^ words[i]) * 16777619u;
+  }
+  
+  // The lut treats key 0 as empty
+  if (hash == 0) hash = 1;
+  return hash;
+}
+
+Sloth_Function Sloth_Bool
+sloth_desc_records_equal_(Sloth_U8* a, Sloth_U8* b, Sloth_U32 record_size)
+{
+  Sloth_U32* wa = (Sloth_U32*)a;
+  Sloth_U32* wb = (Sloth_U32*)b;
+  for (Sloth_U32 i = 0; i < record_size / 4; i++)
+  {
+    if (wa[i] != wb[i]) return false;
+  }
+  return true;
+}
+
+// True if handle is a live record equal to record
+Sloth_Function Sloth_Bool
+sloth_desc_table_matches_(Sloth_Desc_Table* table, Sloth_U32 handle, Sloth_U8* record, Sloth_U32 record_size)
+{
+  if (handle == 0 || handle >= table->len || table->hashes[handle] == 0) return false;
+  return sloth_desc_records_equal_(table->records + (handle * record_size), record, record_size);
+}
+
+// Links record at index into the lut, either as the head of a new
+// chain or right after the head of an existing one
+Sloth_Function void
+sloth_desc_table_lut_link_(Sloth_Desc_Table* table, Sloth_U32 index)
+{
+  Sloth_U32 hash = table->hashes[index];
+  Sloth_U32 head = sloth_desc_table_lut_index_(sloth_hashtable_get(&table->lut, hash));
+  if (head) {
+    table->chain_next[index] = table->chain_next[head];
+    table->chain_next[head] = index;
+  } else {
+    table->chain_next[index] = 0;
+    sloth_hashtable_add(&table->lut, hash, sloth_desc_table_lut_value_(index));
+  }
+}
+
+// Evicting a record can unlink the head of a chain, which the
+// lut has no way to update in place, so rather than removing 
+// evicted records one at a time, the lut is rebuilt from the 
+// live records
+Sloth_Function void
+sloth_desc_table_lut_rebuild_(Sloth_Desc_Table* table, Sloth_U32 lut_cap)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_hashtable_free(&table->lut);
+  sloth_zero_struct_(&table->lut);
+  sloth_hashtable_realloc(&table->lut, 0, lut_cap);
+  for (Sloth_U32 i = 1; i < table->len; i++)
+  {
+    if (table->hashes[i] == 0) continue;
+    sloth_desc_table_lut_link_(table, i);
+  }
+}
+
+Sloth_Function void
+sloth_desc_table_grow_(Sloth_Desc_Table* table)
+{
+  if (table->len < table->cap) return;
+  
+  Sloth_U32 new_cap = table->cap * 2;
+  if (new_cap == 0) new_cap = 256;
+  table->records    = sloth_realloc_array(table->records, Sloth_U8, table->cap * table->record_size, new_cap * table->record_size);
+  table->hashes     = sloth_realloc_array(table->hashes, Sloth_U32, table->cap, new_cap);
+  table->chain_next = sloth_realloc_array(table->chain_next, Sloth_U32, table->cap, new_cap);
+  table->last_used  = sloth_realloc_array(table->last_used, Sloth_U32, table->cap, new_cap);
+  table->cap = new_cap;
+}
+
+Sloth_Function void
+sloth_desc_table_touch(Sloth_Desc_Table* table, Sloth_U32 handle, Sloth_U32 frame_index)
+{
+  if (table->last_used[handle] != SLOTH_DESC_PINNED) table->last_used[handle] = frame_index;
+}
+
+Sloth_Function Sloth_U32
+sloth_desc_table_intern(Sloth_Desc_Table* table, Sloth_U8* record, Sloth_U32 record_size, Sloth_U32 frame_index)
+{
+  SLOTH_PROFILE_BEGIN;
+  if (table->record_size == 0) table->record_size = record_size;
+  sloth_assert(table->record_size == record_size);
+  
+  Sloth_U32 hash = sloth_desc_hash_(record, record_size);
+  Sloth_U32 at = sloth_desc_table_lut_index_(sloth_hashtable_get(&table->lut, hash));
+  while (at)
+  {
+    Sloth_U8* existing = table->records + (at * record_size);
+    if (table->hashes[at] == hash && sloth_desc_records_equal_(existing, record, record_size))
+    {
+      sloth_desc_table_touch(table, at, frame_index);
+      return at;
+    }
+    at = table->chain_next[at];
+  }
+  
+  // index 0 is reserved to mean 'no descriptor'
+  Sloth_U32 index = table->free_first;
+  if (index) {
+    table->free_first = table->chain_next[index];
+  } else {
+    if (table->len == 0) table->len = 1;
+    sloth_desc_table_grow_(table);
+    index = table->len++;
+  }
+  
+  sloth_copy_memory_(table->records + (index * record_size), record, record_size);
+  table->hashes[index] = hash;
+  table->last_used[index] = frame_index;
+  table->live += 1;
+  sloth_desc_table_lut_link_(table, index);
+  
+  return index;
+}
+
+Sloth_Function Sloth_U8*
+sloth_desc_table_get(Sloth_Desc_Table* table, Sloth_U32 handle)
+{
+  sloth_assert(handle != 0 && handle < table->len);
+  sloth_assert(table->hashes[handle] != 0);
+  return table->records + (handle * table->record_size);
+}
+
+// Frees every record that hasn't been interned in the last max_age
+// frames. Returns the number of records evicted
+Sloth_Function Sloth_U32
+sloth_desc_table_evict(Sloth_Desc_Table* table, Sloth_U32 frame_index, Sloth_U32 max_age)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 evicted = 0;
+  for (Sloth_U32 i = 1; i < table->len; i++)
+  {
+    if (table->hashes[i] == 0) continue;
+    if (table->last_used[i] == SLOTH_DESC_PINNED) continue;
+    if (frame_index - table->last_used[i] <= max_age) continue;
+    
+    table->hashes[i] = 0;
+    table->chain_next[i] = table->free_first;
+    table->free_first = i;
+    table->live -= 1;
+    evicted += 1;
+  }
+  
+  if (evicted > 0) sloth_desc_table_lut_rebuild_(table, table->lut.cap);
+  return evicted;
+}
+
+Sloth_Function void
+sloth_desc_table_free(Sloth_Desc_Table* table)
+{
+  sloth_free((void*)table->records, table->cap * table->record_size);
+  sloth_free((void*)table->hashes, sizeof(Sloth_U32) * table->cap);
+  sloth_free((void*)table->chain_next, sizeof(Sloth_U32) * table->cap);
+  sloth_free((void*)table->last_used, sizeof(Sloth_U32) * table->cap);
+  sloth_hashtable_free(&table->lut);
+  sloth_zero_struct_(table);
+}
+
+//////// UTF-8 ////////
+
+#if !defined(SLOTH_UTF8_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define SLOTH_UTF8_SSE2 1
+#endif
+
+#define sloth_utf8_is_continuation_(b) (((Sloth_U8)(b) & 0xC0) == 0x80)
+
+Sloth_Function Sloth_U32
+sloth_popcount_u32_(Sloth_U32 v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return (Sloth_U32)__builtin_popcount(v);
+#else
+  v = v - ((v >> 1) & 0x55555555);
+  v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+  return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+// How many bytes from the start of text are ascii glyphs that can
+// be used without decoding. Text is mostly ascii, so this looks 16
+// bytes at a time. An ascii byte followed by stray continuation 
+// bytes is left for sloth_utf8_decode
+Sloth_Function Sloth_U32
+sloth_utf8_ascii_run_(Sloth_Char* text, Sloth_U32 text_len)
+{
+  Sloth_U32 i = 0;
+#if SLOTH_UTF8_SSE2
+  for (; i + 16 <= text_len; i += 16)
+  {
+    __m128i bytes = _mm_loadu_si128((__m128i*)(text + i));
+    Sloth_U32 high_bits = (Sloth_U32)_mm_movemask_epi8(bytes);
+    if (high_bits) break;
+  }
+#endif
+  while (i < text_len && (Sloth_U8)text[i] < 0x80) i++;
+  if (i > 0 && i < text_len && sloth_utf8_is_continuation_(text[i])) i -= 1;
+  return i;
+}
+
+Sloth_Function Sloth_U32
+sloth_utf8_decode(Sloth_Char* text, Sloth_U32 text_len, Sloth_U32* at)
+{
+  Sloth_U32 i = *at;
+  Sloth_U8 lead = (Sloth_U8)text[i++];
+  
+  Sloth_U32 expected = 0;
+  Sloth_U32 min = 0;
+  Sloth_U32 result = 0;
+  if      (lead < 0x80)           { expected = 0; result = lead; }
+  else if ((lead & 0xE0) == 0xC0) { expected = 1; result = lead & 0x1F; min = 0x80; }
+  else if ((lead & 0xF0) == 0xE0) { expected = 2; result = lead & 0x0F; min = 0x800; }
+  else if ((lead & 0xF8) == 0xF0) { expected = 3; result = lead & 0x07; min = 0x10000; }
+  else                            { expected = 0; result = 0xFFFD; } // continuation or invalid lead
+  
+  Sloth_U32 continuations = 0;
+  while (i < text_len && sloth_utf8_is_continuation_(text[i]))
+  {
+    if (continuations < expected) result = (result << 6) | ((Sloth_U8)text[i] & 0x3F);
+    continuations += 1;
+    i += 1;
+  }
+  *at = i;
+  
+  // stray continuation bytes after a complete sequence are dropped
+  if (continuations < expected) return 0xFFFD;
+  if (result < min || result > 0x10FFFF) return 0xFFFD;
+  if (result >= 0xD800 && result <= 0xDFFF) return 0xFFFD;
+  return result;
+}
+
+Sloth_Function Sloth_U32
+sloth_utf8_glyph_count(Sloth_Char* text, Sloth_U32 text_len)
+{
+  SLOTH_PROFILE_BEGIN;
+  if (text_len == 0) return 0;
+  
+  // a continuation byte with nothing before it still starts a glyph
+  Sloth_U32 result = sloth_utf8_is_continuation_(text[0]) ? 1 : 0;
+  Sloth_U32 i = 0;
+#if SLOTH_UTF8_SSE2
+  // continuation bytes are the only ones below -64 as signed bytes
+  __m128i continuation_max = _mm_set1_epi8(-65);
+  for (; i + 16 <= text_len; i += 16)
+  {
+    __m128i bytes = _mm_loadu_si128((__m128i*)(text + i));
+    __m128i starts = _mm_cmpgt_epi8(bytes, continuation_max);
+    result += sloth_popcount_u32_((Sloth_U32)_mm_movemask_epi8(starts));
+  }
+#endif
+  for (; i < text_len; i++) result += sloth_utf8_is_continuation_(text[i]) ? 0 : 1;
+  return result;
+}
+
+//////// ARENA ////////
+
+#if SLOTH_ARENA_VIRTUAL
+#  if defined(_WIN32)
+#    ifndef WIN32_LEAN_AND_MEAN
+#      define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#  else
+#    include <sys/mman.h>
+#  endif
+
+Sloth_Function Sloth_U8*
+sloth_vm_reserve_(Sloth_U32 size)
+{
+#  if defined(_WIN32)
+  return (Sloth_U8*)VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+#  else
+  void* result = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return result == MAP_FAILED ? 0 : (Sloth_U8*)result;
+#  endif
+}
+
+Sloth_Function Sloth_Bool
+sloth_vm_commit_(Sloth_U8* base, Sloth_U32 size)
+{
+#  if defined(_WIN32)
+  return VirtualAlloc(base, size, MEM_COMMIT, PAGE_READWRITE) != 0;
+#  else
+  return mprotect(base, size, PROT_READ | PROT_WRITE) == 0;
+#  endif
+}
+
 Sloth_Function void
-sloth_hashtable_free(Sloth_Hashtable* table)
+sloth_vm_decommit_(Sloth_U8* base, Sloth_U32 size)
 {
-  Sloth_U8* unused;
-  unused = sloth_realloc(table->keys, sizeof(Sloth_U32) * table->cap, 0);
-  unused = sloth_realloc(table->values, table->cap, 0);
+#  if defined(_WIN32)
+  VirtualFree(base, size, MEM_DECOMMIT);
+#  else
+  madvise(base, size, MADV_DONTNEED);
+  mprotect(base, size, PROT_NONE);
+#  endif
+}
+
+Sloth_Function void
+sloth_vm_release_(Sloth_U8* base, Sloth_U32 size)
+{
+#  if defined(_WIN32)
+  VirtualFree(base, 0, MEM_RELEASE);
+#  else
+  munmap(base, size);
+#  endif
+}
+
+#define sloth_arena_commit_round_(size) (((size) + (SLOTH_ARENA_COMMIT_SIZE - 1)) & ~(SLOTH_ARENA_COMMIT_SIZE - 1))
+
+#endif // SLOTH_ARENA_VIRTUAL
+
+// The arena's position as a byte count. For bucket arenas this
+// includes the unused tails of the buckets before the current one
+Sloth_Function Sloth_U64
+sloth_arena_pos_(Sloth_Arena* arena)
+{
+#if SLOTH_ARENA_VIRTUAL
+  return arena->at;
+#else
+  return ((Sloth_U64)arena->buckets_len * arena->bucket_cap) + arena->curr_bucket_len;
+#endif
 }
 
 Sloth_Function void      
 sloth_arena_grow(Sloth_Arena* arena, Sloth_U32 min_size)
 {
   SLOTH_PROFILE_BEGIN;
+#if SLOTH_ARENA_VIRTUAL
+  if (!arena->base) {
+    if (!arena->reserved) arena->reserved = SLOTH_ARENA_RESERVE_DEFAULT;
+    arena->reserved = sloth_arena_commit_round_(arena->reserved);
+    arena->base = sloth_vm_reserve_(arena->reserved);
+    sloth_assert(arena->base);
+    arena->committed = 0;
+    arena->at = 0;
+  }
+  if (!arena->base) return;
+  
+  // NOTE: commits happen in SLOTH_ARENA_COMMIT_SIZE steps so pushing
+  // lots of small things doesn't turn into a syscall per push
+  Sloth_U32 needed = arena->at + min_size;
+  if (needed < arena->at || needed > arena->reserved) {
+    sloth_assert(false); // out of reserved address space
+    return;
+  }
+  if (needed > arena->committed)
+  {
+    Sloth_U32 new_committed = Sloth_Min(sloth_arena_commit_round_(needed), arena->reserved);
+    if (sloth_vm_commit_(arena->base + arena->committed, new_committed - arena->committed)) {
+      arena->committed = new_committed;
+      arena->stats_cycle.grows += 1;
+    }
+  }
+#else
   if (!arena->buckets) {
     arena->buckets = sloth_array_grow(arena->buckets, 0, &arena->buckets_cap, 64, Sloth_U8*);
     sloth_zero_size__(sizeof(Sloth_U8*) * 64, (Sloth_U8*)arena->buckets);
@@ -1684,33 +3303,73 @@ sloth_arena_grow(Sloth_Arena* arena, Sloth_U32 min_size)
   }
   if (arena->curr_bucket_len + min_size >= arena->bucket_cap)
   {
+    arena->stats_cycle.wasted += arena->bucket_cap - arena->curr_bucket_len;
     arena->buckets_len += 1;
+    
+    // NOTE: the next bucket might already exist if the arena
+    // was cleared, in which case we still start at its beginning
+    arena->curr_bucket_len = 0;
+  }
+  if (arena->buckets_len >= arena->buckets_cap)
+  {
+    Sloth_U32 old_cap = arena->buckets_cap;
+    arena->buckets = sloth_array_grow(arena->buckets, arena->buckets_len, &arena->buckets_cap, 64, Sloth_U8*);
+    sloth_zero_size__(sizeof(Sloth_U8*) * (arena->buckets_cap - old_cap), (Sloth_U8*)(arena->buckets + old_cap));
   }
   sloth_assert(arena->buckets_len < arena->buckets_cap);
   if (!arena->buckets[arena->buckets_len]) {
     Sloth_U32 unused = 0;
     arena->buckets[arena->buckets_len] = sloth_array_grow(arena->buckets[arena->buckets_len], 0, &unused, Sloth_Max(arena->bucket_cap, min_size), Sloth_U8);
     arena->curr_bucket_len = 0;
+    arena->stats_cycle.grows += 1;
   }
+#endif
 }
 
 Sloth_Function Sloth_U8* 
 sloth_arena_push(Sloth_Arena* arena, Sloth_U32 size)
 {
   SLOTH_PROFILE_BEGIN;
+#if SLOTH_ARENA_VIRTUAL
+  if (arena->at + size > arena->committed) {
+    sloth_arena_grow(arena, size);
+    if (arena->at + size > arena->committed) return 0;
+  }
+  
+  Sloth_U8* result = arena->base + arena->at;
+  arena->at += size;
+  arena->high_water = Sloth_Max(arena->high_water, arena->at);
+#else
   if (arena->curr_bucket_len + size > arena->bucket_cap) sloth_arena_grow(arena, size);
   
   Sloth_U8* bucket = arena->buckets[arena->buckets_len];
   Sloth_U8* result = bucket + arena->curr_bucket_len;
   arena->curr_bucket_len += size;
+#endif
+  
+  arena->stats_cycle.pushes += 1;
+  arena->stats_cycle.pushed += size;
+  arena->stats_cycle.peak = Sloth_Max(arena->stats_cycle.peak, sloth_arena_pos_(arena));
   
   return result;
 }
 
+// NOTE: popping only moves the arena's position back. In DEBUG builds
+// the popped memory is also zeroed so stale reads show up
 Sloth_Function void
 sloth_arena_pop(Sloth_Arena* arena, Sloth_Arena_Loc to)
 {
   SLOTH_PROFILE_BEGIN;
+#if SLOTH_ARENA_VIRTUAL
+  if (to.bucket_index != 0) return;
+  if (to.bucket_at > arena->at) return;
+  
+  // @DebugClear
+#  ifdef DEBUG
+  sloth_zero_size__(arena->at - to.bucket_at, arena->base + to.bucket_at);
+#  endif
+  arena->at = to.bucket_at;
+#else
   if (to.bucket_index > arena->buckets_cap) return;
   if (to.bucket_index > arena->buckets_len) return;
   if (to.bucket_at > arena->bucket_cap) return;
@@ -1722,6 +3381,8 @@ sloth_arena_pop(Sloth_Arena* arena, Sloth_Arena_Loc to)
   arena->buckets_len = to.bucket_index;
   arena->curr_bucket_len = to.bucket_at;
   
+  // @DebugClear
+#  ifdef DEBUG
   if (to.bucket_index == bucket_before)
   {
     Sloth_U32 rewind_dist = bucket_before_len - to.bucket_at;
@@ -1742,6 +3403,10 @@ sloth_arena_pop(Sloth_Arena* arena, Sloth_Arena_Loc to)
   {
     sloth_invalid_code_path;
   }
+#  else
+  (void)bucket_before; (void)bucket_before_len;
+#  endif
+#endif
 }
 
 Sloth_Function Sloth_Arena_Loc
@@ -1749,8 +3414,13 @@ sloth_arena_at(Sloth_Arena* arena)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_Arena_Loc result;
+#if SLOTH_ARENA_VIRTUAL
+  result.bucket_index = 0;
+  result.bucket_at = arena->at;
+#else
   result.bucket_index = arena->buckets_len;
   result.bucket_at = arena->curr_bucket_len;
+#endif
   return result;;
 }
 
@@ -1758,23 +3428,76 @@ Sloth_Function void
 sloth_arena_clear(Sloth_Arena* arena)
 {
   SLOTH_PROFILE_BEGIN;
+  arena->stats_last_cycle = arena->stats_cycle;
+  arena->stats_peak_max = Sloth_Max(arena->stats_peak_max, arena->stats_cycle.peak);
+  sloth_zero_struct_(&arena->stats_cycle);
+  
+#if SLOTH_ARENA_VIRTUAL
+  // @DebugClear
+#  ifdef DEBUG
+  if (arena->base) sloth_zero_size__(arena->high_water, arena->base);
+#  endif
+  
+  // Anything committed past what this cycle actually used came from
+  // an earlier spike. Give it back rather than holding it forever
+  Sloth_U32 keep = sloth_arena_commit_round_(arena->high_water);
+  if (arena->committed > keep)
+  {
+    sloth_vm_decommit_(arena->base + keep, arena->committed - keep);
+    arena->committed = keep;
+  }
+  arena->at = 0;
+  arena->high_water = 0;
+#else
   arena->buckets_len = 0;
   arena->curr_bucket_len = 0;
   
   // @DebugClear
-#ifdef DEBUG
+#  ifdef DEBUG
   for (Sloth_U32 i = 0; i < arena->buckets_cap; i++)
   {
     Sloth_U8* bucket = arena->buckets[i];
     if (bucket) sloth_zero_size__(arena->bucket_cap, bucket);
   }
+#  endif
+#endif
+}
+
+Sloth_Function Sloth_Arena_Stats
+sloth_arena_stats(Sloth_Arena* arena)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Arena_Stats result = SLOTH_ZII;
+  result.used = sloth_arena_pos_(arena);
+#if SLOTH_ARENA_VIRTUAL
+  result.committed = arena->committed;
+  result.reserved = arena->reserved;
+#else
+  for (Sloth_U32 i = 0; i < arena->buckets_cap; i++)
+  {
+    if (arena->buckets[i]) result.buckets += 1;
+  }
+  result.committed = (Sloth_U64)result.buckets * arena->bucket_cap;
+  result.reserved = result.committed;
 #endif
+  result.cycle = arena->stats_cycle;
+  result.last_cycle = arena->stats_last_cycle;
+  result.peak_max = Sloth_Max(arena->stats_peak_max, arena->stats_cycle.peak);
+  return result;
 }
 
 Sloth_Function void      
 sloth_arena_free(Sloth_Arena* arena)
 {
   SLOTH_PROFILE_BEGIN;
+#if SLOTH_ARENA_VIRTUAL
+  if (arena->base) sloth_vm_release_(arena->base, arena->reserved);
+  arena->base = 0;
+  arena->reserved = 0;
+  arena->committed = 0;
+  arena->at = 0;
+  arena->high_water = 0;
+#endif
   for (Sloth_U32 i = 0; i < arena->buckets_cap; i++)
   {
     Sloth_U8* bucket = arena->buckets[i];
@@ -1787,6 +3510,9 @@ sloth_arena_free(Sloth_Arena* arena)
   arena->buckets_len = 0;
   arena->bucket_cap = 0;
   arena->curr_bucket_len = 0;
+  sloth_zero_struct_(&arena->stats_cycle);
+  sloth_zero_struct_(&arena->stats_last_cycle);
+  arena->stats_peak_max = 0;
 }
 
 #if !defined(SLOTH_NO_CSTD_LIBRARY)
@@ -1816,6 +3542,83 @@ sloth_font_load(Sloth_Ctx* sloth, char* path, Sloth_R32 pixel_height)
   return result;
 }
 
+Sloth_Function Sloth_Bool
+sloth_glyph_cache_save_file(Sloth_Ctx* sloth, char* path)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 size = sloth_glyph_cache_size(sloth);
+  Sloth_U8* data = (Sloth_U8*)malloc(size);
+  if (!data) return false;
+  sloth_glyph_cache_write(sloth, data, size);
+  
+  Sloth_Bool result = false;
+  FILE* file = fopen(path, "wb");
+  if (file) 
+  {
+    result = fwrite(data, size, 1, file) == 1;
+    fclose(file);
+  }
+  free(data);
+  return result;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+
+// The cache is copied out of the mapping while loading, so it 
+// never has to be read into a buffer of its own
+Sloth_Function Sloth_Bool
+sloth_glyph_cache_load_file(Sloth_Ctx* sloth, char* path)
+{
+  SLOTH_PROFILE_BEGIN;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+  
+  Sloth_Bool result = false;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+  {
+    size_t size = (size_t)file_stat.st_size;
+    void* data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      result = sloth_glyph_cache_load(sloth, (Sloth_U8*)data, (Sloth_U32)size);
+      munmap(data, size);
+    }
+  }
+  close(fd);
+  return result;
+}
+
+#else
+
+Sloth_Function Sloth_Bool
+sloth_glyph_cache_load_file(Sloth_Ctx* sloth, char* path)
+{
+  SLOTH_PROFILE_BEGIN;
+  FILE* file = fopen(path, "rb");
+  if (!file) return false;
+  
+  fseek(file, 0, SEEK_END);
+  Sloth_U32 size = (Sloth_U32)ftell(file);
+  fseek(file, 0, SEEK_SET);
+  
+  Sloth_Bool result = false;
+  Sloth_U8* data = (Sloth_U8*)malloc(size);
+  if (data && fread(data, size, 1, file) == 1) 
+  {
+    result = sloth_glyph_cache_load(sloth, data, size);
+  }
+  free(data);
+  fclose(file);
+  return result;
+}
+
+#endif
+
 #endif // !defined(SLOTH_NO_CSTD_LIBRARY)
 
 Sloth_Function Sloth_Font_ID 
@@ -1871,6 +3674,88 @@ sloth_font_register_codepoint(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32
   return result;
 }
 
+Sloth_Function void
+sloth_font_request_codepoint(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint)
+{
+  SLOTH_PROFILE_BEGIN;
+  if (!sloth->font_renderer_register_glyph && !sloth->font_renderer_register_glyphs) return;
+  
+  Sloth_U32 family = 0;
+  if (sloth->fonts) family = sloth->fonts[font_id.value].weights[font_id.weight_index].glyph_family;
+  Sloth_Glyph_ID id = sloth_make_glyph_id(family, codepoint);
+  if (sloth_glyph_store_contains(&sloth->glyph_store, id)) return;
+  if (sloth_hashtable_get(&sloth->glyph_requests_lut, id.value)) return;
+  
+  sloth->glyph_requests = sloth_array_grow(sloth->glyph_requests, sloth->glyph_requests_len, &sloth->glyph_requests_cap, 32, Sloth_Glyph_Request);
+  Sloth_U32 request_index = sloth->glyph_requests_len++;
+  Sloth_Glyph_Request* request = sloth->glyph_requests + request_index;
+  request->font = font_id;
+  request->codepoint = codepoint;
+  
+  // glyph_requests moves when it grows, so the lut holds the
+  // request's index, plus one so it's never 0, not a pointer to it
+  sloth_hashtable_add(&sloth->glyph_requests_lut, id.value, sloth_desc_table_lut_value_(request_index + 1));
+}
+
+// Rasterizes everything requested since the last call in one batch
+Sloth_Function void
+sloth_font_register_requested_glyphs_(Sloth_Ctx* sloth)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 len = sloth->glyph_requests_len;
+  if (len == 0) return;
+  
+  if (sloth->font_renderer_register_glyphs)
+  {
+    sloth->font_renderer_register_glyphs(sloth, sloth->glyph_requests, len);
+  }
+  else
+  {
+    for (Sloth_U32 i = 0; i < len; i++)
+    {
+      Sloth_Glyph_Request r = sloth->glyph_requests[i];
+      sloth->font_renderer_register_glyph(sloth, r.font, r.codepoint);
+    }
+  }
+  
+  for (Sloth_U32 i = 0; i < len; i++)
+  {
+    Sloth_Glyph_Request r = sloth->glyph_requests[i];
+    Sloth_U32 family = 0;
+    if (sloth->fonts) family = sloth->fonts[r.font.value].weights[r.font.weight_index].glyph_family;
+    sloth_hashtable_rem(&sloth->glyph_requests_lut, sloth_make_glyph_id(family, r.codepoint).value);
+  }
+  sloth->glyph_requests_len = 0;
+}
+
+Sloth_Function void
+sloth_font_prewarm(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_Codepoint_Range* ranges, Sloth_U32 ranges_len)
+{
+  SLOTH_PROFILE_BEGIN;
+  for (Sloth_U32 range_i = 0; range_i < ranges_len; range_i++)
+  {
+    Sloth_Codepoint_Range range = ranges[range_i];
+    for (Sloth_U32 codepoint = range.first; codepoint < range.one_past_last; codepoint++)
+    {
+      sloth_font_request_codepoint(sloth, font_id, codepoint);
+    }
+  }
+  sloth_font_register_requested_glyphs_(sloth);
+}
+
+// Runs job for every index in [0, count), across threads if the
+// application provided sloth->parallel_for
+Sloth_Function void
+sloth_parallel_for_(Sloth_Ctx* sloth, Sloth_U32 count, Sloth_Parallel_Job* job, Sloth_U8* user_data)
+{
+  if (sloth->parallel_for) 
+  {
+    sloth->parallel_for(sloth, count, job, user_data);
+    return;
+  }
+  for (Sloth_U32 i = 0; i < count; i++) job(sloth, i, user_data);
+}
+
 Sloth_Function Sloth_Font*
 sloth_glyph_to_font(Sloth_Ctx* sloth, Sloth_Glyph_ID glyph_id)
 {
@@ -1939,7 +3824,16 @@ sloth_get_vibuffer_for_glyph(Sloth_Ctx* sloth, Sloth_Glyph_ID glyph)
   SLOTH_PROFILE_BEGIN;
   Sloth_VIBuffer* result = 0;
   Sloth_U32 index = SLOTH_GLYPH_ID_TO_INDEX(glyph);
+  
+  // a glyph that spilled out of its family's atlas is drawn with 
+  // the page it's on
+  Sloth_Glyph* registered = (Sloth_Glyph*)sloth_hashtable_get(&sloth->glyph_store.glyphs_table, glyph.value);
+  if (registered) index = registered->atlas_index;
   if (sloth->glyph_atlases_cap > index) {
+#if SLOTH_ATLAS_MERGED
+    // every atlas is drawn together, in the order quads are pushed
+    if (sloth->glyph_atlases_merged) index = 0;
+#endif
     result = sloth->vibuffers + index;
   }
   return result;
@@ -1950,19 +3844,235 @@ sloth_glyph_atlas_resize(Sloth_Glyph_Atlas* atlas, Sloth_U32 new_dim)
 {
   SLOTH_PROFILE_BEGIN;
   sloth_assert(sloth_is_pow2(new_dim));
-  Sloth_U32 new_cap = new_dim * new_dim;
-  Sloth_U32 old_cap = atlas->dim * atlas->dim;
-  atlas->data = (Sloth_U8*)sloth_realloc_array(atlas->data, Sloth_U32, old_cap, new_cap);
+  Sloth_U32 old_dim = atlas->dim;
+  Sloth_U32 new_size = new_dim * new_dim * sizeof(Sloth_U32);
+  Sloth_U8* new_data = sloth_realloc(0, 0, new_size);
+  sloth_zero_size__(new_size, new_data);
+  
+  // Existing pixels keep their coordinates, so glyphs that are 
+  // already packed stay valid, and the new space is to the right 
+  // and above them
+  Sloth_U32 copy_dim = Sloth_Min(old_dim, new_dim);
+  for (Sloth_U32 y = 0; y < copy_dim; y++)
+  {
+    Sloth_U8* src = atlas->data + (y * old_dim * sizeof(Sloth_U32));
+    Sloth_U8* dst = new_data + (y * new_dim * sizeof(Sloth_U32));
+    sloth_copy_memory(dst, src, copy_dim * sizeof(Sloth_U32));
+  }
+  sloth_realloc(atlas->data, old_dim * old_dim * sizeof(Sloth_U32), 0);
+  atlas->data = new_data;
   atlas->dim = new_dim;
   atlas->dirty_state = Sloth_GlyphAtlas_Dirty_Grow;
+  atlas->dirty_rects_len = 0;
+  
+  if (new_dim > old_dim)
+  {
+    atlas->skyline = sloth_array_grow(atlas->skyline, atlas->skyline_len, &atlas->skyline_cap, 16, Sloth_Skyline_Node);
+    Sloth_Skyline_Node* node = atlas->skyline + atlas->skyline_len++;
+    node->x = old_dim;
+    node->y = 0;
+    node->width = new_dim - old_dim;
+  }
+  else
+  {
+    while (atlas->skyline_len > 0 && atlas->skyline[atlas->skyline_len - 1].x >= new_dim) {
+      atlas->skyline_len -= 1;
+    }
+    if (atlas->skyline_len > 0) {
+      Sloth_Skyline_Node* last = atlas->skyline + atlas->skyline_len - 1;
+      last->width = new_dim - last->x;
+    }
+  }
+}
+
+// Records that a region of the atlas changed. A grown atlas is 
+// already going to be uploaded whole, so it doesn't track regions
+Sloth_Function void
+sloth_glyph_atlas_mark_dirty_(Sloth_Glyph_Atlas* atlas, Sloth_U32 x, Sloth_U32 y, Sloth_U32 width, Sloth_U32 height)
+{
+  if (atlas->dirty_state == Sloth_GlyphAtlas_Dirty_Grow) return;
+  atlas->dirty_state = Sloth_GlyphAtlas_Dirty_UpdateData;
+  
+  if (atlas->dirty_rects_len < SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX)
+  {
+    Sloth_Glyph_Atlas_Dirty_Rect* r = atlas->dirty_rects + atlas->dirty_rects_len++;
+    r->x = x;
+    r->y = y;
+    r->width = width;
+    r->height = height;
+    return;
+  }
+  
+  // Out of rects, so grow the one that needs to grow the least
+  Sloth_U32 best = 0;
+  Sloth_U64 best_growth = 0xFFFFFFFFFFFFFFFF;
+  for (Sloth_U32 i = 0; i < atlas->dirty_rects_len; i++)
+  {
+    Sloth_Glyph_Atlas_Dirty_Rect r = atlas->dirty_rects[i];
+    Sloth_U32 x0 = Sloth_Min(r.x, x);
+    Sloth_U32 y0 = Sloth_Min(r.y, y);
+    Sloth_U32 x1 = Sloth_Max(r.x + r.width, x + width);
+    Sloth_U32 y1 = Sloth_Max(r.y + r.height, y + height);
+    Sloth_U64 growth = ((Sloth_U64)(x1 - x0) * (y1 - y0)) - ((Sloth_U64)r.width * r.height);
+    if (growth < best_growth) 
+    {
+      best = i;
+      best_growth = growth;
+    }
+  }
+  
+  Sloth_Glyph_Atlas_Dirty_Rect* r = atlas->dirty_rects + best;
+  Sloth_U32 x1 = Sloth_Max(r->x + r->width, x + width);
+  Sloth_U32 y1 = Sloth_Max(r->y + r->height, y + height);
+  r->x = Sloth_Min(r->x, x);
+  r->y = Sloth_Min(r->y, y);
+  r->width = x1 - r->x;
+  r->height = y1 - r->y;
+}
+
+// Finds the lowest spot a width x height rect can rest on the skyline
+// and raises the skyline over it. Returns false if it doesn't fit
+Sloth_Function Sloth_Bool
+sloth_glyph_atlas_pack_(Sloth_Glyph_Atlas* atlas, Sloth_U32 width, Sloth_U32 height, Sloth_U32* x_out, Sloth_U32* y_out)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Skyline_Node* nodes = atlas->skyline;
+  Sloth_U32 best = atlas->skyline_len;
+  Sloth_U32 best_y = atlas->dim;
+  for (Sloth_U32 i = 0; i < atlas->skyline_len; i++)
+  {
+    if (nodes[i].x + width > atlas->dim) break;
+    
+    // the rect rests on the tallest span beneath it
+    Sloth_U32 y = 0;
+    Sloth_U32 right = nodes[i].x + width;
+    for (Sloth_U32 j = i; j < atlas->skyline_len && nodes[j].x < right; j++) {
+      y = Sloth_Max(y, nodes[j].y);
+    }
+    if (y + height > atlas->dim) continue;
+    if (y < best_y) 
+    {
+      best = i;
+      best_y = y;
+    }
+  }
+  if (best == atlas->skyline_len) return false;
+  
+  Sloth_Skyline_Node rect;
+  rect.x = nodes[best].x;
+  rect.y = best_y + height;
+  rect.width = width;
+  Sloth_U32 right = rect.x + width;
+  
+  // Spans entirely under the rect are replaced by it, and one it
+  // only partially covers gets shorter
+  Sloth_U32 covered_end = best;
+  while (covered_end < atlas->skyline_len && nodes[covered_end].x + nodes[covered_end].width <= right) {
+    covered_end++;
+  }
+  if (covered_end < atlas->skyline_len && nodes[covered_end].x < right)
+  {
+    nodes[covered_end].width -= right - nodes[covered_end].x;
+    nodes[covered_end].x = right;
+  }
+  
+  Sloth_U32 covered = covered_end - best;
+  if (covered == 0)
+  {
+    atlas->skyline = sloth_array_grow(atlas->skyline, atlas->skyline_len, &atlas->skyline_cap, 16, Sloth_Skyline_Node);
+    nodes = atlas->skyline;
+    for (Sloth_U32 i = atlas->skyline_len; i > best; i--) nodes[i] = nodes[i - 1];
+    atlas->skyline_len += 1;
+  }
+  else
+  {
+    for (Sloth_U32 i = covered_end; i < atlas->skyline_len; i++) nodes[i - covered + 1] = nodes[i];
+    atlas->skyline_len -= covered - 1;
+  }
+  nodes[best] = rect;
+  
+  // merge neighboring spans at the same height
+  Sloth_U32 len = 1;
+  for (Sloth_U32 i = 1; i < atlas->skyline_len; i++)
+  {
+    if (nodes[i].y == nodes[len - 1].y) {
+      nodes[len - 1].width += nodes[i].width;
+    } else {
+      nodes[len++] = nodes[i];
+    }
+  }
+  atlas->skyline_len = len;
+  
+  *x_out = rect.x;
+  *y_out = best_y;
+  return true;
+}
+
+// The merged texture is a square grid of tiles, each big enough for
+// the largest atlas, with ceil(sqrt(tiles)) tiles per row. Atlases
+// smaller than a tile sit in its top left corner. This is 
+// recomputed whenever an atlas is created or grows, both of which 
+// invalidate any cached glyph uvs
+Sloth_Function void
+sloth_glyph_atlases_layout_merged_(Sloth_Ctx* sloth)
+{
+  Sloth_U32 tile_dim = 0;
+  for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++) {
+    tile_dim = Sloth_Max(tile_dim, sloth->glyph_atlases[i].dim);
+  }
+  Sloth_U32 tiles_per_row = 1;
+  while (tiles_per_row * tiles_per_row < sloth->glyph_atlases_merged_tiles) {
+    tiles_per_row += 1;
+  }
+  
+  Sloth_U64 merged_dim = (Sloth_U64)tiles_per_row * tile_dim;
+  Sloth_U32 max_dim = SLOTH_ATLAS_MERGED_MAX_DIM;
+  if (sloth->glyph_atlases_merged_max_dim != 0) {
+    max_dim = Sloth_Min(max_dim, sloth->glyph_atlases_merged_max_dim);
+  }
+#if SLOTH_ATLAS_MERGED
+  Sloth_Bool was_merged = sloth->glyph_atlases_merged;
+#endif
+  sloth->glyph_atlases_merged = merged_dim <= max_dim;
+  
+  sloth->glyph_atlases_tile_dim = tile_dim;
+  sloth->glyph_atlases_merged_tiles_per_row = tiles_per_row;
+  sloth->glyph_atlases_merged_dim = sloth->glyph_atlases_merged ? (Sloth_U32)merged_dim : 0;
+  
+#if SLOTH_ATLAS_MERGED
+  // Moving between one texture and a texture per atlas moves every 
+  // atlas's pixels, so they all have to be uploaded again
+  if (was_merged != sloth->glyph_atlases_merged)
+  {
+    for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++)
+    {
+      Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + i;
+      if (!atlas->data) continue;
+      atlas->dirty_state = Sloth_GlyphAtlas_Dirty_Grow;
+      atlas->dirty_rects_len = 0;
+    }
+  }
+#endif
+}
+
+Sloth_Function void
+sloth_glyph_atlas_merged_origin_(Sloth_Ctx* sloth, Sloth_Glyph_Atlas* atlas, Sloth_U32* x, Sloth_U32* y)
+{
+  Sloth_U32 tile_dim = sloth->glyph_atlases_tile_dim;
+  Sloth_U32 tiles_per_row = sloth->glyph_atlases_merged_tiles_per_row;
+  sloth_assert(tile_dim > 0 && tiles_per_row > 0);
+  *x = (atlas->merged_tile % tiles_per_row) * tile_dim;
+  *y = (atlas->merged_tile / tiles_per_row) * tile_dim;
 }
 
+// index is the family for a family's first atlas, and 
+// SLOTH_GLYPH_ATLAS_FIRST_PAGE or higher for its additional pages
 Sloth_Function Sloth_Glyph_Atlas* 
-sloth_create_atlas(Sloth_Ctx* sloth, Sloth_U8 family, Sloth_U32 min_dim)
+sloth_create_atlas_at_(Sloth_Ctx* sloth, Sloth_U32 index, Sloth_U8 family, Sloth_U32 min_dim)
 {
-  if (family >= sloth->glyph_atlases_cap) 
+  if (index >= sloth->glyph_atlases_cap) 
   {
-    Sloth_U32 new_cap = Sloth_Max(family + 1, SLOTH_GLYPH_ATLASES_MIN_CAP);
+    Sloth_U32 new_cap = Sloth_Max(index + 1, SLOTH_GLYPH_ATLASES_MIN_CAP);
     
     // resize the glyph atlas array
     Sloth_U32 old_size = sizeof(Sloth_Glyph_Atlas) * sloth->glyph_atlases_cap;
@@ -1982,18 +4092,26 @@ sloth_create_atlas(Sloth_Ctx* sloth, Sloth_U8 family, Sloth_U32 min_dim)
     
     sloth->glyph_atlases_cap = new_cap;
   }
-  sloth_assert(sloth->glyph_atlases_cap > family);
+  sloth_assert(sloth->glyph_atlases_cap > index);
   
   Sloth_U32 atlas_dim = Sloth_Max(SLOTH_GLYPH_ATLAS_START_DIM, min_dim);
   
-  Sloth_Glyph_Atlas* result = sloth->glyph_atlases + family;
+  Sloth_Glyph_Atlas* result = sloth->glyph_atlases + index;
   sloth_assert(result->id == 0);
   result->id = family;
+  result->merged_tile = sloth->glyph_atlases_merged_tiles++;
   sloth_glyph_atlas_resize(result, atlas_dim);
+  sloth_glyph_atlases_layout_merged_(sloth);
   
   return result;
 }
 
+Sloth_Function Sloth_Glyph_Atlas* 
+sloth_create_atlas(Sloth_Ctx* sloth, Sloth_U8 family, Sloth_U32 min_dim)
+{
+  return sloth_create_atlas_at_(sloth, family, family, min_dim);
+}
+
 Sloth_Function Sloth_U32
 sloth_xy_to_texture_offset(Sloth_U32 x, Sloth_U32 y, Sloth_U32 dim, Sloth_U32 bytes_per_pixel)
 {
@@ -2036,6 +4154,26 @@ sloth_color_apply_gamma(Sloth_U32 color, Sloth_R32 power)
   return result; 
 }
 
+// The table points into glyphs, so every entry is updated when 
+// glyphs moves
+Sloth_Function void
+sloth_glyph_store_grow_(Sloth_Glyph_Store* store, Sloth_U32 min_cap)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 len = store->glyphs_table.used;
+  Sloth_U32 old_cap = store->glyphs_cap;
+  while (store->glyphs_cap < min_cap)
+  {
+    store->glyphs = sloth_array_grow(store->glyphs, store->glyphs_cap, &store->glyphs_cap, 256, Sloth_Glyph);
+  }
+  store->ids = sloth_realloc_array(store->ids, Sloth_Glyph_ID, old_cap, store->glyphs_cap);
+  for (Sloth_U32 i = 0; i < len; i++)
+  {
+    sloth_hashtable_rem(&store->glyphs_table, store->ids[i].value);
+    sloth_hashtable_add(&store->glyphs_table, store->ids[i].value, (Sloth_U8*)(store->glyphs + i));
+  }
+}
+
 Sloth_Function Sloth_Glyph_ID   
 sloth_register_glyph(Sloth_Ctx* sloth, Sloth_Glyph_Desc desc)
 {
@@ -2043,7 +4181,7 @@ sloth_register_glyph(Sloth_Ctx* sloth, Sloth_Glyph_Desc desc)
   Sloth_Glyph_Store* store = &sloth->glyph_store;
   if (!store->glyphs || store->glyphs_table.used >= store->glyphs_cap) 
   {
-    store->glyphs = sloth_array_grow(store->glyphs, store->glyphs_table.used, &store->glyphs_cap, 256, Sloth_Glyph);
+    sloth_glyph_store_grow_(store, store->glyphs_table.used + 1);
   }
   
   Sloth_Glyph_ID new_glyph_id;
@@ -2051,85 +4189,57 @@ sloth_register_glyph(Sloth_Ctx* sloth, Sloth_Glyph_Desc desc)
   new_glyph_id.family = desc.family & 0xFF;
   
   // check if this glyph has already been registered
-  if (sloth_hashtable_lookup_index_(&store->glyphs_table, new_glyph_id.value, 0) != 0) {
+  if (sloth_hashtable_get(&store->glyphs_table, new_glyph_id.value) != 0) {
     return new_glyph_id;
   }
   
   Sloth_U32 new_glyph_index = store->glyphs_table.used;
   Sloth_Glyph* new_glyph = store->glyphs + new_glyph_index;
+  store->ids[new_glyph_index] = new_glyph_id;
   sloth_hashtable_add(&store->glyphs_table, new_glyph_id.value, (Sloth_U8*)new_glyph);
+  store->generation += 1;
+  
+  // Find room for the glyph and its apron, growing the family's atlas
+  // up to SLOTH_GLYPH_ATLAS_MAX_DIM, and spilling into pages past that
+  Sloth_U32 apron_dim = 2;
+  Sloth_U32 rect_width = desc.src_width + apron_dim;
+  Sloth_U32 rect_height = desc.src_height + apron_dim;
+  Sloth_U32 min_dim = sloth_round_to_pow2_u32(Sloth_Max(rect_width, rect_height));
   
-  // Get correct atlas for the glyph being registered
+  Sloth_U32 atlas_index = SLOTH_GLYPH_ID_TO_INDEX(new_glyph_id);
   Sloth_Glyph_Atlas* atlas = sloth_get_atlas_for_glyph(sloth, new_glyph_id);
-  if (!atlas) 
+  if (!atlas || !atlas->data) 
   {
-    Sloth_U32 min_dim = Sloth_Max(desc.src_width, desc.src_height);
-    min_dim = sloth_round_to_pow2_u32(min_dim);
     atlas = sloth_create_atlas(sloth, new_glyph_id.family, min_dim);
   }
   sloth_assert(atlas != 0);
   
-  // TODO(PS): glyphs_table.used > 1 is because we've already
-  // added the new glyph. If its the first glyph, there is no
-  // previous glyph, but the table has a glyph in it already.
-  //
-  Sloth_U32 dst_x = 0;
-  Sloth_U32 dst_y = 1;
-  if (store->glyphs_table.used > 1) {
-    Sloth_Glyph last_glyph = store->glyphs[atlas->last_glyph];
-    dst_x = last_glyph.offset_x + last_glyph.src_width + 1; // add room for apron
-    dst_y = last_glyph.offset_y;
-  }
-  atlas->last_glyph = new_glyph_index;
-  
-  // See if we need to move to a new row
-  Sloth_U32 apron_dim = 2;
-  if ((dst_x + desc.src_width + apron_dim) > atlas->dim)
-  {    
-    dst_x = 0;
-    
-    // Find the tallest glyph in the previous row and start the next
-    // row above that glyph
-    // TODO: This is inefficient, but its simple     
-    for(Sloth_U32 glyph_row_i = atlas->last_row_first_glyph;
-      glyph_row_i < new_glyph_index;
-      glyph_row_i++
-    ){
-      Sloth_Glyph row_glyph = store->glyphs[glyph_row_i];
-      Sloth_R32 next_row_y = row_glyph.offset_y + row_glyph.src_height;
-      dst_y = Sloth_Max(dst_y, next_row_y);
+  Sloth_U32 apron_x = 0;
+  Sloth_U32 apron_y = 0;
+  while (!sloth_glyph_atlas_pack_(atlas, rect_width, rect_height, &apron_x, &apron_y))
+  {
+    if (atlas->dim < SLOTH_GLYPH_ATLAS_MAX_DIM)
+    {
+      sloth_glyph_atlas_resize(atlas, atlas->dim * 2);
+      sloth_glyph_atlases_layout_merged_(sloth);
     }
-    dst_y += apron_dim / 2;
-    
-    atlas->last_row_first_glyph = new_glyph_index;
-    
-    if (dst_y + desc.src_height + (apron_dim / 2) >= atlas->dim)
+    else if (atlas->next_page)
     {
-      // TODO: I'm punting this case till later. Current implementation
-      // will auto create the texture with size 2048x2048 if its null, but
-      // wont grow again beyond that.
-      // The complexity I don't want to deal with right now is that wehn
-      // the texture is resized, it either has to:
-      //   a) reflow all existing glyphs (I don't like this)
-      //   b) begin finding the empty space to the right of existing rows
-      //      of glyphs.
-      // b is the solution I want to go with but I don't want to do that
-      // right now
-      
-      
-      // NOTE: If this assert fires, you just need to grow your glyph dim
-      
-      // TODO: It would be nice if this would just do it for you, or better yet
-      // do it if we're under some bound (Say 4096) but create a second texture 
-      // if we're above. To do that, it'll also want to make sure things like
-      // Glyph Families (ie. a font's sprites) are all on one texture
-      sloth_assert(dst_y + desc.src_height < atlas->dim);
+      atlas_index = atlas->next_page;
+      atlas = sloth->glyph_atlases + atlas_index;
+    }
+    else
+    {
+      // a new page is always big enough for the glyph
+      Sloth_U32 page_index = Sloth_Max(sloth->glyph_atlases_cap, SLOTH_GLYPH_ATLAS_FIRST_PAGE);
+      atlas->next_page = page_index;
+      atlas = sloth_create_atlas_at_(sloth, page_index, new_glyph_id.family, min_dim);
+      atlas_index = page_index;
     }
   }
   
-  Sloth_U32 apron_x = dst_x;
-  Sloth_U32 apron_y = dst_y - 1;
-  dst_x += 1;
+  Sloth_U32 dst_x = apron_x + (apron_dim / 2);
+  Sloth_U32 dst_y = apron_y + (apron_dim / 2);
   
   new_glyph->offset_x = dst_x;
   new_glyph->offset_y = dst_y;
@@ -2140,6 +4250,7 @@ sloth_register_glyph(Sloth_Ctx* sloth, Sloth_Glyph_Desc desc)
   new_glyph->lsb = desc.cursor_to_glyph_start_xoff;
   new_glyph->x_advance = desc.cursor_to_next_glyph;
   new_glyph->baseline_offset_y = desc.baseline_offset_y;
+  new_glyph->atlas_index = atlas_index;
   
   if (desc.data)
   {
@@ -2246,7 +4357,7 @@ sloth_register_glyph(Sloth_Ctx* sloth, Sloth_Glyph_Desc desc)
   }
 #endif // DRAW_APRON
   
-  atlas->dirty_state = Sloth_GlyphAtlas_Dirty_UpdateData;
+  sloth_glyph_atlas_mark_dirty_(atlas, apron_x, apron_y, rect_width, rect_height);
   return new_glyph_id;
 }
 
@@ -2276,14 +4387,23 @@ sloth_lookup_glyph(Sloth_Ctx* sloth, Sloth_Glyph_ID id)
   Sloth_Glyph* glyph = (Sloth_Glyph*)sloth_hashtable_get(&store->glyphs_table, id.value);
   if (!glyph) return result;
   
-  Sloth_Glyph_Atlas* atlas = sloth_get_atlas_for_glyph(sloth, id);
+  Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + glyph->atlas_index;
+  Sloth_U32 tile_x = 0;
+  Sloth_U32 tile_y = 0;
   Sloth_R32 atlas_dim = (Sloth_R32)atlas->dim;
+#if SLOTH_ATLAS_MERGED
+  if (sloth->glyph_atlases_merged)
+  {
+    sloth_glyph_atlas_merged_origin_(sloth, atlas, &tile_x, &tile_y);
+    atlas_dim = (Sloth_R32)sloth->glyph_atlases_merged_dim;
+  }
+#endif
   
   result.glyph = *glyph;
-  result.uv.value_min.x = (Sloth_R32)glyph->offset_x / atlas_dim;
-  result.uv.value_min.y = (Sloth_R32)glyph->offset_y / atlas_dim;
-  result.uv.value_max.x = (Sloth_R32)(glyph->offset_x + glyph->src_width) / atlas_dim;
-  result.uv.value_max.y = (Sloth_R32)(glyph->offset_y + glyph->src_height) / atlas_dim;
+  result.uv.value_min.x = (Sloth_R32)(tile_x + glyph->offset_x) / atlas_dim;
+  result.uv.value_min.y = (Sloth_R32)(tile_y + glyph->offset_y) / atlas_dim;
+  result.uv.value_max.x = (Sloth_R32)(tile_x + glyph->offset_x + glyph->src_width) / atlas_dim;
+  result.uv.value_max.y = (Sloth_R32)(tile_y + glyph->offset_y + glyph->src_height) / atlas_dim;
   
   return result;
 }
@@ -2296,9 +4416,254 @@ sloth_glyph_store_free(Sloth_Glyph_Store* store)
   
   // Free Glyph Storage
   unused = (Sloth_U8*)sloth_realloc_array(store->glyphs, Sloth_Glyph, store->glyphs_cap, 0);
+  unused = (Sloth_U8*)sloth_realloc_array(store->ids, Sloth_Glyph_ID, store->glyphs_cap, 0);
   sloth_hashtable_free(&store->glyphs_table);
 }
 
+//////// GLYPH CACHE ////////
+
+#define SLOTH_GLYPH_CACHE_MAGIC   0x43474C53 // "SLGC"
+#define SLOTH_GLYPH_CACHE_VERSION 2
+
+// A cache is the header, a Sloth_Glyph_Cache_Font_ for each font, 
+// each atlas (a Sloth_Glyph_Cache_Atlas_ followed by its skyline and
+// its dim * dim pixels), every glyph id, and finally every Sloth_Glyph
+typedef struct Sloth_Glyph_Cache_Header_ Sloth_Glyph_Cache_Header_;
+struct Sloth_Glyph_Cache_Header_
+{
+  Sloth_U32 magic;
+  Sloth_U32 version;
+  Sloth_U32 size;
+  Sloth_R32 dpi_scale;
+  Sloth_U32 fonts_len;
+  Sloth_U32 atlases_len;
+  Sloth_U32 glyphs_len;
+};
+
+typedef struct Sloth_Glyph_Cache_Font_ Sloth_Glyph_Cache_Font_;
+struct Sloth_Glyph_Cache_Font_
+{
+  char name[32];
+  Sloth_Font_Metrics metrics;
+  Sloth_Font_Weight_Family weights[SLOTH_FONT_WEIGHTS_CAP];
+  Sloth_U32 weights_len;
+};
+
+typedef struct Sloth_Glyph_Cache_Atlas_ Sloth_Glyph_Cache_Atlas_;
+struct Sloth_Glyph_Cache_Atlas_
+{
+  Sloth_U32 index;
+  Sloth_U32 family;
+  Sloth_U32 dim;
+  Sloth_U32 skyline_len;
+  Sloth_U32 next_page;
+};
+
+Sloth_Function Sloth_Glyph_Cache_Font_
+sloth_glyph_cache_font_(Sloth_Font* font)
+{
+  Sloth_Glyph_Cache_Font_ result;
+  sloth_zero_struct_(&result);
+  sloth_copy_memory(result.name, font->name, sizeof(result.name));
+  result.metrics = font->metrics;
+  sloth_copy_memory(result.weights, font->weights, sizeof(result.weights));
+  result.weights_len = font->weights_len;
+  return result;
+}
+
+Sloth_Function Sloth_U32
+sloth_glyph_cache_size(Sloth_Ctx* sloth)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 result = sizeof(Sloth_Glyph_Cache_Header_);
+  result += sloth->fonts_len * sizeof(Sloth_Glyph_Cache_Font_);
+  for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++)
+  {
+    Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + i;
+    if (!atlas->data) continue;
+    result += sizeof(Sloth_Glyph_Cache_Atlas_);
+    result += atlas->skyline_len * sizeof(Sloth_Skyline_Node);
+    result += atlas->dim * atlas->dim * sizeof(Sloth_U32);
+  }
+  result += sloth->glyph_store.glyphs_table.used * (sizeof(Sloth_Glyph_ID) + sizeof(Sloth_Glyph));
+  return result;
+}
+
+// Returns the number of bytes written, or 0 if dst_size is less
+// than sloth_glyph_cache_size
+Sloth_Function Sloth_U32
+sloth_glyph_cache_write(Sloth_Ctx* sloth, Sloth_U8* dst, Sloth_U32 dst_size)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 size = sloth_glyph_cache_size(sloth);
+  if (dst_size < size) return 0;
+  
+  Sloth_Glyph_Store* store = &sloth->glyph_store;
+  Sloth_Glyph_Cache_Header_ header;
+  sloth_zero_struct_(&header);
+  header.magic = SLOTH_GLYPH_CACHE_MAGIC;
+  header.version = SLOTH_GLYPH_CACHE_VERSION;
+  header.size = size;
+  header.dpi_scale = sloth->screen_dpi_scale;
+  header.fonts_len = sloth->fonts_len;
+  header.glyphs_len = store->glyphs_table.used;
+  for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++)
+  {
+    if (sloth->glyph_atlases[i].data) header.atlases_len += 1;
+  }
+  
+  Sloth_U8* at = dst;
+  sloth_copy_memory(at, &header, sizeof(header));
+  at += sizeof(header);
+  
+  for (Sloth_U32 i = 0; i < sloth->fonts_len; i++)
+  {
+    Sloth_Glyph_Cache_Font_ font = sloth_glyph_cache_font_(sloth->fonts + i);
+    sloth_copy_memory(at, &font, sizeof(font));
+    at += sizeof(font);
+  }
+  
+  for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++)
+  {
+    Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + i;
+    if (!atlas->data) continue;
+    Sloth_Glyph_Cache_Atlas_ cached;
+    cached.index = i;
+    cached.family = atlas->id;
+    cached.dim = atlas->dim;
+    cached.skyline_len = atlas->skyline_len;
+    cached.next_page = atlas->next_page;
+    sloth_copy_memory(at, &cached, sizeof(cached));
+    at += sizeof(cached);
+    
+    Sloth_U32 skyline_size = atlas->skyline_len * sizeof(Sloth_Skyline_Node);
+    sloth_copy_memory(at, atlas->skyline, skyline_size);
+    at += skyline_size;
+    
+    Sloth_U32 pixels_size = atlas->dim * atlas->dim * sizeof(Sloth_U32);
+    sloth_copy_memory(at, atlas->data, pixels_size);
+    at += pixels_size;
+  }
+  
+  Sloth_U32 ids_size = header.glyphs_len * sizeof(Sloth_Glyph_ID);
+  sloth_copy_memory(at, store->ids, ids_size);
+  at += ids_size;
+  Sloth_U32 glyphs_size = header.glyphs_len * sizeof(Sloth_Glyph);
+  sloth_copy_memory(at, store->glyphs, glyphs_size);
+  at += glyphs_size;
+  
+  sloth_assert((Sloth_U32)(at - dst) == size);
+  return size;
+}
+
+// The whole cache is validated before anything is loaded, so a 
+// cache that's rejected leaves sloth untouched
+Sloth_Function Sloth_Bool
+sloth_glyph_cache_load(Sloth_Ctx* sloth, Sloth_U8* data, Sloth_U32 data_size)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Glyph_Store* store = &sloth->glyph_store;
+  if (!data || data_size < sizeof(Sloth_Glyph_Cache_Header_)) return false;
+  if (store->glyphs_table.used > 0) return false;
+  
+  Sloth_Glyph_Cache_Header_ header;
+  sloth_copy_memory(&header, data, sizeof(header));
+  if (header.magic != SLOTH_GLYPH_CACHE_MAGIC) return false;
+  if (header.version != SLOTH_GLYPH_CACHE_VERSION) return false;
+  if (header.size != data_size) return false;
+  if (header.dpi_scale != sloth->screen_dpi_scale) return false;
+  if (header.fonts_len != sloth->fonts_len) return false;
+  
+  Sloth_U8* at = data + sizeof(header);
+  Sloth_U8* end = data + data_size;
+  for (Sloth_U32 i = 0; i < header.fonts_len; i++)
+  {
+    if ((Sloth_U32)(end - at) < sizeof(Sloth_Glyph_Cache_Font_)) return false;
+    Sloth_Glyph_Cache_Font_ font = sloth_glyph_cache_font_(sloth->fonts + i);
+    Sloth_U8* expected = (Sloth_U8*)&font;
+    for (Sloth_U32 b = 0; b < sizeof(font); b++)
+    {
+      if (at[b] != expected[b]) return false;
+    }
+    at += sizeof(font);
+  }
+  
+  Sloth_U8* atlases_at = at;
+  for (Sloth_U32 i = 0; i < header.atlases_len; i++)
+  {
+    Sloth_Glyph_Cache_Atlas_ cached;
+    if ((Sloth_U32)(end - at) < sizeof(cached)) return false;
+    sloth_copy_memory(&cached, at, sizeof(cached));
+    
+    // dim comes from the file, so it's bounded before any size is 
+    // computed from it
+    if (cached.dim == 0 || cached.dim > SLOTH_GLYPH_ATLAS_MAX_DIM || !sloth_is_pow2(cached.dim)) return false;
+    if (cached.family > 0xFF) return false;
+    if (cached.index != cached.family && cached.index < SLOTH_GLYPH_ATLAS_FIRST_PAGE) return false;
+    if (cached.index >= SLOTH_GLYPH_ATLAS_FIRST_PAGE + 0xFF) return false;
+    if (cached.skyline_len == 0 || cached.skyline_len > cached.dim) return false;
+    if (cached.next_page != 0 && cached.next_page < SLOTH_GLYPH_ATLAS_FIRST_PAGE) return false;
+    at += sizeof(cached);
+    
+    Sloth_U64 size = (Sloth_U64)cached.skyline_len * sizeof(Sloth_Skyline_Node);
+    size += (Sloth_U64)cached.dim * cached.dim * sizeof(Sloth_U32);
+    if ((Sloth_U64)(end - at) < size) return false;
+    at += size;
+  }
+  Sloth_U64 ids_size_u64 = (Sloth_U64)header.glyphs_len * sizeof(Sloth_Glyph_ID);
+  Sloth_U64 glyphs_size_u64 = (Sloth_U64)header.glyphs_len * sizeof(Sloth_Glyph);
+  if ((Sloth_U64)(end - at) != ids_size_u64 + glyphs_size_u64) return false;
+  
+  // both fit in the file, so they fit in a U32
+  Sloth_U32 ids_size = (Sloth_U32)ids_size_u64;
+  Sloth_U32 glyphs_size = (Sloth_U32)glyphs_size_u64;
+  
+  at = atlases_at;
+  for (Sloth_U32 i = 0; i < header.atlases_len; i++)
+  {
+    Sloth_Glyph_Cache_Atlas_ cached;
+    sloth_copy_memory(&cached, at, sizeof(cached));
+    at += sizeof(cached);
+    
+    Sloth_Glyph_Atlas* atlas = 0;
+    if (cached.index < sloth->glyph_atlases_cap) atlas = sloth->glyph_atlases + cached.index;
+    if (!atlas || !atlas->data) 
+    {
+      atlas = sloth_create_atlas_at_(sloth, cached.index, (Sloth_U8)cached.family, cached.dim);
+    }
+    if (atlas->dim != cached.dim) 
+    {
+      sloth_glyph_atlas_resize(atlas, cached.dim);
+      sloth_glyph_atlases_layout_merged_(sloth);
+    }
+    atlas->next_page = cached.next_page;
+    atlas->dirty_state = Sloth_GlyphAtlas_Dirty_Grow;
+    
+    Sloth_U32 skyline_size = cached.skyline_len * sizeof(Sloth_Skyline_Node);
+    atlas->skyline = sloth_realloc_array(atlas->skyline, Sloth_Skyline_Node, atlas->skyline_cap, cached.skyline_len);
+    atlas->skyline_cap = cached.skyline_len;
+    atlas->skyline_len = cached.skyline_len;
+    sloth_copy_memory(atlas->skyline, at, skyline_size);
+    at += skyline_size;
+    
+    Sloth_U32 pixels_size = cached.dim * cached.dim * sizeof(Sloth_U32);
+    sloth_copy_memory(atlas->data, at, pixels_size);
+    at += pixels_size;
+  }
+  
+  sloth_glyph_store_grow_(store, header.glyphs_len);
+  sloth_copy_memory(store->ids, at, ids_size);
+  at += ids_size;
+  sloth_copy_memory(store->glyphs, at, glyphs_size);
+  for (Sloth_U32 i = 0; i < header.glyphs_len; i++)
+  {
+    sloth_hashtable_add(&store->glyphs_table, store->ids[i].value, (Sloth_U8*)(store->glyphs + i));
+  }
+  store->generation += 1;
+  
+  return true;
+}
+
 Sloth_Function Sloth_Glyph_ID   
 sloth_make_glyph_id(Sloth_U32 family, Sloth_U32 id)
 {
@@ -2363,13 +4728,14 @@ sloth_mouse_button_held_up (Sloth_Mouse_State btn)
 Sloth_Function void          
 sloth_widget_pool_grow(Sloth_Widget_Pool* pool)
 {
-  pool->values = sloth_array_grow(
-      pool->values,
-    pool->len,
-    &pool->cap,
-    2048,
-    Sloth_Widget
-  );
+  if (pool->len < pool->cap) return;
+  
+  Sloth_U32 new_cap = pool->cap * 2;
+  if (new_cap == 0) new_cap = 2048;
+  pool->values = sloth_realloc_array(pool->values, Sloth_Widget, pool->cap, new_cap);
+  pool->inputs = sloth_realloc_array(pool->inputs, Sloth_Widget_Input, pool->cap, new_cap);
+  pool->texts  = sloth_realloc_array(pool->texts,  Sloth_Widget_Text,  pool->cap, new_cap);
+  pool->cap = new_cap;
 }
 
 Sloth_Function void
@@ -2402,46 +4768,123 @@ Sloth_Function Sloth_Widget*
 sloth_widget_pool_take(Sloth_Ctx* sloth)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_Widget* result = 0;
-  if (!sloth->widgets.free_list)
-  {
-    sloth_widget_pool_grow(&sloth->widgets);
-    result = sloth->widgets.values + sloth->widgets.len++;
-  }
-  else
-  {
-    result = sloth->widgets.free_list;
-    sloth->widgets.free_list = result->sibling_next;
-  }
+  // index 0 is reserved to mean 'no widget'
+  if (sloth->widgets.len == 0) sloth->widgets.len = 1;
+  sloth_widget_pool_grow(&sloth->widgets);
+  Sloth_U32 index = sloth->widgets.len++;
+  Sloth_Widget* result = sloth->widgets.values + index;
   sloth_zero_struct_(result);
+  sloth_zero_struct_(&sloth->widgets.inputs[index]);
+  sloth_zero_struct_(&sloth->widgets.texts[index]);
   return result;
 }
 
-Sloth_Function void          
-sloth_widget_pool_give(Sloth_Ctx* sloth, Sloth_Widget* widget)
-{
-  SLOTH_PROFILE_BEGIN;
-  Sloth_Widget* child = widget->child_first; 
-  while (child) {
-    Sloth_Widget* next = child->sibling_next;
-    sloth_widget_pool_give(sloth, child);
-    child = next;
-  }
-  
-  widget->id.value = 0;
-  widget->sibling_next = 0;
-  widget->sibling_next = sloth->widgets.free_list;
-  sloth->widgets.free_list = widget;
-}
-
 Sloth_Function void
 sloth_widget_pool_free(Sloth_Widget_Pool* pool)
 {
   SLOTH_PROFILE_BEGIN;
   sloth_free((void*)pool->values, sizeof(Sloth_Widget) * pool->cap);
+  sloth_free((void*)pool->inputs, sizeof(Sloth_Widget_Input) * pool->cap);
+  sloth_free((void*)pool->texts,  sizeof(Sloth_Widget_Text)  * pool->cap);
   sloth_zero_struct_(pool);
 }
 
+Sloth_Function Sloth_Widget*
+sloth_widget_get(Sloth_Ctx* sloth, Sloth_U32 index)
+{
+  if (index == 0) return 0;
+  sloth_assert(index < sloth->widgets.len);
+  return sloth->widgets.values + index;
+}
+
+Sloth_Function Sloth_U32
+sloth_widget_index(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  if (widget == 0) return 0;
+  sloth_assert(widget > sloth->widgets.values && widget < sloth->widgets.values + sloth->widgets.len);
+  return (Sloth_U32)(widget - sloth->widgets.values);
+}
+
+Sloth_Function Sloth_Widget*
+sloth_widget_parent(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  return sloth_widget_get(sloth, widget->parent);
+}
+
+Sloth_Function Sloth_Widget*
+sloth_widget_child_first(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  // NOTE: subtree_size isn't known until a widget is popped, but
+  // while it is open, anything after it in the pool is its child
+  Sloth_U32 index = sloth_widget_index(sloth, widget);
+  Sloth_U32 child = index + 1;
+  if (widget->subtree_size > 0) {
+    if (widget->subtree_size == 1) child = 0;
+  } else if (child >= sloth->widgets.len) {
+    child = 0;
+  }
+  return sloth_widget_get(sloth, child);
+}
+
+Sloth_Function Sloth_Widget*
+sloth_widget_sibling_next(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  return sloth_widget_get(sloth, widget->sibling_next);
+}
+
+Sloth_Function Sloth_Widget*
+sloth_widget_sibling_prev(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  // The widget right before this one is either its parent, or 
+  // somewhere in its previous sibling's subtree. Walking up from 
+  // there to the parent's child is cheap, since, over a whole 
+  // walk, each widget is only ever stepped through once
+  Sloth_U32 at = sloth_widget_index(sloth, widget) - 1;
+  if (at == widget->parent) return 0;
+  while (sloth->widgets.values[at].parent != widget->parent)
+  {
+    at = sloth->widgets.values[at].parent;
+  }
+  return sloth_widget_get(sloth, at);
+}
+
+Sloth_Function Sloth_Widget_Input*
+sloth_widget_input(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  return sloth->widgets.inputs + sloth_widget_index(sloth, widget);
+}
+
+Sloth_Function Sloth_Widget_Text*
+sloth_widget_text(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  return sloth->widgets.texts + sloth_widget_index(sloth, widget);
+}
+
+// The text widget's id had last frame, whether or not it has 
+// been laid out yet this frame. Empty if the id wasn't pushed
+// last frame
+Sloth_Function Sloth_Widget_Text*
+sloth_widget_text_last_frame(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  Sloth_Widget_Cached* cached = widget->cached;
+  if (cached->text_last_frame_index + 1 != sloth->frame_index) {
+    sloth_zero_struct_(&cached->text_last_frame);
+  }
+  return &cached->text_last_frame;
+}
+
+Sloth_Function Sloth_Arena*
+sloth_frame_arena(Sloth_Ctx* sloth)
+{
+  return sloth->per_frame_memory + (sloth->frame_index & 1);
+}
+
+Sloth_Function Sloth_Arena*
+sloth_last_frame_arena(Sloth_Ctx* sloth)
+{
+  return sloth->per_frame_memory + ((sloth->frame_index + 1) & 1);
+}
+
 Sloth_Function void          
 sloth_widget_cached_pool_grow(Sloth_Widget_Cached_Pool* pool)
 {
@@ -2461,6 +4904,14 @@ sloth_widget_cached_pool_grow(Sloth_Widget_Cached_Pool* pool)
     pool->bucket_at_len = 0;
   }
   
+  if (pool->bucket_at >= pool->buckets_cap)
+  {
+    Sloth_U32 old_cap = pool->buckets_cap;
+    pool->buckets = sloth_array_grow(pool->buckets, pool->bucket_at, &pool->buckets_cap, 32, Sloth_Widget_Cached*);
+    sloth_zero_size__(sizeof(Sloth_Widget_Cached*) * (pool->buckets_cap - old_cap), (Sloth_U8*)(pool->buckets + old_cap));
+  }
+  sloth_assert(pool->bucket_at < pool->buckets_cap);
+  
   if (pool->buckets[pool->bucket_at] == 0) {
     Sloth_Widget_Cached** at = pool->buckets + pool->bucket_at;
     *at = sloth_realloc_array(*at, Sloth_Widget_Cached, 0, pool->bucket_cap);
@@ -2488,18 +4939,74 @@ sloth_widget_cached_pool_take(Sloth_Ctx* sloth)
   return result;
 }
 
+Sloth_Function void
+sloth_long_text_index_free_(Sloth_Widget_Cached* cached)
+{
+  Sloth_Long_Text_Index* index = cached->long_text;
+  if (!index) return;
+  index->line_starts = sloth_realloc_array(index->line_starts, Sloth_U32, index->line_starts_cap, 0);
+  cached->long_text = sloth_realloc_array(index, Sloth_Long_Text_Index, 1, 0);
+}
+
 Sloth_Function void          
 sloth_widget_cached_pool_give(Sloth_Ctx* sloth, Sloth_Widget_Cached* widget)
 {
   SLOTH_PROFILE_BEGIN;
+  widget->text_layout_glyphs = sloth_realloc_array(widget->text_layout_glyphs, Sloth_Glyph_Layout, widget->text_layout_cap, 0);
+  widget->text_layout_lines = sloth_realloc_array(widget->text_layout_lines, Sloth_Text_Line, widget->text_layout_lines_cap, 0);
+  widget->text_layout_cap = 0;
+  widget->text_layout_lines_cap = 0;
+  sloth_long_text_index_free_(widget);
+  widget->id.value = 0;
   widget->free_next = sloth->widget_caches.free_list;
   sloth->widget_caches.free_list = widget;
 }
 
+// Frees the caches of ids that haven't been used in the last 
+// max_age frames. Rather than visiting every cache each frame, 
+// each call visits the next slice of the pool, sized so that the
+// whole pool is swept every max_age frames. So a cache is freed 
+// somewhere between max_age and 2 * max_age frames after it was 
+// last used.
+// Returns the number of caches freed
+Sloth_Function Sloth_U32
+sloth_widget_cached_pool_evict(Sloth_Ctx* sloth, Sloth_U32 max_age)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Widget_Cached_Pool* p = &sloth->widget_caches;
+  Sloth_U32 len = (p->bucket_at * p->bucket_cap) + p->bucket_at_len;
+  if (len == 0 || max_age == 0) return 0;
+  
+  Sloth_U32 slice = (len / max_age) + 1;
+  Sloth_U32 evicted = 0;
+  for (Sloth_U32 i = 0; i < slice; i++)
+  {
+    if (p->sweep_at >= len) p->sweep_at = 0;
+    Sloth_Widget_Cached* c = p->buckets[p->sweep_at / p->bucket_cap] + (p->sweep_at % p->bucket_cap);
+    p->sweep_at += 1;
+    
+    if (c->id.value == 0) continue;
+    if (sloth->frame_index - c->last_used <= max_age) continue;
+    
+    sloth_hashtable_rem(&sloth->widget_cache_lut, c->id.value);
+    sloth_widget_cached_pool_give(sloth, c);
+    evicted += 1;
+  }
+  return evicted;
+}
+
 Sloth_Function void
 sloth_widget_cached_pool_free(Sloth_Widget_Cached_Pool* pool)
 {
   SLOTH_PROFILE_BEGIN;
+  Sloth_U32 len = (pool->bucket_at * pool->bucket_cap) + pool->bucket_at_len;
+  for (Sloth_U32 i = 0; i < len; i++)
+  {
+    Sloth_Widget_Cached* c = pool->buckets[i / pool->bucket_cap] + (i % pool->bucket_cap);
+    c->text_layout_glyphs = sloth_realloc_array(c->text_layout_glyphs, Sloth_Glyph_Layout, c->text_layout_cap, 0);
+    c->text_layout_lines = sloth_realloc_array(c->text_layout_lines, Sloth_Text_Line, c->text_layout_lines_cap, 0);
+    sloth_long_text_index_free_(c);
+  }
   for (Sloth_U32 i = 0; i < pool->buckets_cap; i++) 
   {
     sloth_free((void*)pool->buckets[i], sizeof(Sloth_Widget_Cached) * pool->bucket_cap);    
@@ -2509,30 +5016,41 @@ sloth_widget_cached_pool_free(Sloth_Widget_Cached_Pool* pool)
 }
 
 #ifdef DEBUG
-#  define sloth_validate_widget_(w) sloth_validate_widget__(w)
+#  define sloth_validate_widget_(sloth,w) sloth_validate_widget__(sloth,w)
 #else
-#  define sloth_validate_widget_(w)
+#  define sloth_validate_widget_(sloth,w)
 #endif
 
 Sloth_Function void
-sloth_validate_widget__(Sloth_Widget* w)
+sloth_validate_widget__(Sloth_Ctx* sloth, Sloth_Widget* w)
 {
   sloth_assert(w->cached);
   sloth_assert(w->cached->canary_start_ == 0 && w->cached->canary_end_ == 0);
   
-  // Look for cycles in w->siblings
-  for (Sloth_Widget* s = w->sibling_prev; s != 0; s = s->sibling_prev)
+  // w's subtree must lie entirely within its parent's subtree, and
+  // its children must directly follow it
+  Sloth_U32 index = sloth_widget_index(sloth, w);
+  sloth_assert(w->subtree_size > 0);
+  sloth_assert(index + w->subtree_size <= sloth->widgets.len);
+#ifdef DEBUG
+  if (w->parent) 
   {
-    sloth_assert(s != w);
+    Sloth_Widget* parent = sloth_widget_get(sloth, w->parent);
+    sloth_assert(w->parent < index);
+    sloth_assert(parent->subtree_size == 0 || w->parent + parent->subtree_size >= index + w->subtree_size);
   }
+#endif
   
-  // Look for cycles in w->children
-  for (Sloth_Widget* c = w->child_first; c != 0; c = c->child_first) 
+  Sloth_U32 child_at = index + 1;
+  while (child_at < index + w->subtree_size)
   {
-    sloth_assert(c != w);
-    sloth_validate_widget__(c);
+    Sloth_Widget* c = sloth_widget_get(sloth, child_at);
+    sloth_assert(c->parent == index);
+    sloth_assert(c->subtree_size > 0);
+    sloth_assert(c->sibling_next == 0 || c->sibling_next == child_at + c->subtree_size);
+    child_at += c->subtree_size;
   }
-  
+  sloth_assert(child_at == index + w->subtree_size);
 }
 
 Sloth_Function Sloth_Widget_Cached*
@@ -2543,9 +5061,11 @@ sloth_get_cached_data_for_id(Sloth_Ctx* sloth, Sloth_ID id)
   result = (Sloth_Widget_Cached*)sloth_hashtable_get(&sloth->widget_cache_lut, id.value);
   if (!result) {
     result = sloth_widget_cached_pool_take(sloth);
+    result->id = id;
     sloth_hashtable_add(&sloth->widget_cache_lut, id.value, (Sloth_U8*)result);
   } 
   sloth_assert(result != 0);  
+  result->last_used = sloth->frame_index;
   return result;
 }
 
@@ -2554,31 +5074,24 @@ sloth_push_widget_on_tree(Sloth_Ctx* sloth, Sloth_ID id)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_Widget* widget = sloth_widget_pool_take(sloth);
+  Sloth_U32 index = sloth_widget_index(sloth, widget);
   if (sloth->widget_tree_parent_cur) {
-    Sloth_Widget* parent = sloth->widget_tree_parent_cur;
-    if (parent->child_last)
+    if (sloth->widget_tree_child_last)
     {
-      widget->sibling_prev = parent->child_last;
-      sloth_assert(widget->sibling_prev != widget->sibling_next);
-      parent->child_last->sibling_next = widget;
-      sloth_assert(parent->child_last->sibling_next != parent->child_last);
-      parent->child_last = widget;
+      Sloth_Widget* sibling_prev = sloth_widget_get(sloth, sloth->widget_tree_child_last);
+      sloth_assert(sibling_prev->parent == sloth->widget_tree_parent_cur);
+      sibling_prev->sibling_next = index;
     }
-    else
-    {
-      parent->child_first = widget;
-      parent->child_last = widget;
-      widget->sibling_prev = 0;
-    }
-    widget->parent = parent;
+    widget->parent = sloth->widget_tree_parent_cur;
   }
   else
   {
-    sloth->widget_tree_root = widget;
+    sloth_assert(sloth->widget_tree_root == 0);
+    sloth->widget_tree_root = index;
   }
   
-  sloth->widget_tree_parent_cur = widget;
-  sloth->widget_tree_next_child = widget->child_first;
+  sloth->widget_tree_parent_cur = index;
+  sloth->widget_tree_child_last = 0;
   sloth->widget_tree_depth_cur += 1;
   if (sloth->widget_tree_depth_cur > sloth->widget_tree_depth_max) {
     sloth->widget_tree_depth_max = sloth->widget_tree_depth_cur;
@@ -2593,203 +5106,106 @@ Sloth_Function Sloth_Widget*
 sloth_pop_widget_off_tree(Sloth_Ctx* sloth)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_Widget* parent_cur = sloth->widget_tree_parent_cur;
+  Sloth_U32 index = sloth->widget_tree_parent_cur;
+  Sloth_Widget* parent_cur = sloth_widget_get(sloth, index);
+  sloth_assert(parent_cur);
   
-  if (parent_cur != sloth->widget_tree_root) {
-    // parent_cur is either the root or its parent has a valid
-    // SLL of children
-    sloth_assert((parent_cur->parent != 0 && parent_cur->parent->child_first != 0));
-    
-    // parent_cur either must have a previous sibling, or
-    // it's parent must think this is the first child
-    // not both.
-    sloth_assert((Sloth_Bool)(parent_cur->sibling_prev != 0) != (Sloth_Bool)(parent_cur->parent->child_first == parent_cur));
-  }
-  
-  // if there's an expected next child, that means last
-  // frame this widget had more children than it does now
-  if (sloth->widget_tree_next_child) {
-    if (parent_cur->child_last) {
-      Sloth_Widget* last_widget = parent_cur->child_last;
-      last_widget->sibling_next = 0;
-    } else {
-      parent_cur->child_first = 0;
-    }
-    Sloth_Widget* at = sloth->widget_tree_next_child;
-    while (at != 0) {
-      Sloth_Widget* next_at = at->sibling_next;
-      sloth_widget_pool_give(sloth, sloth->widget_tree_next_child);
-      at = next_at;
-    }
-  }
+  // everything pushed since parent_cur is a descendant of it
+  parent_cur->subtree_size = sloth->widgets.len - index;
   
-  if (sloth->widget_tree_parent_cur != sloth->widget_tree_root)
+  if (index != sloth->widget_tree_root)
   {
     sloth->widget_tree_parent_cur = parent_cur->parent;
-    sloth->widget_tree_next_child = parent_cur->sibling_next;
+    sloth->widget_tree_child_last = index;
     sloth->widget_tree_depth_cur -= 1;
   }
-  else
-  {
-    // we're at the root
-    sloth->widget_tree_next_child = 0;
-  }
+  // else, we're at the root, which stays open until frame_advance
   
   sloth_assert(sloth->widget_tree_parent_cur);
-  sloth_validate_widget_(parent_cur);
+  sloth_validate_widget_(sloth, parent_cur);
   return parent_cur;
 }
 
-// Order: Left Root Right
-Sloth_Function void 
-sloth_tree_walk_inorder_(Sloth_Ctx* sloth, Sloth_Widget* start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
-{
-  SLOTH_PROFILE_BEGIN;
-  if (sloth->widgets.len == 0) return;
-  
-  Sloth_Arena_Loc scratch_at = sloth_arena_at(&sloth->scratch);
-  Sloth_Widget** stack = sloth_arena_push_array(&sloth->scratch, Sloth_Widget*, sloth->widgets.len);
-  Sloth_U32     stack_len = 0;
-  
-  Sloth_Widget* at = start;
-  Sloth_Tree_Walk_Result last_result = Sloth_TreeWalk_Continue;
-  while (last_result != Sloth_TreeWalk_Stop)
-  {
-    if (at != 0) 
-    {
-      stack[stack_len++] = at; // push
-      at = at->child_first;
-    }
-    else if (stack_len > 0)
-    {
-      at = stack[--stack_len]; // pop
-      last_result = cb(sloth, at, user_data);
-      sloth_assert(last_result == Sloth_TreeWalk_Continue ||
-          last_result == Sloth_TreeWalk_Stop);
-      
-      at = at->sibling_next;
-    }
-    else
-    {
-      break;
-    }
-  }
-  
-  sloth_arena_pop(&sloth->scratch, scratch_at);
-}
-
 // Order: root, children, siblings
+// Since widgets are stored in preorder, this is just a linear
+// scan over start's subtree
 Sloth_Function void 
-sloth_tree_walk_preorder_(Sloth_Ctx* sloth, Sloth_Widget* start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
+sloth_tree_walk_preorder_(Sloth_Ctx* sloth, Sloth_U32 start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  if (sloth->widgets.len == 0) return;
-  
-  Sloth_Arena_Loc scratch_at = sloth_arena_at(&sloth->scratch);
-  Sloth_Widget** stack = sloth_arena_push_array(&sloth->scratch, Sloth_Widget*, sloth->widgets.len);
-  Sloth_U32     stack_len = 0;
-  
-  Sloth_Widget* at = start;
-  stack[stack_len++] = at;
+  if (start == 0) return;
   
-  Sloth_Tree_Walk_Result last_result = Sloth_TreeWalk_Continue;
-  while (stack_len > 0 && last_result != Sloth_TreeWalk_Stop)
+  Sloth_U32 end = start + sloth->widgets.values[start].subtree_size;
+  Sloth_U32 at = start;
+  while (at < end)
   {
-    at = stack[--stack_len]; // pop
-    if (at != 0) // if the requested node exists
+    Sloth_Widget* widget = sloth->widgets.values + at;
+    Sloth_Tree_Walk_Result result = cb(sloth, widget, user_data); // visit
+    switch (result)
     {
-      if (last_result == Sloth_TreeWalk_Continue)
-      {
-        last_result = cb(sloth, at, user_data); // visit
-      }
-      stack[stack_len++] = at->sibling_next; // right node
+      case Sloth_TreeWalk_Continue: {
+        at += 1;
+      } break;
       
-      switch (last_result)
-      {
-        case Sloth_TreeWalk_Continue: {
-          stack[stack_len++] = at->child_first; // left node
-        } break;
-        
-        case Sloth_TreeWalk_Continue_SkipChildren: {
-          last_result = Sloth_TreeWalk_Continue;
-        } break;
-        
-        // acceptable values but no action requried here
-        case Sloth_TreeWalk_Stop:
-        
-        sloth_invalid_default_case;
-      }
+      case Sloth_TreeWalk_Continue_SkipChildren: {
+        at += widget->subtree_size;
+      } break;
+      
+      case Sloth_TreeWalk_Stop: {
+        at = end;
+      } break;
+      
+      sloth_invalid_default_case;
     }
   }
-  
-  sloth_arena_pop(&sloth->scratch, scratch_at);
 }
 
-typedef struct Sloth_Postorder_Widget Sloth_Postorder_Widget;
-struct Sloth_Postorder_Widget
-{
-  Sloth_Widget* widget;
-  Sloth_U8 is_right_child;
-};
-
 // Order: children, siblings, root
 // NOTE: I believe this is a bit of a modification on 
 // postorder traversal, since we still want children
 // to be visited from left to right. 
+// This scans start's subtree in preorder, keeping a stack of 
+// the widgets whose subtrees haven't been fully scanned yet.
+// Each widget is visited as soon as the scan leaves its subtree.
 Sloth_Function void 
-sloth_tree_walk_postorder_(Sloth_Ctx* sloth, Sloth_Widget* start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
+sloth_tree_walk_postorder_(Sloth_Ctx* sloth, Sloth_U32 start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  if (sloth->widgets.len == 0) return;
+  if (start == 0) return;
   
   Sloth_Arena_Loc scratch_at = sloth_arena_at(&sloth->scratch);
-  Sloth_Postorder_Widget* stack = sloth_arena_push_array(&sloth->scratch, Sloth_Postorder_Widget, sloth->widgets.len);
-  Sloth_U32     stack_len = 0;
-  
-  Sloth_Widget* at = start;
-  Sloth_Tree_Walk_Result last_result = Sloth_TreeWalk_Continue;
-  do {
-    while (at != 0) // while at exists
-    {
-      if (at->sibling_next != 0) // if right exists
-      {
-        Sloth_U32 index_r = stack_len++; // push right
-        stack[index_r].widget = at->sibling_next; // push right
-        stack[index_r].is_right_child = true;
-      }
-      // push
-      Sloth_U32 index_l = stack_len++;
-      stack[index_l].widget = at; 
-      stack[index_l].is_right_child = false;
-      
-      at = at->child_first; // go to left
-    }
-    
-    Sloth_Postorder_Widget* wat = &stack[--stack_len];
-    at = wat->widget;
-    while (at != 0 && !wat->is_right_child) // while at exists and is not the right child of a node
-    {
-      last_result = cb(sloth, at, user_data); // visit
-      if (last_result == Sloth_TreeWalk_Stop) break;
-      
-      if (stack_len == 0) {
-        wat = 0;
-        break;
-      }
-      wat = &stack[--stack_len];
-      at = wat->widget;
-    }
-    
-    if (wat && wat->is_right_child) 
+  Sloth_U32* stack = sloth_arena_push_array(&sloth->scratch, Sloth_U32, sloth->widgets.len);
+  Sloth_U32  stack_len = 0;
+  
+  Sloth_U32 end = start + sloth->widgets.values[start].subtree_size;
+  Sloth_Tree_Walk_Result last_result = Sloth_TreeWalk_Continue;
+  for (Sloth_U32 at = start; at <= end && last_result != Sloth_TreeWalk_Stop; at++)
+  {
+    while (stack_len > 0 && last_result != Sloth_TreeWalk_Stop)
     {
-      wat->is_right_child = false;
-      at = wat->widget;
+      Sloth_U32 top = stack[stack_len - 1];
+      Sloth_Widget* widget = sloth->widgets.values + top;
+      if (top + widget->subtree_size > at) break; // at is still in top's subtree
+      
+      stack_len -= 1;
+      last_result = cb(sloth, widget, user_data); // visit
     }
-  } while (stack_len > 0 && last_result != Sloth_TreeWalk_Stop);
+    if (at < end) stack[stack_len++] = at; // push
+  }
   
   sloth_arena_pop(&sloth->scratch, scratch_at);
 }
 
+// Order: Left Root Right
+// NOTE: treating child_first as the left node and sibling_next 
+// as the right node, this is the same order as the postorder walk
+Sloth_Function void 
+sloth_tree_walk_inorder_(Sloth_Ctx* sloth, Sloth_U32 start, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_tree_walk_postorder_(sloth, start, cb, user_data);
+}
+
 Sloth_Function void 
 sloth_tree_walk_inorder(Sloth_Ctx* sloth, Sloth_Tree_Walk_Cb* cb, Sloth_U8* user_data)
 {
@@ -2833,13 +5249,13 @@ sloth_widget_validate_layout__(Sloth_Widget_Layout layout)
 Sloth_Function void
 sloth_widget_handle_input_drag(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Widget_Result* result)
 {  
-  if (!sloth_flags_has(widget->input.flags, Sloth_WidgetInput_Draggable)) return;
+  if (!sloth_flags_has(sloth_widget_input(sloth, widget)->flags, Sloth_WidgetInput_Draggable)) return;
   result->drag_offset_pixels.x = sloth->mouse_pos.x - sloth->mouse_down_pos.x;
   result->drag_offset_pixels.y = sloth->mouse_pos.y - sloth->mouse_down_pos.y;
   
-  Sloth_Widget* parent = widget->parent;
+  Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
   if (parent) {
-    Sloth_Widget_Cached parent_cached = *widget->parent->cached;
+    Sloth_Widget_Cached parent_cached = *parent->cached;
     result->drag_offset_percent_parent.x = result->drag_offset_pixels.x / parent_cached.dim.x;
     result->drag_offset_percent_parent.y = result->drag_offset_pixels.y / parent_cached.dim.y;
   }
@@ -2851,8 +5267,9 @@ sloth_widget_handle_input(Sloth_Ctx* sloth, Sloth_Widget* widget)
   SLOTH_PROFILE_BEGIN;
   Sloth_Widget_Result result = SLOTH_ZII;
   result.widget = widget;
+  result.widget_index = sloth_widget_index(sloth, widget);
   
-  Sloth_Widget_Input input = widget->input;
+  Sloth_Widget_Input input = *sloth_widget_input(sloth, widget);
   Sloth_Widget_Cached cached = *widget->cached;
   if (sloth_ids_equal(sloth->active_widget, widget->id)) 
   {
@@ -2901,13 +5318,164 @@ sloth_widget_style_apply_defaults(Sloth_Ctx* sloth, Sloth_Widget_Style style)
   return style;
 }
 
+Sloth_Function Sloth_Widget_Style
+sloth_widget_style_resolve_inherited(Sloth_Widget_Style style, Sloth_Widget_Style* parent)
+{
+  Sloth_Widget_Style zero = SLOTH_ZII;
+  if (!parent) parent = &zero;
+  Sloth_Style_Inherit_Flags f = style.inherit;
+  if (sloth_flags_has(f, Sloth_StyleInherit_DrawFlags))        style.draw_flags = parent->draw_flags;
+  if (sloth_flags_has(f, Sloth_StyleInherit_ColorBg))          style.color_bg = parent->color_bg;
+  if (sloth_flags_has(f, Sloth_StyleInherit_ColorText))        style.color_text = parent->color_text;
+  if (sloth_flags_has(f, Sloth_StyleInherit_ColorOutline))     style.color_outline = parent->color_outline;
+  if (sloth_flags_has(f, Sloth_StyleInherit_BgGlyph))          style.bg_glyph = parent->bg_glyph;
+  if (sloth_flags_has(f, Sloth_StyleInherit_OutlineThickness)) style.outline_thickness = parent->outline_thickness;
+  if (sloth_flags_has(f, Sloth_StyleInherit_TextStyle))        style.text_style = parent->text_style;
+  if (sloth_flags_has(f, Sloth_StyleInherit_Font))             style.font = parent->font;
+  if (sloth_flags_has(f, Sloth_StyleInherit_BorderRadius))
+  {
+    for (Sloth_U32 i = 0; i < 4; i++) style.border_radius[i] = parent->border_radius[i];
+  }
+  style.inherit = 0;
+  return style;
+}
+
+// NOTE: descriptors are hashed and compared a word at a time, so 
+// the padding between their fields has to be zeroed, or identical
+// descriptors wouldn't share a record. These copy field by field
+// into a zeroed record
+Sloth_Function void
+sloth_size_canonicalize_(Sloth_Size* dst, Sloth_Size src)
+{
+  dst->value = src.value;
+  dst->kind = src.kind;
+}
+
+Sloth_Function void
+sloth_widget_layout_canonicalize_(Sloth_Widget_Layout* dst, Sloth_Widget_Layout* src)
+{
+  sloth_zero_struct_(dst);
+  for (Sloth_U32 axis = 0; axis < 2; axis++)
+  {
+    sloth_size_canonicalize_(&dst->size[axis], src->size[axis]);
+    for (Sloth_U32 i = 0; i < 2; i++)
+    {
+      sloth_size_canonicalize_(&dst->margin.E[axis].E[i], src->margin.E[axis].E[i]);
+      sloth_size_canonicalize_(&dst->position.at.E[axis].E[i], src->position.at.E[axis].E[i]);
+    }
+  }
+  dst->direction = src->direction;
+  dst->position.kind = src->position.kind;
+  dst->position.z = src->position.z;
+}
+
+Sloth_Function void
+sloth_widget_style_canonicalize_(Sloth_Widget_Style* dst, Sloth_Widget_Style* src)
+{
+  sloth_zero_struct_(dst);
+  dst->draw_flags = src->draw_flags;
+  dst->color_bg = src->color_bg;
+  dst->color_text = src->color_text;
+  dst->color_outline = src->color_outline;
+  dst->bg_glyph.value = src->bg_glyph.value;
+  dst->outline_thickness = src->outline_thickness;
+  for (Sloth_U32 i = 0; i < 4; i++)
+  {
+    sloth_size_canonicalize_(&dst->border_radius[i], src->border_radius[i]);
+  }
+  dst->text_style = src->text_style;
+  dst->font.value = src->font.value;
+  dst->font.weight_index = src->font.weight_index;
+  dst->inherit = src->inherit;
+}
+
+// reuse is a handle this layout was interned as before. If it
+// still holds the same layout, it's returned without a lookup
+Sloth_Function Sloth_U32
+sloth_layout_intern_(Sloth_Ctx* sloth, Sloth_Widget_Layout layout, Sloth_U32 reuse)
+{
+  layout = sloth_widget_layout_apply_defaults(sloth, layout);
+  Sloth_Widget_Layout record;
+  sloth_widget_layout_canonicalize_(&record, &layout);
+  if (sloth_desc_table_matches_(&sloth->layouts, reuse, (Sloth_U8*)&record, sizeof(record)))
+  {
+    sloth_desc_table_touch(&sloth->layouts, reuse, sloth->frame_index);
+    return reuse;
+  }
+  return sloth_desc_table_intern(&sloth->layouts, (Sloth_U8*)&record, sizeof(record), sloth->frame_index);
+}
+
+Sloth_Function Sloth_U32
+sloth_style_intern_(Sloth_Ctx* sloth, Sloth_Widget_Style style, Sloth_U32 parent_style)
+{
+  if (style.inherit) 
+  {
+    Sloth_Widget_Style* parent = 0;
+    if (parent_style) parent = (Sloth_Widget_Style*)sloth_desc_table_get(&sloth->styles, parent_style);
+    style = sloth_widget_style_resolve_inherited(style, parent);
+  }
+  style = sloth_widget_style_apply_defaults(sloth, style);
+  Sloth_Widget_Style record;
+  sloth_widget_style_canonicalize_(&record, &style);
+  return sloth_desc_table_intern(&sloth->styles, (Sloth_U8*)&record, sizeof(record), sloth->frame_index);
+}
+
+Sloth_Function Sloth_U32
+sloth_layout_register(Sloth_Ctx* sloth, Sloth_Widget_Layout layout)
+{
+  Sloth_U32 result = sloth_layout_intern_(sloth, layout, 0);
+  sloth->layouts.last_used[result] = SLOTH_DESC_PINNED;
+  return result;
+}
+
+Sloth_Function Sloth_U32
+sloth_style_register(Sloth_Ctx* sloth, Sloth_Widget_Style style, Sloth_U32 parent_style)
+{
+  Sloth_U32 result = sloth_style_intern_(sloth, style, parent_style);
+  sloth->styles.last_used[result] = SLOTH_DESC_PINNED;
+  return result;
+}
+
+Sloth_Function Sloth_Widget_Layout*
+sloth_widget_layout(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  return (Sloth_Widget_Layout*)sloth_desc_table_get(&sloth->layouts, widget->layout_handle);
+}
+
+Sloth_Function Sloth_Widget_Style*
+sloth_widget_style(Sloth_Ctx* sloth, Sloth_Widget* widget)
+{
+  return (Sloth_Widget_Style*)sloth_desc_table_get(&sloth->styles, widget->style_handle);
+}
+
+Sloth_Function void
+sloth_widget_layout_set(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Widget_Layout layout)
+{
+  widget->layout_handle = sloth_layout_intern_(sloth, layout, widget->cached->layout_handle);
+  widget->cached->layout_handle = widget->layout_handle;
+}
+
+Sloth_Function void
+sloth_widget_style_set(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Widget_Style style)
+{
+  Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
+  widget->style_handle = sloth_style_intern_(sloth, style, parent ? parent->style_handle : 0);
+}
+
+// Makes room for glyphs_count glyphs. Text appended with 
+// sloth_widget_text_to_glyphs_append needs 
+// sloth_utf8_glyph_count(text, text_len) of them
 Sloth_Function void
-sloth_widget_allocate_text(Sloth_Ctx* sloth, Sloth_Widget_Result widget_result, Sloth_U32 text_len)
+sloth_widget_allocate_text(Sloth_Ctx* sloth, Sloth_Widget_Result widget_result, Sloth_U32 glyphs_count)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_Widget* widget = widget_result.widget;
-  widget->text = sloth_arena_push_array(&sloth->per_frame_memory, Sloth_Glyph_Layout, text_len + 1);
-  widget->text_cap = text_len;
+  Sloth_Widget_Text* text = sloth_widget_text(sloth, widget_result.widget);
+  text->glyphs = sloth_arena_push_array(sloth_frame_arena(sloth), Sloth_Glyph_Layout, glyphs_count + 1);
+  text->glyphs_cap = glyphs_count;
+  
+  // the frame arenas are only zeroed on clear in DEBUG builds, and
+  // glyph layout flags are only ever added to
+  sloth_zero_size__(sizeof(Sloth_Glyph_Layout) * (glyphs_count + 1), (Sloth_U8*)text->glyphs);
 }
 
 Sloth_Function void
@@ -2915,34 +5483,44 @@ sloth_widget_text_to_glyphs_append(Sloth_Ctx* sloth, Sloth_Widget_Result widget_
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_Widget* widget = widget_result.widget;
+  Sloth_Widget_Text* widget_text = sloth_widget_text(sloth, widget);
   
   Sloth_U32 text_family = 0;
   if (sloth->fonts) {
     text_family = sloth->fonts[font.value].weights[font.weight_index].glyph_family;
   }
   
-  Sloth_Bool show_selected = sloth_flags_has(widget->input.flags, Sloth_WidgetInput_TextSelectable);
+  Sloth_Bool show_selected = sloth_flags_has(sloth_widget_input(sloth, widget)->flags, Sloth_WidgetInput_TextSelectable);
   show_selected &= sloth_ids_equal(sloth->last_active_widget, widget->id);
   
-  sloth_assert(widget->text_len + text_len <= widget->text_cap);
-  for (Sloth_U32 char_i = 0; char_i < text_len; char_i++)
+  Sloth_U32 char_i = 0;
+  Sloth_U32 ascii_end = 0;
+  while (char_i < text_len)
   {
-    Sloth_U32 glyph_i = widget->text_len++;
+    if (char_i >= ascii_end) ascii_end = char_i + sloth_utf8_ascii_run_(text + char_i, text_len - char_i);
+    Sloth_U32 char_code = 0;
+    if (char_i < ascii_end) {
+      char_code = (Sloth_U8)text[char_i++];
+    } else {
+      char_code = sloth_utf8_decode(text, text_len, &char_i);
+    }
     
-    Sloth_U32 char_code = (Sloth_U32)text[char_i];
+    sloth_assert(widget_text->glyphs_len < widget_text->glyphs_cap);
+    Sloth_U32 glyph_i = widget_text->glyphs_len++;
     Sloth_Glyph_ID g = sloth_make_glyph_id(text_family, char_code);
     
     Sloth_Bool after_first = glyph_i >= widget_result.selected_glyphs_first;
     Sloth_Bool before_last = glyph_i < widget_result.selected_glyphs_one_past_last;
     Sloth_Bool is_selected = (show_selected && after_first && before_last);
     if (is_selected) {
-      sloth_flags_add(widget->text[glyph_i].flags, Sloth_GlyphLayout_Selected);
+      sloth_flags_add(widget_text->glyphs[glyph_i].flags, Sloth_GlyphLayout_Selected);
     }
-    widget->text[glyph_i].glyph_id = g;
+    widget_text->glyphs[glyph_i].glyph_id = g;
+    widget_text->hash = (widget_text->hash ^ g.value) * 0x01000193; // FNV prime
     
     if (!sloth_glyph_store_contains(&sloth->glyph_store, g))
     {
-      sloth_font_register_codepoint(sloth, font, char_code);
+      sloth_font_request_codepoint(sloth, font, char_code);
     }
   }
 }
@@ -2952,10 +5530,21 @@ sloth_push_widget_id(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, Sloth_ID id)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_Widget* widget = sloth_push_widget_on_tree(sloth, id);
-  sloth_assert(widget->parent || widget == sloth->widget_tree_root);
-  widget->layout = sloth_widget_layout_apply_defaults(sloth, desc.layout);
-  widget->style  = sloth_widget_style_apply_defaults(sloth, desc.style);
-  widget->input  = desc.input;
+  sloth_assert(widget->parent || sloth_widget_index(sloth, widget) == sloth->widget_tree_root);
+  
+  if (desc.layout_handle) {
+    sloth_desc_table_touch(&sloth->layouts, desc.layout_handle, sloth->frame_index);
+    widget->layout_handle = desc.layout_handle;
+  } else {
+    sloth_widget_layout_set(sloth, widget, desc.layout);
+  }
+  if (desc.style_handle) {
+    sloth_desc_table_touch(&sloth->styles, desc.style_handle, sloth->frame_index);
+    widget->style_handle = desc.style_handle;
+  } else {
+    sloth_widget_style_set(sloth, widget, desc.style);
+  }
+  *sloth_widget_input(sloth, widget) = desc.input;
   
   Sloth_Widget_Result result = sloth_widget_handle_input(sloth, widget);
   return result;
@@ -2966,12 +5555,63 @@ sloth_push_widget_v(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* fmt, va_list
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_ID_Result idr = sloth_make_id_v(&sloth->scratch, fmt, args);
-  Sloth_Widget_Result result = sloth_push_widget_id(sloth, desc, idr.id);
-  sloth_widget_allocate_text(sloth, result, idr.display_len);
-  sloth_widget_text_to_glyphs_append(sloth, result, result.widget->style.font, idr.formatted, idr.display_len);
+  Sloth_Widget_Result result = sloth_push_widget_id(sloth, desc, sloth_id_scoped(sloth, idr.id));
+  sloth_widget_allocate_text(sloth, result, sloth_utf8_glyph_count(idr.formatted, idr.display_len));
+  sloth_widget_text_to_glyphs_append(sloth, result, sloth_widget_style(sloth, result.widget)->font, idr.formatted, idr.display_len);
+  return result;
+}
+
+Sloth_Function Sloth_Widget_Result
+sloth_push_widget_id_label(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, Sloth_ID id, char* label)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_U32 label_len = 0;
+  if (label) while (label[label_len] != 0) label_len++;
+  
+  Sloth_Widget_Result result = sloth_push_widget_id(sloth, desc, sloth_id_scoped(sloth, id));
+  sloth_widget_allocate_text(sloth, result, sloth_utf8_glyph_count(label, label_len));
+  sloth_widget_text_to_glyphs_append(sloth, result, sloth_widget_style(sloth, result.widget)->font, label, label_len);
+  return result;
+}
+
+Sloth_Function Sloth_Widget_Result
+sloth_push_widget_long_text(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, Sloth_ID id, Sloth_Char* text, Sloth_U32 text_len)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Widget_Result result = sloth_push_widget_id(sloth, desc, sloth_id_scoped(sloth, id));
+  Sloth_Widget_Text* widget_text = sloth_widget_text(sloth, result.widget);
+  widget_text->long_text = text;
+  widget_text->long_text_len = text ? text_len : 0;
   return result;
 }
 
+Sloth_Function void
+sloth_push_id_scope(Sloth_Ctx* sloth, Sloth_ID seed)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_assert(sloth->id_scopes_len < SLOTH_ID_SCOPES_CAP);
+  if (sloth->id_scopes_len >= SLOTH_ID_SCOPES_CAP) return;
+  sloth->id_scopes[sloth->id_scopes_len] = sloth_id_scoped(sloth, seed);
+  sloth->id_scopes_len += 1;
+}
+
+Sloth_Function void
+sloth_pop_id_scope(Sloth_Ctx* sloth)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_assert(sloth->id_scopes_len > 0);
+  if (sloth->id_scopes_len > 0) sloth->id_scopes_len -= 1;
+}
+
+// Returns id combined with the current id scope, or id itself
+// if no scope is pushed
+Sloth_Function Sloth_ID
+sloth_id_scoped(Sloth_Ctx* sloth, Sloth_ID id)
+{
+  if (sloth->id_scopes_len == 0) return id;
+  return sloth_id_combine(sloth->id_scopes[sloth->id_scopes_len - 1], id);
+}
+
 Sloth_Function Sloth_Widget_Result 
 sloth_push_widget_f(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* fmt, ...)
 {
@@ -3003,7 +5643,7 @@ sloth_pop_widget_safe(Sloth_Ctx* sloth, Sloth_Widget_Result result)
   SLOTH_PROFILE_BEGIN;
   Sloth_Widget* last_widget = sloth_pop_widget_off_tree(sloth);
   sloth_assert(sloth->widget_tree_parent_cur);
-  sloth_assert(last_widget == result.widget);
+  sloth_assert(sloth_widget_index(sloth, last_widget) == result.widget_index);
 }
 
 Sloth_Function Sloth_Widget_Result
@@ -3037,7 +5677,7 @@ struct Sloth_Layout_Cache
 };
 
 Sloth_Function Sloth_R32
-sloth_size_evaluate_margin(Sloth_Widget* widget, Sloth_Size margin_size, Sloth_U8 axis)
+sloth_size_evaluate_margin(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Size margin_size, Sloth_U8 axis)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_R32 result = 0;
@@ -3048,7 +5688,7 @@ sloth_size_evaluate_margin(Sloth_Widget* widget, Sloth_Size margin_size, Sloth_U
     } else {
       Sloth_Rect bounds;
       if (margin_size.kind == Sloth_SizeKind_PercentOfParent) {
-        bounds = widget->parent->cached->bounds;
+        bounds = sloth_widget_parent(sloth, widget)->cached->bounds;
       } else if (margin_size.kind == Sloth_SizeKind_PercentOfSelf) {
         bounds = widget->cached->bounds;
       } else {
@@ -3061,21 +5701,22 @@ sloth_size_evaluate_margin(Sloth_Widget* widget, Sloth_Size margin_size, Sloth_U
 }
 
 Sloth_Function Sloth_R32
-sloth_size_box_evaluate(Sloth_Widget* widget, Sloth_Size_Box margin, Sloth_U8 axis)
+sloth_size_box_evaluate(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Size_Box margin, Sloth_U8 axis)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_R32 result = 0;
-  result += sloth_size_evaluate_margin(widget, margin.E[axis].min, axis);
-  result += sloth_size_evaluate_margin(widget, margin.E[axis].max, axis);
+  result += sloth_size_evaluate_margin(sloth, widget, margin.E[axis].min, axis);
+  result += sloth_size_evaluate_margin(sloth, widget, margin.E[axis].max, axis);
   return result;
 }
 
 Sloth_Function void
-sloth_size_fixup_fixed_size_apply(Sloth_Widget* widget, Sloth_U8 axis)
+sloth_size_fixup_fixed_size_apply(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8 axis)
 {
-  Sloth_R32 margin = sloth_size_evaluate_margin(widget, widget->layout.margin.E[axis].min, axis);
-  margin += sloth_size_evaluate_margin(widget, widget->layout.margin.E[axis].max, axis);
-  widget->cached->dim.E[axis] = widget->text_dim.E[axis] + margin;
+  Sloth_Size_Range margin_range = sloth_widget_layout(sloth, widget)->margin.E[axis];
+  Sloth_R32 margin = sloth_size_evaluate_margin(sloth, widget, margin_range.min, axis);
+  margin += sloth_size_evaluate_margin(sloth, widget, margin_range.max, axis);
+  widget->cached->dim.E[axis] = sloth_widget_text(sloth, widget)->dim.E[axis] + margin;
 }
 
 // @PerAxisTreeWalkCB
@@ -3085,16 +5726,17 @@ sloth_size_fixup_cb_fixed_size(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8*
   SLOTH_PROFILE_BEGIN;
   Sloth_Layout_Cache* lc = (Sloth_Layout_Cache*)user_data;
   Sloth_U8 axis = lc->axis;
+  Sloth_Size size = sloth_widget_layout(sloth, widget)->size[axis];
   
-  switch (widget->layout.size[axis].kind)
+  switch (size.kind)
   {
     case Sloth_SizeKind_Pixels:
     {
-      widget->cached->dim.E[axis] = widget->layout.size[axis].value;
+      widget->cached->dim.E[axis] = size.value;
     } break;
     case Sloth_SizeKind_TextContent:
     {
-      sloth_size_fixup_fixed_size_apply(widget, axis);
+      sloth_size_fixup_fixed_size_apply(sloth, widget, axis);
     } break;
     default: {} break; // do nothing
   }
@@ -3109,31 +5751,33 @@ sloth_size_fixup_cb_percent_parent(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth
   SLOTH_PROFILE_BEGIN;
   Sloth_Layout_Cache* lc = (Sloth_Layout_Cache*)user_data;
   Sloth_U8 axis = lc->axis;
-  switch (widget->layout.size[axis].kind)
+  Sloth_Size size = sloth_widget_layout(sloth, widget)->size[axis];
+  switch (size.kind)
   {
     case Sloth_SizeKind_PercentOfParent:
     {
-      Sloth_Widget* parent = widget->parent;
+      Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
       sloth_assert(parent);
       
       // NOTE: this violation rises from the fact that that
       // this child relies on its parent for size, and the parent
       // relies on its children for size. This will be solved in 
       // the violation fixup step
-      Sloth_Bool unsolved_violation = parent->layout.size[axis].kind == Sloth_SizeKind_ChildrenSum;
+      Sloth_Widget_Layout* parent_layout = sloth_widget_layout(sloth, parent);
+      Sloth_Bool unsolved_violation = parent_layout->size[axis].kind == Sloth_SizeKind_ChildrenSum;
       if (!unsolved_violation)
       {
-        Sloth_R32 parent_margin = sloth_size_box_evaluate(parent, parent->layout.margin, axis);
-        widget->cached->dim.E[axis] = (parent->cached->dim.E[axis] - parent_margin) * widget->layout.size[axis].value;
+        Sloth_R32 parent_margin = sloth_size_box_evaluate(sloth, parent, parent_layout->margin, axis);
+        widget->cached->dim.E[axis] = (parent->cached->dim.E[axis] - parent_margin) * size.value;
       }
     } break;
     
     case Sloth_SizeKind_TextContent:
     {
       if (axis == Sloth_Axis_Y) {
-        sloth_size_fixup_fixed_size_apply(widget, axis);
+        sloth_size_fixup_fixed_size_apply(sloth, widget, axis);
       }
-      sloth_assert(widget->cached->dim.E[axis] >= widget->text_dim.E[axis]);
+      sloth_assert(widget->cached->dim.E[axis] >= sloth_widget_text(sloth, widget)->dim.E[axis]);
     } break;
     default: {} break; // do nothing
   }
@@ -3149,36 +5793,36 @@ sloth_size_fixup_cb_children_sum(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U
   Sloth_Layout_Cache* lc = (Sloth_Layout_Cache*)user_data;
   Sloth_U8 axis = lc->axis;
   
+  Sloth_Widget_Layout* layout = sloth_widget_layout(sloth, widget);
+  
   // Determine relevant margins
-  Sloth_Size_Range margin = widget->layout.margin.E[axis];
-  Sloth_R32 margin_before = sloth_size_evaluate_margin(widget, margin.min, axis);
-  Sloth_R32 margin_after  = sloth_size_evaluate_margin(widget, margin.max, axis);
+  Sloth_Size_Range margin = layout->margin.E[axis];
+  Sloth_R32 margin_before = sloth_size_evaluate_margin(sloth, widget, margin.min, axis);
+  Sloth_R32 margin_after  = sloth_size_evaluate_margin(sloth, widget, margin.max, axis);
   
-  Sloth_Size_Kind kind = widget->layout.size[axis].kind;
+  Sloth_Size_Kind kind = layout->size[axis].kind;
   switch (kind)
   {
     case Sloth_SizeKind_ChildrenSum:
     {
       Sloth_R32 dim = margin_before + margin_after;
       Sloth_R32 max = 0;
-      if (widget->child_first) {
-        // Because no widgets have been laid out yet, we have to iterate
-        // over all its children
-        for (Sloth_Widget* child = widget->child_first; 
-          child != 0; 
-          child = child->sibling_next
-        ){
-          // TODO: Account for any child gap layout properties
-          dim += child->cached->dim.E[axis];
-          max = Sloth_Max(child->cached->dim.E[axis], max);
-        }
+      // Because no widgets have been laid out yet, we have to iterate
+      // over all its children
+      for (Sloth_Widget* child = sloth_widget_child_first(sloth, widget); 
+        child != 0; 
+        child = sloth_widget_sibling_next(sloth, child)
+      ){
+        // TODO: Account for any child gap layout properties
+        dim += child->cached->dim.E[axis];
+        max = Sloth_Max(child->cached->dim.E[axis], max);
       }
       max += margin_before + margin_after;
       
-      Sloth_Bool dir_horizontal = (widget->layout.direction == Sloth_LayoutDirection_LeftToRight ||
-          widget->layout.direction == Sloth_LayoutDirection_RightToLeft);
-      Sloth_Bool dir_vertical   = (widget->layout.direction == Sloth_LayoutDirection_TopDown ||
-          widget->layout.direction == Sloth_LayoutDirection_BottomUp);
+      Sloth_Bool dir_horizontal = (layout->direction == Sloth_LayoutDirection_LeftToRight ||
+          layout->direction == Sloth_LayoutDirection_RightToLeft);
+      Sloth_Bool dir_vertical   = (layout->direction == Sloth_LayoutDirection_TopDown ||
+          layout->direction == Sloth_LayoutDirection_BottomUp);
       if (dir_horizontal)
       {
         if (axis == Sloth_Axis_X) {
@@ -3219,12 +5863,12 @@ sloth_size_fixup_cb_violations(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8*
   SLOTH_PROFILE_BEGIN;
   Sloth_Layout_Cache* lc = (Sloth_Layout_Cache*)user_data;
   Sloth_U8 axis = lc->axis;
-  switch (widget->layout.size[axis].kind)
+  switch (sloth_widget_layout(sloth, widget)->size[axis].kind)
   {
     case Sloth_SizeKind_PercentOfParent:
     {
-      Sloth_Widget* parent = widget->parent;
-      Sloth_Widget_Layout pl = parent->layout;
+      Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
+      Sloth_Widget_Layout pl = *sloth_widget_layout(sloth, parent);
       Sloth_Bool unsolved_violation = pl.size[axis].kind == Sloth_SizeKind_ChildrenSum;
       // TODO:
     } break;
@@ -3235,16 +5879,17 @@ sloth_size_fixup_cb_violations(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8*
 }
 
 Sloth_Function Sloth_Rect
-sloth_widget_calc_inner_bounds(Sloth_Widget* widget)
+sloth_widget_calc_inner_bounds(Sloth_Ctx* sloth, Sloth_Widget* widget)
 {
   SLOTH_PROFILE_BEGIN;
   SLOTH_PROFILE_BEGIN;
-  sloth_widget_validate_layout_(widget->layout);
+  Sloth_Widget_Layout* layout = sloth_widget_layout(sloth, widget);
+  sloth_widget_validate_layout_(*layout);
   Sloth_Rect result = widget->cached->bounds;
-  result.value_min.x += sloth_size_evaluate_margin(widget, widget->layout.margin.left,    Sloth_Axis_X);
-  result.value_min.y += sloth_size_evaluate_margin(widget, widget->layout.margin.top,     Sloth_Axis_Y);
-  result.value_max.x -= sloth_size_evaluate_margin(widget, widget->layout.margin.right,   Sloth_Axis_X);
-  result.value_max.y -= sloth_size_evaluate_margin(widget, widget->layout.margin.bottom,  Sloth_Axis_Y);
+  result.value_min.x += sloth_size_evaluate_margin(sloth, widget, layout->margin.left,    Sloth_Axis_X);
+  result.value_min.y += sloth_size_evaluate_margin(sloth, widget, layout->margin.top,     Sloth_Axis_Y);
+  result.value_max.x -= sloth_size_evaluate_margin(sloth, widget, layout->margin.right,   Sloth_Axis_X);
+  result.value_max.y -= sloth_size_evaluate_margin(sloth, widget, layout->margin.bottom,  Sloth_Axis_Y);
   if (result.value_max.x < result.value_min.x) {
     Sloth_R32 avg = (result.value_max.x + result.value_min.x) / 2;
     result.value_max.x = avg;
@@ -3263,11 +5908,11 @@ sloth_widget_calc_inner_bounds(Sloth_Widget* widget)
 // widgets dimensions, how far should the next widget offset itself
 // based on how the parent wants to lay its children out
 Sloth_Function Sloth_V2
-sloth_layout_get_child_relevant_extents(Sloth_Widget* parent, Sloth_Rect widget_bounds)
+sloth_layout_get_child_relevant_extents(Sloth_Ctx* sloth, Sloth_Widget* parent, Sloth_Rect widget_bounds)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_V2 relevant_extents = SLOTH_ZII;
-  switch (parent->layout.direction)
+  switch (sloth_widget_layout(sloth, parent)->direction)
   {
     case Sloth_LayoutDirection_TopDown:
     {
@@ -3295,11 +5940,11 @@ sloth_layout_get_child_relevant_extents(Sloth_Widget* parent, Sloth_Rect widget_
 }
 
 Sloth_Function Sloth_V2
-sloth_layout_clip_bounds_to_start_pos(Sloth_Widget* widget, Sloth_Rect clip_bounds)
+sloth_layout_clip_bounds_to_start_pos(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Rect clip_bounds)
 {
   SLOTH_PROFILE_BEGIN;
   Sloth_V2 start;
-  switch (widget->layout.direction)
+  switch (sloth_widget_layout(sloth, widget)->direction)
   {
     case Sloth_LayoutDirection_TopDown:
     case Sloth_LayoutDirection_LeftToRight: { 
@@ -3332,30 +5977,30 @@ sloth_layout_position_parent_decides(Sloth_Ctx* sloth, Sloth_Widget* widget, Slo
   Sloth_Rect bounds = widget->cached->bounds;
   
   Sloth_Rect clip_bounds;
-  if (widget->parent) 
+  Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
+  if (parent) 
   {
-    clip_bounds = sloth_widget_calc_inner_bounds(widget->parent);
-    Sloth_V2 start = sloth_layout_clip_bounds_to_start_pos(widget->parent, clip_bounds);
+    clip_bounds = sloth_widget_calc_inner_bounds(sloth, parent);
+    Sloth_V2 start = sloth_layout_clip_bounds_to_start_pos(sloth, parent, clip_bounds);
     
-    if (widget == widget->parent->child_first)
+    Sloth_Widget* sibling_prev = sloth_widget_sibling_prev(sloth, widget);
+    if (!sibling_prev)
     {
       offset.E[axis] = start.E[axis];
     }
     else 
     {
-      sloth_assert(widget->sibling_prev != 0);
-      
       // seek backwards to find the last child that has had its
       // offset calculated. If none, treat this child as the first
-      Sloth_Widget* last_relevant_sibling = widget->sibling_prev;
-      while(last_relevant_sibling && last_relevant_sibling->layout.position.kind != Sloth_LayoutPosition_ParentDecides)
+      Sloth_Widget* last_relevant_sibling = sibling_prev;
+      while(last_relevant_sibling && sloth_widget_layout(sloth, last_relevant_sibling)->position.kind != Sloth_LayoutPosition_ParentDecides)
       {
-        last_relevant_sibling = last_relevant_sibling->sibling_prev;
+        last_relevant_sibling = sloth_widget_sibling_prev(sloth, last_relevant_sibling);
       }
       
       if (last_relevant_sibling)
       {
-        Sloth_V2 extents = sloth_layout_get_child_relevant_extents(widget->parent, last_relevant_sibling->cached->bounds);
+        Sloth_V2 extents = sloth_layout_get_child_relevant_extents(sloth, parent, last_relevant_sibling->cached->bounds);
         offset.E[axis] = extents.E[axis];
       }
       else
@@ -3378,8 +6023,8 @@ sloth_layout_position_parent_decides(Sloth_Ctx* sloth, Sloth_Widget* widget, Slo
   }
   
   // Offset based on parent layout direction
-  if (widget->parent) {
-    switch (widget->parent->layout.direction)
+  if (parent) {
+    switch (sloth_widget_layout(sloth, parent)->direction)
     {
       case Sloth_LayoutDirection_RightToLeft:
       {
@@ -3412,14 +6057,14 @@ sloth_layout_position_fixed(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Layout
   SLOTH_PROFILE_BEGIN;
   Sloth_U32 axis = lc->axis;
   
-  Sloth_Layout_Position pos = widget->layout.position;
-  Sloth_R32 desired_offset_from_min = sloth_size_evaluate_margin(widget, pos.at.E[axis].min, axis);
-  Sloth_R32 desired_offset_from_max = sloth_size_evaluate_margin(widget, pos.at.E[axis].max, axis);
+  Sloth_Layout_Position pos = sloth_widget_layout(sloth, widget)->position;
+  Sloth_R32 desired_offset_from_min = sloth_size_evaluate_margin(sloth, widget, pos.at.E[axis].min, axis);
+  Sloth_R32 desired_offset_from_max = sloth_size_evaluate_margin(sloth, widget, pos.at.E[axis].max, axis);
   desired_offset_from_max += widget->cached->dim.E[axis];
   
-  Sloth_Widget* parent = widget->parent;
+  Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
   Sloth_R32 desired_offset = 0;
-  if (widget->layout.position.kind == Sloth_LayoutPosition_FixedInParent)
+  if (pos.kind == Sloth_LayoutPosition_FixedInParent)
   {
     desired_offset += parent->cached->offset.E[axis];
   }
@@ -3446,7 +6091,7 @@ sloth_layout_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
   SLOTH_PROFILE_BEGIN;
   Sloth_Layout_Cache* lc = (Sloth_Layout_Cache*)user_data;
   
-  switch (widget->layout.position.kind)
+  switch (sloth_widget_layout(sloth, widget)->position.kind)
   {
     case Sloth_LayoutPosition_ParentDecides:
     {
@@ -3469,16 +6114,18 @@ Sloth_Function Sloth_Tree_Walk_Result
 sloth_clip_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  if (!widget->parent) return Sloth_TreeWalk_Continue;
+  Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
+  if (!parent) return Sloth_TreeWalk_Continue;
   
   // these layout specifiers don't get clipped
-  if (widget->layout.position.kind == Sloth_LayoutPosition_FixedInParent ||
-      widget->layout.position.kind == Sloth_LayoutPosition_FixedOnScreen)
+  Sloth_Layout_Position_Kind position_kind = sloth_widget_layout(sloth, widget)->position.kind;
+  if (position_kind == Sloth_LayoutPosition_FixedInParent ||
+      position_kind == Sloth_LayoutPosition_FixedOnScreen)
   {
     return Sloth_TreeWalk_Continue;
   }
   
-  Sloth_Rect parent_bounds = widget->parent->cached->bounds;
+  Sloth_Rect parent_bounds = parent->cached->bounds;
   Sloth_Rect bounds = widget->cached->bounds;
   bounds.value_min = sloth_rect_get_closest_point(parent_bounds, bounds.value_min);
   bounds.value_max = sloth_rect_get_closest_point(parent_bounds, bounds.value_max);
@@ -3496,12 +6143,9 @@ Sloth_Function Sloth_U32
 sloth_render_quad_ptc(Sloth_VIBuffer* vibuf, Sloth_Rect bounds, Sloth_R32 z, Sloth_V2 uv_min, Sloth_V2 uv_max, Sloth_U32 color)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_V4 c4;
-  c4.r = (Sloth_R32)((color >> 24) & 0xFF) / 255.0f;
-  c4.g = (Sloth_R32)((color >> 16) & 0xFF) / 255.0f;
-  c4.b = (Sloth_R32)((color >>  8) & 0xFF) / 255.0f;
-  c4.a = (Sloth_R32)((color >>  0) & 0xFF) / 255.0f;
+  Sloth_Vertex_Color c4 = sloth_vertex_color(color);
   
+  sloth_vibuffer_reserve_verts(vibuf, 4);
   Sloth_U32 v0 = sloth_vibuffer_push_vert(vibuf, bounds.value_min.x, bounds.value_min.y, z, uv_min.x, uv_min.y, c4);
   Sloth_U32 v1 = sloth_vibuffer_push_vert(vibuf, bounds.value_max.x, bounds.value_min.y, z, uv_max.x, uv_min.y, c4);
   Sloth_U32 v2 = sloth_vibuffer_push_vert(vibuf, bounds.value_max.x, bounds.value_max.y, z, uv_max.x, uv_max.y, c4);
@@ -3515,11 +6159,7 @@ Sloth_Function void
 sloth_render_update_quad_ptc(Sloth_VIBuffer* vibuf, Sloth_U32 quad_v0_index, Sloth_Rect bounds, Sloth_R32 z, Sloth_V2 uv_min, Sloth_V2 uv_max, Sloth_U32 color)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_V4 c4;
-  c4.r = (Sloth_R32)((color >> 24) & 0xFF) / 255.0f;
-  c4.g = (Sloth_R32)((color >> 16) & 0xFF) / 255.0f;
-  c4.b = (Sloth_R32)((color >>  8) & 0xFF) / 255.0f;
-  c4.a = (Sloth_R32)((color >>  0) & 0xFF) / 255.0f;
+  Sloth_Vertex_Color c4 = sloth_vertex_color(color);
   
   sloth_assert(vibuf->verts_len > quad_v0_index + 3);
   
@@ -3709,54 +6349,441 @@ sloth_render_distribute_glyphs(Sloth_Glyph_Layout* glyphs, Sloth_U32 first, Slot
   }
 }
 
+// Shifts each line right by align times the room left on it.
+// 0.5 centers the lines, 1 right aligns them
+Sloth_Function void
+sloth_render_text_apply_align(Sloth_Glyph_Layout* glyphs, Sloth_Text_Line* lines, Sloth_U32 lines_len, Sloth_R32 line_max_width, Sloth_R32 align)
+{
+  SLOTH_PROFILE_BEGIN;
+  for (Sloth_U32 line_i = 0; line_i < lines_len; line_i++)
+  {
+    Sloth_Text_Line line = lines[line_i];
+    Sloth_R32 line_room = line_max_width - line.width;
+    //sloth_assert(line_room >= 0);
+    sloth_render_shift_glyphs(glyphs, line.first, line.one_past_last, Sloth_Axis_X, line_room * align);
+  }
+}
+
+Sloth_Function Sloth_Text_Layout_Key
+sloth_text_layout_key_(Sloth_Ctx* sloth, Sloth_Widget_Text* text, Sloth_Widget_Style* style, Sloth_Rect text_bounds)
+{
+  Sloth_Text_Layout_Key key;
+  key.text_hash = text->hash;
+  key.glyphs_len = text->glyphs_len;
+  key.glyphs_generation = sloth->glyph_store.generation;
+  key.text_style = style->text_style;
+  key.color_text = style->color_text;
+  key.bounds_min_x = text_bounds.value_min.x;
+  key.bounds_max_x = text_bounds.value_max.x;
+  return key;
+}
+
+// Never 0, which means not laid out
+Sloth_Function Sloth_U32
+sloth_text_layout_key_hash_(Sloth_Text_Layout_Key key)
+{
+  Sloth_U32 result = sloth_make_id_hash((Sloth_Char*)&key, sizeof(key)).value;
+  if (result == 0) result = 1;
+  return result;
+}
+
+Sloth_Function Sloth_Bool
+sloth_text_layout_key_equal_(Sloth_Text_Layout_Key a, Sloth_Text_Layout_Key b)
+{
+  return (a.text_hash == b.text_hash &&
+          a.glyphs_len == b.glyphs_len &&
+          a.glyphs_generation == b.glyphs_generation &&
+          a.text_style == b.text_style &&
+          a.color_text == b.color_text &&
+          a.bounds_min_x == b.bounds_min_x &&
+          a.bounds_max_x == b.bounds_max_x);
+}
+
+// text_hash can collide too, so a retained layout is only reused
+// if it was made from the same glyphs
+Sloth_Function Sloth_Bool
+sloth_text_layout_retained_matches_(Sloth_Widget_Text* text, Sloth_Widget_Cached* cached, Sloth_Text_Layout_Key key, Sloth_U32 hash)
+{
+  if (cached->text_layout_hash != hash) return false;
+  if (!sloth_text_layout_key_equal_(cached->text_layout_key, key)) return false;
+  if (cached->text_layout_len != text->glyphs_len) return false;
+  for (Sloth_U32 i = 0; i < text->glyphs_len; i++)
+  {
+    if (cached->text_layout_glyphs[i].glyph_id.value != text->glyphs[i].glyph_id.value) return false;
+  }
+  return true;
+}
+
+// Copies the retained layout into this frame's glyphs. Selection
+// is decided per frame, so it is kept from the glyphs being replaced
+Sloth_Function void
+sloth_text_layout_restore_(Sloth_Ctx* sloth, Sloth_Widget_Text* text, Sloth_Widget_Cached* cached)
+{
+  SLOTH_PROFILE_BEGIN;
+  for (Sloth_U32 i = 0; i < text->glyphs_len; i++)
+  {
+    Sloth_Glyph_Layout_Flags selected = text->glyphs[i].flags & Sloth_GlyphLayout_Selected;
+    text->glyphs[i] = cached->text_layout_glyphs[i];
+    sloth_flags_add(text->glyphs[i].flags, selected);
+  }
+  
+  text->lines = sloth_arena_push_array(sloth_frame_arena(sloth), Sloth_Text_Line, cached->text_layout_lines_len);
+  text->lines_len = cached->text_layout_lines_len;
+  for (Sloth_U32 i = 0; i < text->lines_len; i++) text->lines[i] = cached->text_layout_lines[i];
+}
+
+Sloth_Function void
+sloth_text_layout_retain_(Sloth_Widget_Text* text, Sloth_Widget_Cached* cached, Sloth_Text_Layout_Key key, Sloth_U32 hash, Sloth_V2 dim)
+{
+  SLOTH_PROFILE_BEGIN;
+  if (cached->text_layout_cap < text->glyphs_len)
+  {
+    Sloth_U32 new_cap = Sloth_Max(text->glyphs_len, cached->text_layout_cap * 2);
+    cached->text_layout_glyphs = sloth_realloc_array(cached->text_layout_glyphs, Sloth_Glyph_Layout, cached->text_layout_cap, new_cap);
+    cached->text_layout_cap = new_cap;
+  }
+  for (Sloth_U32 i = 0; i < text->glyphs_len; i++)
+  {
+    cached->text_layout_glyphs[i] = text->glyphs[i];
+    sloth_flags_rem(cached->text_layout_glyphs[i].flags, Sloth_GlyphLayout_Selected);
+  }
+  cached->text_layout_len = text->glyphs_len;
+  
+  if (cached->text_layout_lines_cap < text->lines_len)
+  {
+    Sloth_U32 new_cap = Sloth_Max(text->lines_len, cached->text_layout_lines_cap * 2);
+    cached->text_layout_lines = sloth_realloc_array(cached->text_layout_lines, Sloth_Text_Line, cached->text_layout_lines_cap, new_cap);
+    cached->text_layout_lines_cap = new_cap;
+  }
+  for (Sloth_U32 i = 0; i < text->lines_len; i++) cached->text_layout_lines[i] = text->lines[i];
+  cached->text_layout_lines_len = text->lines_len;
+  cached->text_layout_key = key;
+  cached->text_layout_hash = hash;
+  cached->text_layout_dim = dim;
+}
+
+// Everything a long text's line index depends on, besides the 
+// text's length. See sloth_long_text_layout_
+typedef struct Sloth_Long_Text_Key_ Sloth_Long_Text_Key_;
+struct Sloth_Long_Text_Key_
+{
+  Sloth_Char* text;
+  Sloth_U32 glyph_family;
+  Sloth_U32 text_style;
+  Sloth_R32 wrap_x;
+};
+
+// The parts of a glyph the line breaker needs, looked up once per
+// ascii character rather than once per byte of text
+typedef struct Sloth_Long_Text_Metrics_ Sloth_Long_Text_Metrics_;
+struct Sloth_Long_Text_Metrics_
+{
+  Sloth_R32 lsb;
+  Sloth_R32 width;
+  Sloth_R32 x_advance;
+  Sloth_Bool known;
+};
+
+Sloth_Function Sloth_Long_Text_Metrics_
+sloth_long_text_metrics_(Sloth_Ctx* sloth, Sloth_Font_ID font, Sloth_U32 family, Sloth_U32 char_code)
+{
+  Sloth_Long_Text_Metrics_ result = SLOTH_ZII;
+  Sloth_Glyph_ID id = sloth_make_glyph_id(family, char_code);
+  Sloth_Glyph* glyph = (Sloth_Glyph*)sloth_hashtable_get(&sloth->glyph_store.glyphs_table, id.value);
+  if (!glyph)
+  {
+    sloth_font_register_codepoint(sloth, font, char_code);
+    glyph = (Sloth_Glyph*)sloth_hashtable_get(&sloth->glyph_store.glyphs_table, id.value);
+  }
+  if (glyph)
+  {
+    result.lsb = glyph->lsb;
+    result.width = (Sloth_R32)glyph->dst_width;
+    result.x_advance = glyph->x_advance;
+  }
+  result.known = true;
+  return result;
+}
+
+Sloth_Function Sloth_U32
+sloth_long_text_tail_hash_(Sloth_Long_Text_Index* index, Sloth_Char* text)
+{
+  if (index->lines_len == 0) return 0;
+  Sloth_U32 tail_start = index->line_starts[index->lines_len - 1];
+  return sloth_make_id_hash(text + tail_start, index->indexed_len - tail_start).value;
+}
+
 Sloth_Function void
-sloth_render_text_apply_align_center(Sloth_Widget* widget, Sloth_Glyph_Layout* glyphs, Sloth_U32 glyphs_cap, Sloth_Rect text_bounds)
+sloth_long_text_index_push_line_(Sloth_Long_Text_Index* index, Sloth_U32 line_start)
+{
+  if (index->lines_len >= index->line_starts_cap)
+  {
+    Sloth_U32 new_cap = Sloth_Max(64, index->line_starts_cap * 2);
+    index->line_starts = sloth_realloc_array(index->line_starts, Sloth_U32, index->line_starts_cap, new_cap);
+    index->line_starts_cap = new_cap;
+  }
+  index->line_starts[index->lines_len++] = line_start;
+}
+
+// Brings the widget's line index up to date with its long text and
+// returns the text's dimensions. Lines are broken exactly as 
+// sloth_layout_text_in_widget breaks them, but only line starts are
+// kept; no glyphs are laid out here
+Sloth_Function Sloth_V2
+sloth_long_text_layout_(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Rect text_bounds)
 {
   SLOTH_PROFILE_BEGIN;
+  Sloth_Widget_Text*   widget_text  = sloth_widget_text(sloth, widget);
+  Sloth_Widget_Style*  widget_style = sloth_widget_style(sloth, widget);
+  Sloth_Widget_Cached* cached = widget->cached;
+  Sloth_Char* text = widget_text->long_text;
+  Sloth_U32 text_len = widget_text->long_text_len;
+  
+  Sloth_Font_ID font = widget_style->font;
+  Sloth_Font* active_font = 0;
+  Sloth_U32 family = 0;
+  if (sloth->fonts && font.value < sloth->fonts_len) 
+  {
+    active_font = sloth->fonts + font.value;
+    family = active_font->weights[font.weight_index].glyph_family;
+  }
+  
+  Sloth_Bool wrap = !sloth_flags_has(widget_style->text_style, Sloth_TextStyle_NoWrapText);
+  Sloth_R32 wrap_x = text_bounds.value_max.x;
+  
+  Sloth_Long_Text_Key_ key;
+  sloth_zero_struct_(&key);
+  key.text = text;
+  key.glyph_family = family;
+  key.text_style = widget_style->text_style;
+  key.wrap_x = wrap ? wrap_x : 0;
+  Sloth_U32 layout_key = sloth_make_id_hash((Sloth_Char*)&key, sizeof(key)).value;
+  
+  if (!cached->long_text)
+  {
+    cached->long_text = sloth_realloc_array(0, Sloth_Long_Text_Index, 0, 1);
+    sloth_zero_struct_(cached->long_text);
+  }
+  Sloth_Long_Text_Index* index = cached->long_text;
+  if (index->key != layout_key || 
+      text_len < index->indexed_len || 
+      index->tail_hash != sloth_long_text_tail_hash_(index, text))
+  {
+    index->lines_len = 0;
+    index->indexed_len = 0;
+    index->max_width = 0;
+    index->key = layout_key;
+  }
+  
+  if (active_font) {
+    index->line_advance = active_font->metrics.line_height;
+    index->to_baseline = active_font->metrics.to_baseline;
+  } else if (text_len > 0) {
+    Sloth_U32 first_char_i = 0;
+    Sloth_U32 first_char = sloth_utf8_decode(text, text_len, &first_char_i);
+    index->line_advance = (Sloth_R32)sloth_lookup_glyph(sloth, sloth_make_glyph_id(family, first_char)).glyph.dst_height;
+    index->to_baseline = 0;
+  }
+  index->align_width = wrap_x;
   
-  Sloth_R32 line_max_width = sloth_rect_dim(text_bounds).x;
-  Sloth_U32 last_line_start_i = 0;
-  Sloth_R32 last_line_start_x = glyphs[0].bounds.value_min.x;
-  for (Sloth_U32 glyph_i = 1; glyph_i < glyphs_cap; glyph_i++)
+  if (index->lines_len == 0 || index->indexed_len < text_len)
   {
-    if (!sloth_flags_has(glyphs[glyph_i].flags, Sloth_GlyphLayout_IsLineStart)) continue;
+    // The last line may continue into the appended text, so it is
+    // broken again. Every line starts at x = 0 with nothing to carry
+    // over from the lines before it
+    Sloth_U32 line_first = 0;
+    if (index->lines_len > 0) line_first = index->line_starts[--index->lines_len];
+    sloth_long_text_index_push_line_(index, line_first);
+    
+    Sloth_Long_Text_Metrics_ ascii[128];
+    sloth_zero_size__(sizeof(ascii), (Sloth_U8*)ascii);
+    
+    Sloth_R32 at_x = 0;
+    Sloth_R32 line_right = 0;
+    Sloth_R32 max_width = index->max_width;
+    
+    // see sloth_layout_text_in_widget. word_right is the right edge
+    // of everything placed since break_at
+    Sloth_U32 break_at = 0;
+    Sloth_R32 break_x = 0;
+    Sloth_R32 break_right = 0;
+    Sloth_R32 word_right = Sloth_R32_Min;
     
-    // process the line just completed
-    Sloth_R32 last_line_end_x = glyphs[glyph_i - 1].bounds.value_max.x;
-    Sloth_R32 last_line_w = last_line_end_x - last_line_start_x;
-    Sloth_R32 last_line_room = line_max_width - last_line_w;
-    //sloth_assert(last_line_room >= 0);
-    Sloth_R32 last_line_offset = last_line_room / 2;
-    sloth_render_shift_glyphs(glyphs, last_line_start_i, glyph_i, Sloth_Axis_X, last_line_offset);
+    Sloth_U32 next_char_i = line_first;
+    while (next_char_i < text_len)
+    {
+      Sloth_U32 char_i = next_char_i;
+      Sloth_U32 char_code = sloth_utf8_decode(text, text_len, &next_char_i);
+      
+      if (char_code == '\n')
+      {
+        max_width = Sloth_Max(max_width, line_right);
+        line_first = next_char_i;
+        sloth_long_text_index_push_line_(index, line_first);
+        at_x = 0;
+        line_right = 0;
+        continue;
+      }
+      
+      Sloth_Long_Text_Metrics_ m;
+      if (char_code < 128) {
+        if (!ascii[char_code].known) ascii[char_code] = sloth_long_text_metrics_(sloth, font, family, char_code);
+        m = ascii[char_code];
+      } else {
+        m = sloth_long_text_metrics_(sloth, font, family, char_code);
+      }
+      
+      Sloth_Bool is_space = char_code == ' ';
+      Sloth_R32 right = at_x + m.lsb + m.width;
+      Sloth_R32 next_x = sloth_floor_r32(at_x + m.x_advance);
+      if (wrap && !is_space && right > wrap_x && char_i > line_first)
+      {
+        Sloth_U32 line_break = char_i;
+        Sloth_R32 line_break_x = at_x;
+        Sloth_R32 line_width = line_right;
+        Sloth_R32 moved_right = right;
+        if (break_at > line_first)
+        {
+          line_break = break_at;
+          line_break_x = break_x;
+          line_width = break_right;
+          moved_right = Sloth_Max(word_right, right);
+        }
+        max_width = Sloth_Max(max_width, line_width);
+        line_first = line_break;
+        sloth_long_text_index_push_line_(index, line_first);
+        
+        right -= line_break_x;
+        next_x -= line_break_x;
+        line_right = moved_right - line_break_x;
+      }
+      else
+      {
+        line_right = Sloth_Max(line_right, right);
+      }
+      word_right = Sloth_Max(word_right, right);
+      
+      if (is_space)
+      {
+        break_at = next_char_i;
+        break_x = next_x;
+        break_right = line_right;
+        word_right = Sloth_R32_Min;
+      }
+      at_x = next_x;
+    }
     
-    // start the new line
-    last_line_start_i = glyph_i;
-    last_line_start_x = glyphs[glyph_i].bounds.value_min.x;
+    index->max_width = Sloth_Max(max_width, line_right);
+    index->indexed_len = text_len;
+    index->tail_hash = sloth_long_text_tail_hash_(index, text);
   }
+  
+  if (wrap_x >= Sloth_R32_Max) index->align_width = index->max_width;
+  
+  Sloth_V2 text_dim;
+  text_dim.x = index->max_width - text_bounds.value_min.x;
+  text_dim.y = index->lines_len * index->line_advance;
+  return text_dim;
 }
 
+// Lays out the lines of a long text that intersect the widget's
+// clipped bounds into glyphs, as sloth_layout_text_in_widget would 
+// have laid them out, ready to be offset and clipped
 Sloth_Function void
-sloth_render_text_apply_align_right(Sloth_Widget* widget, Sloth_Glyph_Layout* glyphs, Sloth_U32 glyphs_cap, Sloth_Rect text_bounds)
+sloth_long_text_layout_visible_(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_V2 offset)
 {
   SLOTH_PROFILE_BEGIN;
+  Sloth_Widget_Text*  widget_text  = sloth_widget_text(sloth, widget);
+  Sloth_Widget_Style* widget_style = sloth_widget_style(sloth, widget);
+  Sloth_Long_Text_Index* index = widget->cached->long_text;
+  widget_text->glyphs_len = 0;
+  widget_text->lines_len = 0;
+  if (!index || index->lines_len == 0) return;
+  
+  Sloth_Rect clip = widget->cached->bounds;
+  if (clip.value_max.y <= clip.value_min.y) return;
+  
+  // Glyphs can reach a little past their line (descenders, tall
+  // glyphs) so one more line is laid out on each side
+  Sloth_U32 first_line = 0;
+  Sloth_U32 one_past_last_line = index->lines_len;
+  if (index->line_advance > 0)
+  {
+    Sloth_R32 top = (clip.value_min.y - offset.y) / index->line_advance;
+    Sloth_R32 bottom = (clip.value_max.y - offset.y) / index->line_advance;
+    if (bottom <= 0) return;
+    if (top > 1) first_line = (Sloth_U32)top - 1;
+    if (bottom + 2 < (Sloth_R32)one_past_last_line) one_past_last_line = (Sloth_U32)bottom + 2;
+    if (first_line >= one_past_last_line) return;
+  }
+  
+  Sloth_U32 first_char = index->line_starts[first_line];
+  Sloth_U32 one_past_last_char = widget_text->long_text_len;
+  if (one_past_last_line < index->lines_len) one_past_last_char = index->line_starts[one_past_last_line];
+  Sloth_Char* text = widget_text->long_text;
+  Sloth_U32 glyphs_len = sloth_utf8_glyph_count(text + first_char, one_past_last_char - first_char);
+  Sloth_U32 lines_len = one_past_last_line - first_line;
+  
+  widget_text->glyphs = sloth_arena_push_array(sloth_frame_arena(sloth), Sloth_Glyph_Layout, glyphs_len + 1);
+  sloth_zero_size__(sizeof(Sloth_Glyph_Layout) * (glyphs_len + 1), (Sloth_U8*)widget_text->glyphs);
+  widget_text->glyphs_cap = glyphs_len;
+  widget_text->glyphs_len = glyphs_len;
+  widget_text->lines = sloth_arena_push_array(sloth_frame_arena(sloth), Sloth_Text_Line, lines_len);
+  widget_text->lines_len = lines_len;
+  widget_text->long_text_first_visible_line = first_line;
+  
+  Sloth_Font_ID font = widget_style->font;
+  Sloth_U32 family = 0;
+  if (sloth->fonts && font.value < sloth->fonts_len) {
+    family = sloth->fonts[font.value].weights[font.weight_index].glyph_family;
+  }
   
-  Sloth_R32 line_max_width = sloth_rect_dim(text_bounds).x;
-  Sloth_U32 last_line_start_i = 0;
-  Sloth_R32 last_line_start_x = glyphs[0].bounds.value_min.x;
-  for (Sloth_U32 glyph_i = 1; glyph_i < glyphs_cap; glyph_i++)
+  Sloth_U32 glyph_i = 0;
+  for (Sloth_U32 line_i = 0; line_i < lines_len; line_i++)
   {
-    if (!sloth_flags_has(glyphs[glyph_i].flags, Sloth_GlyphLayout_IsLineStart)) continue;
+    Sloth_U32 index_line = first_line + line_i;
+    Sloth_U32 char_i = index->line_starts[index_line];
+    Sloth_U32 line_one_past_last_char = one_past_last_char;
+    if (index_line + 1 < index->lines_len) line_one_past_last_char = index->line_starts[index_line + 1];
     
-    // process the line just completed
-    Sloth_R32 last_line_end_x = glyphs[glyph_i - 1].bounds.value_max.x;
-    Sloth_R32 last_line_w = last_line_end_x - last_line_start_x;
-    Sloth_R32 last_line_room = line_max_width - last_line_w;
-    //sloth_assert(last_line_room >= 0);
-    sloth_render_shift_glyphs(glyphs, last_line_start_i, glyph_i, Sloth_Axis_X, last_line_room);
+    Sloth_Text_Line* line = widget_text->lines + line_i;
+    line->first = glyph_i;
+    line->baseline = index->to_baseline + (index_line * index->line_advance);
+    line->width = 0;
     
-    // start the new line
-    last_line_start_i = glyph_i;
-    last_line_start_x = glyphs[glyph_i].bounds.value_min.x;
+    Sloth_V2 at; at.x = 0; at.y = line->baseline;
+    for (; char_i < line_one_past_last_char; glyph_i++)
+    {
+      Sloth_Glyph_Layout* g = widget_text->glyphs + glyph_i;
+      Sloth_U32 char_code = sloth_utf8_decode(text, line_one_past_last_char, &char_i);
+      g->glyph_id = sloth_make_glyph_id(family, char_code);
+      g->info = sloth_lookup_glyph(sloth, g->glyph_id);
+      g->color = widget_style->color_text;
+      if (glyph_i == line->first) sloth_flags_add(g->flags, Sloth_GlyphLayout_IsLineStart);
+      
+      if (char_code == '\n')
+      {
+        g->bounds.value_min = at;
+        g->bounds.value_max = at;
+      }
+      else
+      {
+        g->bounds = sloth_render_get_glyph_bounds(g->info, at, &at);
+        line->width = Sloth_Max(line->width, g->bounds.value_max.x);
+      }
+    }
+    line->one_past_last = glyph_i;
+  }
+  sloth_assert(glyph_i == glyphs_len);
+  
+  Sloth_Text_Style_Flags text_style = widget_style->text_style;
+  if (sloth_flags_has(text_style, Sloth_TextStyle_Align_Center))
+  {
+    sloth_render_text_apply_align(widget_text->glyphs, widget_text->lines, lines_len, index->align_width, 0.5f);
+  }
+  else if (sloth_flags_has(text_style, Sloth_TextStyle_Align_Right))
+  {
+    sloth_render_text_apply_align(widget_text->glyphs, widget_text->lines, lines_len, index->align_width, 1.0f);
   }
 }
 
@@ -3767,101 +6794,150 @@ sloth_layout_text_in_widget(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Rect t
   
   Sloth_V2 text_dim = SLOTH_ZII;
   
-  Sloth_U32 last_line_break = 0;
-  Sloth_Glyph_Layout* text = widget->text;
+  Sloth_Widget_Text*  widget_text  = sloth_widget_text(sloth, widget);
+  Sloth_Widget_Style* widget_style = sloth_widget_style(sloth, widget);
+  if (widget_text->long_text) return sloth_long_text_layout_(sloth, widget, text_bounds);
+  
+  // Most text is the same from one frame to the next. If nothing 
+  // the layout depends on has changed, it is either already in 
+  // glyphs (laid out by an earlier pass this frame) or retained in
+  // the widget's cache from a previous frame
+  Sloth_Widget_Cached* cached = widget->cached;
+  Sloth_Text_Layout_Key layout_key = sloth_text_layout_key_(sloth, widget_text, widget_style, text_bounds);
+  Sloth_U32 layout_hash = sloth_text_layout_key_hash_(layout_key);
+  if (widget_text->layout_hash == layout_hash && sloth_text_layout_key_equal_(widget_text->layout_key, layout_key)) 
+  {
+    return widget_text->dim;
+  }
+  if (sloth_text_layout_retained_matches_(widget_text, cached, layout_key, layout_hash))
+  {
+    sloth_text_layout_restore_(sloth, widget_text, cached);
+    widget_text->layout_key = layout_key;
+    widget_text->layout_hash = layout_hash;
+    return cached->text_layout_dim;
+  }
   
-  Sloth_Font* active_font = 0;
+  Sloth_Glyph_Layout* text = widget_text->glyphs;
+  Sloth_U32 text_len = widget_text->glyphs_len;
+  if (text_len == 0) 
+  {
+    widget_text->lines = 0;
+    widget_text->lines_len = 0;
+    widget_text->layout_key = layout_key;
+    widget_text->layout_hash = layout_hash;
+    sloth_text_layout_retain_(widget_text, cached, layout_key, layout_hash, text_dim);
+    return text_dim;
+  }
+  
+  // Lines are gathered on scratch since how many there will be isn't
+  // known until the end. Every glyph starting a line is the worst case
+  Sloth_Arena_Loc scratch_at = sloth_arena_at(&sloth->scratch);
+  Sloth_Text_Line* lines = sloth_arena_push_array(&sloth->scratch, Sloth_Text_Line, text_len + 1);
+  Sloth_U32 lines_len = 0;
+  
+  Sloth_Bool wrap = !sloth_flags_has(widget_style->text_style, Sloth_TextStyle_NoWrapText);
+  Sloth_R32 wrap_x = text_bounds.value_max.x;
+  
+  // The first glyph's font decides where the first baseline is and
+  // how far apart lines are
   Sloth_R32 line_advance = 0;
   Sloth_V2 at; at.x = 0; at.y = 0;
-  Sloth_U32 text_lines_count = 0;
-  for (Sloth_U32 glyph_i = 0; glyph_i < widget->text_len; glyph_i++)
+  Sloth_U8 active_family = text[0].glyph_id.family;
+  Sloth_Font* active_font = sloth_glyph_to_font(sloth, text[0].glyph_id);
+  if (active_font) {
+    line_advance = active_font->metrics.line_height;
+    at.y += active_font->metrics.to_baseline;
+  } else {
+    // TODO(PS): does line advance really make sense if there's no font
+    // data we're drawing from? The characters wont be visible
+    line_advance = sloth_lookup_glyph(sloth, text[0].glyph_id).glyph.dst_height;
+  }
+  
+  Sloth_Text_Line* line = lines + lines_len++;
+  line->first = 0;
+  line->baseline = at.y;
+  
+  // right edge of the current line so far
+  Sloth_R32 line_right = 0;
+  
+  // The last place the current line can be broken (the glyph after 
+  // the most recent space), the pen position that glyph starts at, 
+  // and the line's right edge up to it.
+  // Only valid when break_at > line->first
+  Sloth_U32 break_at = 0;
+  Sloth_R32 break_x = 0;
+  Sloth_R32 break_right = 0;
+  
+  // Greedy line breaking: each glyph is placed once, and when one
+  // overflows, everything since the last break opportunity (at most
+  // the word being placed) moves down to a new line. So every glyph
+  // is moved at most once and the whole pass is linear
+  for (Sloth_U32 glyph_i = 0; glyph_i < text_len; glyph_i++)
   {
     Sloth_Glyph_Layout* text_at = text + glyph_i;
+    text_at->info = sloth_lookup_glyph(sloth, text_at->glyph_id);
+    text_at->color = widget_style->color_text;
+    if (glyph_i == line->first) sloth_flags_add(text_at->flags, Sloth_GlyphLayout_IsLineStart);
     
-    Sloth_V2 next_at;
-    Sloth_Rect glyph_bounds;
     Sloth_Bool is_newline = sloth_glyph_id_matches_charcode(text_at->glyph_id, '\n');
-    if (!is_newline)
-    {
-      text_at->info = sloth_lookup_glyph(sloth, text_at->glyph_id);
-      text_at->color = widget->style.color_text;
-      
-      // The first glyph needs to be treated differently as it
-      // will also offset to the first baseline
-      if (glyph_i == 0) 
-      {
-        sloth_flags_add(text_at->flags, Sloth_GlyphLayout_IsLineStart);
-        active_font = sloth_glyph_to_font(sloth, text_at->glyph_id);
-        if (active_font) {
-          line_advance = active_font->metrics.line_height;
-          at.y += active_font->metrics.to_baseline;
-        } else {
-          // TODO(PS): does line advance really make sense if there's no font
-          // data we're drawing from? The characters wont be visible
-          line_advance = text_at->info.glyph.dst_height;
-        }
-        text_lines_count += 1;
-      }
-      
-      next_at = at;
-      glyph_bounds = sloth_render_get_glyph_bounds(text_at->info, at, &next_at);
-      text_at->bounds = glyph_bounds;
-    }
+    Sloth_Bool is_space = sloth_glyph_id_matches_charcode(text_at->glyph_id, ' ');
+    Sloth_Glyph_ID line_first_id = text_at->glyph_id;
+    Sloth_U32 new_line_first = text_len;
     
-    if(is_newline) 
+    Sloth_V2 next_at = at;
+    if (is_newline)
     {
+      text_at->bounds.value_min = at;
+      text_at->bounds.value_max = at;
+      line->width = line_right;
+      line->one_past_last = glyph_i + 1;
+      line_right = 0;
+      
       next_at.x = 0;
       next_at.y += line_advance;
-      text_lines_count += 1;
+      new_line_first = glyph_i + 1;
+      if (new_line_first < text_len) line_first_id = text[new_line_first].glyph_id;
     }
-    else if(glyph_bounds.value_max.x > text_bounds.value_max.x)
+    else
     {
-      // look backwards to the last line-break glyph and move everything since to a new line
-      Sloth_U32 line_break = glyph_i;
-      for (Sloth_U32 lb_i = glyph_i; lb_i > last_line_break && lb_i < widget->text_len; lb_i--)
-      {
-        Sloth_Bool is_space = sloth_glyph_id_matches_charcode(widget->text[lb_i].glyph_id, ' ');
-        Sloth_Bool is_newline = sloth_glyph_id_matches_charcode(widget->text[lb_i].glyph_id, '\n');
-        if (is_space || is_newline)
-        {
-          line_break = lb_i + 1;
-          break;
-        }
-      }
+      text_at->bounds = sloth_render_get_glyph_bounds(text_at->info, at, &next_at);
       
-      if (!sloth_flags_has(widget->style.text_style, Sloth_TextStyle_NoWrapText))
+      // Spaces are allowed to hang past the edge, and a glyph that 
+      // doesn't fit on a line by itself stays where it is
+      Sloth_Bool overflows = text_at->bounds.value_max.x > wrap_x;
+      if (wrap && overflows && !is_space && glyph_i > line->first)
       {
-        at.x = 0;
-        at.y += line_advance;
-        text_lines_count += 1;
-        
-        if (line_break == last_line_break)
-        {
-          // since there was nowhere on this line acceptable for
-          // a line break, advance the current glyph to the next
-          // line since its the first glyph that will overflow
-          line_break = glyph_i;
-        }
-        
-        sloth_flags_add(text[line_break].flags, Sloth_GlyphLayout_IsLineStart);
-        if (text[line_break].glyph_id.family != text[last_line_break].glyph_id.family)
+        Sloth_U32 line_break = glyph_i;
+        Sloth_R32 line_break_x = at.x;
+        line->width = line_right;
+        if (break_at > line->first)
         {
-          active_font = sloth_glyph_to_font(sloth, text_at->glyph_id);
-          if (active_font) {
-            line_advance = active_font->metrics.line_height;
-          } else {
-            line_advance = text_at->info.glyph.dst_height;
-          }
+          line_break = break_at;
+          line_break_x = break_x;
+          line->width = break_right;
         }
+        line->one_past_last = line_break;
         
-        for (Sloth_U32 new_line_i = line_break; new_line_i <= glyph_i; new_line_i++)
+        // glyphs [line_break, glyph_i] move to the start of the next line
+        line_right = 0;
+        for (Sloth_U32 move_i = line_break; move_i <= glyph_i; move_i++)
         {
-          Sloth_Glyph_Layout new_line_glyph = widget->text[new_line_i];
-          Sloth_Rect new_bounds = sloth_render_get_glyph_bounds(new_line_glyph.info, at, &next_at);
-          widget->text[new_line_i].bounds = new_bounds;
-          at = next_at;         
+          Sloth_Rect* b = &text[move_i].bounds;
+          b->value_min.x -= line_break_x;
+          b->value_max.x -= line_break_x;
+          b->value_min.y += line_advance;
+          b->value_max.y += line_advance;
+          line_right = Sloth_Max(line_right, b->value_max.x);
         }
-        last_line_break = line_break;
+        sloth_flags_add(text[line_break].flags, Sloth_GlyphLayout_IsLineStart);
+        next_at.x -= line_break_x;
+        next_at.y += line_advance;
+        new_line_first = line_break;
+        line_first_id = text[line_break].glyph_id;
+      }
+      else
+      {
+        line_right = Sloth_Max(line_right, text_at->bounds.value_max.x);
       }
       
       // TODO: stop creating glyphs if we're at a point where they won't
@@ -3871,31 +6947,71 @@ sloth_layout_text_in_widget(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Rect t
       // glyphs
     }
     
+    if (new_line_first < text_len || is_newline)
+    {
+      line = lines + lines_len++;
+      line->first = new_line_first;
+      line->baseline = next_at.y;
+      
+      if (line_first_id.family != active_family)
+      {
+        active_family = line_first_id.family;
+        active_font = sloth_glyph_to_font(sloth, line_first_id);
+        if (active_font) {
+          line_advance = active_font->metrics.line_height;
+        } else {
+          line_advance = sloth_lookup_glyph(sloth, line_first_id).glyph.dst_height;
+        }
+      }
+    }
+    
+    if (is_space)
+    {
+      break_at = glyph_i + 1;
+      break_x = next_at.x;
+      break_right = line_right;
+    }
     at = next_at;
   }
   
+  // close the last line
+  line->width = line_right;
+  line->one_past_last = text_len;
+  
+  Sloth_R32 lines_max_width = 0;
+  for (Sloth_U32 line_i = 0; line_i < lines_len; line_i++)
+  {
+    lines_max_width = Sloth_Max(lines_max_width, lines[line_i].width);
+  }
+  
   // Handle text alignment
   // This just adjusts the existing positions given
-  // during the default layout step above 
-  Sloth_Text_Style_Flags text_style = widget->style.text_style;
+  // during the default layout step above. Text that isn't
+  // bounded horizontally is aligned within its widest line
+  Sloth_R32 align_width = sloth_rect_dim(text_bounds).x;
+  if (text_bounds.value_max.x >= Sloth_R32_Max) align_width = lines_max_width;
+  Sloth_Text_Style_Flags text_style = widget_style->text_style;
   // no action necessary for Align_Left
   if (sloth_flags_has(text_style, Sloth_TextStyle_Align_Center))
   {
-    sloth_render_text_apply_align_center(widget, widget->text, widget->text_len, text_bounds);
+    sloth_render_text_apply_align(text, lines, lines_len, align_width, 0.5f);
   }
   else if (sloth_flags_has(text_style, Sloth_TextStyle_Align_Right))
   {
-    sloth_render_text_apply_align_right(widget, widget->text, widget->text_len, text_bounds);
+    sloth_render_text_apply_align(text, lines, lines_len, align_width, 1.0f);
   }
   
-  Sloth_V2 text_max = SLOTH_ZII;
-  for (Sloth_U32 glyph_i = 0; glyph_i < widget->text_len; glyph_i++)
-  {
-    text_max.x = Sloth_Max(text_max.x, text[glyph_i].bounds.value_max.x);
-    text_max.y = Sloth_Max(text_max.y, text[glyph_i].bounds.value_max.y);
-  }
-  text_dim.x = text_max.x - text_bounds.value_min.x;
-  text_dim.y += (text_lines_count * line_advance);
+  text_dim.x = lines_max_width - text_bounds.value_min.x;
+  text_dim.y += (lines_len * line_advance);
+  
+  widget_text->lines = sloth_arena_push_array(sloth_frame_arena(sloth), Sloth_Text_Line, lines_len);
+  widget_text->lines_len = lines_len;
+  for (Sloth_U32 line_i = 0; line_i < lines_len; line_i++) widget_text->lines[line_i] = lines[line_i];
+  sloth_arena_pop(&sloth->scratch, scratch_at);
+  
+  widget_text->layout_key = layout_key;
+  widget_text->layout_hash = layout_hash;
+  sloth_text_layout_retain_(widget_text, cached, layout_key, layout_hash, text_dim);
   
   return text_dim;
 }
@@ -3909,24 +7025,35 @@ sloth_size_kind_text_contents_layout_text(Sloth_Ctx* sloth, Sloth_Widget* widget
   // but it doesnt have any, AND it has text contents, we want to treat
   // that text content as its children.
   // TODO(PS): There's probably a way to simplify this whole relationship
-  if (widget->child_first == 0 && widget->text_len > 0)
+  Sloth_Widget_Layout l = *sloth_widget_layout(sloth, widget);
+  Sloth_Widget_Text* widget_text = sloth_widget_text(sloth, widget);
+  Sloth_Bool has_text = widget_text->glyphs_len > 0 || widget_text->long_text_len > 0;
+  if (sloth_widget_child_first(sloth, widget) == 0 && has_text)
   {
-    if (widget->layout.width.kind == Sloth_SizeKind_ChildrenSum) {
-      widget->layout.width = SLOTH_SIZE_TEXT_CONTENT;
+    Sloth_Bool changed = false;
+    if (l.width.kind == Sloth_SizeKind_ChildrenSum) {
+      l.width = SLOTH_SIZE_TEXT_CONTENT;
+      changed = true;
+    }
+    if (l.height.kind == Sloth_SizeKind_ChildrenSum) {
+      l.height = SLOTH_SIZE_TEXT_CONTENT;
+      changed = true;
     }
-    if (widget->layout.height.kind == Sloth_SizeKind_ChildrenSum) {
-      widget->layout.height = SLOTH_SIZE_TEXT_CONTENT;
+    // the layout may be shared, so this widget gets its own
+    if (changed) 
+    {
+      widget->layout_handle = sloth_layout_intern_(sloth, l, widget->cached->layout_text_handle);
+      widget->cached->layout_text_handle = widget->layout_handle;
     }
   }
   
   Sloth_Rect text_bounds = SLOTH_ZII;
-  Sloth_Widget_Layout l = widget->layout;
   if (l.width.kind == Sloth_SizeKind_TextContent) 
   {
     text_bounds.value_max.x = Sloth_R32_Max;
     if (l.height.kind == Sloth_SizeKind_Pixels) {
-      Sloth_R32 margin_t = sloth_size_evaluate_margin(widget, widget->layout.margin.top, 0);
-      Sloth_R32 margin_b = sloth_size_evaluate_margin(widget, widget->layout.margin.bottom, 0);
+      Sloth_R32 margin_t = sloth_size_evaluate_margin(sloth, widget, l.margin.top, 0);
+      Sloth_R32 margin_b = sloth_size_evaluate_margin(sloth, widget, l.margin.bottom, 0);
       text_bounds.value_max.y = Sloth_Max(0, l.height.value - (margin_t + margin_b));
     } else {
       text_bounds.value_max.y = Sloth_R32_Max;
@@ -3935,8 +7062,8 @@ sloth_size_kind_text_contents_layout_text(Sloth_Ctx* sloth, Sloth_Widget* widget
   else if (l.width.kind == Sloth_SizeKind_Pixels &&
       l.height.kind == Sloth_SizeKind_TextContent)
   {
-    Sloth_R32 margin_l = sloth_size_evaluate_margin(widget, widget->layout.margin.left, 0);
-    Sloth_R32 margin_r = sloth_size_evaluate_margin(widget, widget->layout.margin.right, 0);
+    Sloth_R32 margin_l = sloth_size_evaluate_margin(sloth, widget, l.margin.left, 0);
+    Sloth_R32 margin_r = sloth_size_evaluate_margin(sloth, widget, l.margin.right, 0);
     text_bounds.value_max.x = Sloth_Max(0, l.width.value - (margin_l + margin_r));
     text_bounds.value_max.y = Sloth_R32_Max;
   }
@@ -3945,7 +7072,7 @@ sloth_size_kind_text_contents_layout_text(Sloth_Ctx* sloth, Sloth_Widget* widget
     return Sloth_TreeWalk_Continue; // will be handled later
   }
   
-  widget->text_dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
+  sloth_widget_text(sloth, widget)->dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
   
   return Sloth_TreeWalk_Continue;
 }
@@ -3954,17 +7081,17 @@ Sloth_Function Sloth_Tree_Walk_Result
 sloth_percent_parent_width_layout_text(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_Widget_Layout l = widget->layout;
+  Sloth_Widget_Layout l = *sloth_widget_layout(sloth, widget);
   if (l.width.kind != Sloth_SizeKind_PercentOfParent) return Sloth_TreeWalk_Continue;
   if (l.height.kind != Sloth_SizeKind_TextContent) return Sloth_TreeWalk_Continue;
   
-  Sloth_R32 margin = sloth_size_evaluate_margin(widget, widget->layout.margin.left, Sloth_Axis_X);
-  margin += sloth_size_evaluate_margin(widget, widget->layout.margin.right, Sloth_Axis_X);
+  Sloth_R32 margin = sloth_size_evaluate_margin(sloth, widget, l.margin.left, Sloth_Axis_X);
+  margin += sloth_size_evaluate_margin(sloth, widget, l.margin.right, Sloth_Axis_X);
   
   Sloth_Rect text_bounds = SLOTH_ZII;
   text_bounds.value_max.x = Sloth_Max(0, widget->cached->dim.x - margin);
   text_bounds.value_max.y = Sloth_R32_Max;
-  widget->text_dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
+  sloth_widget_text(sloth, widget)->dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
   
   return Sloth_TreeWalk_Continue;
   
@@ -3974,17 +7101,17 @@ Sloth_Function Sloth_Tree_Walk_Result
 sloth_child_sum_width_layout_text(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_Widget_Layout l = widget->layout;
+  Sloth_Widget_Layout l = *sloth_widget_layout(sloth, widget);
   if (l.width.kind != Sloth_SizeKind_ChildrenSum) return Sloth_TreeWalk_Continue;
   if (l.height.kind != Sloth_SizeKind_TextContent) return Sloth_TreeWalk_Continue;
   
-  Sloth_R32 margin = sloth_size_evaluate_margin(widget, widget->layout.margin.left, Sloth_Axis_X);
-  margin += sloth_size_evaluate_margin(widget, widget->layout.margin.right, Sloth_Axis_X);
+  Sloth_R32 margin = sloth_size_evaluate_margin(sloth, widget, l.margin.left, Sloth_Axis_X);
+  margin += sloth_size_evaluate_margin(sloth, widget, l.margin.right, Sloth_Axis_X);
   
   Sloth_Rect text_bounds = SLOTH_ZII;
   text_bounds.value_max.x = Sloth_Max(0, widget->cached->dim.x - margin);
   text_bounds.value_max.y = Sloth_R32_Max;
-  widget->text_dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
+  sloth_widget_text(sloth, widget)->dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
   
   return Sloth_TreeWalk_Continue;
 }
@@ -3993,46 +7120,61 @@ Sloth_Function Sloth_Tree_Walk_Result
 sloth_known_size_layout_text(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  Sloth_Widget_Layout l = widget->layout;
+  Sloth_Widget_Layout l = *sloth_widget_layout(sloth, widget);
   Sloth_Size_Kind wk = l.width.kind;
   Sloth_Size_Kind hk = l.height.kind;
   if (wk == Sloth_SizeKind_TextContent || hk == Sloth_SizeKind_TextContent) return Sloth_TreeWalk_Continue;
   
-  Sloth_R32 margin_x = sloth_size_evaluate_margin(widget, widget->layout.margin.left, Sloth_Axis_X);
-  margin_x += sloth_size_evaluate_margin(widget, widget->layout.margin.right, Sloth_Axis_X);
+  Sloth_R32 margin_x = sloth_size_evaluate_margin(sloth, widget, l.margin.left, Sloth_Axis_X);
+  margin_x += sloth_size_evaluate_margin(sloth, widget, l.margin.right, Sloth_Axis_X);
   
-  Sloth_R32 margin_y = sloth_size_evaluate_margin(widget, widget->layout.margin.top, Sloth_Axis_Y);
-  margin_y += sloth_size_evaluate_margin(widget, widget->layout.margin.bottom, Sloth_Axis_Y);
+  Sloth_R32 margin_y = sloth_size_evaluate_margin(sloth, widget, l.margin.top, Sloth_Axis_Y);
+  margin_y += sloth_size_evaluate_margin(sloth, widget, l.margin.bottom, Sloth_Axis_Y);
   
   Sloth_Rect text_bounds = SLOTH_ZII;
   text_bounds.value_max.x = Sloth_Max(0, widget->cached->dim.x - margin_x);
   text_bounds.value_max.y = Sloth_Max(0, widget->cached->dim.y - margin_y);
   
-  widget->text_dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
+  sloth_widget_text(sloth, widget)->dim = sloth_layout_text_in_widget(sloth, widget, text_bounds);
   
   return Sloth_TreeWalk_Continue;
 }
 
-Sloth_Function Sloth_Tree_Walk_Result
-sloth_measure_children(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
+// Grows the parent's children_bounds to contain this widget
+Sloth_Function void
+sloth_measure_children_accumulate_(Sloth_Ctx* sloth, Sloth_Widget* widget)
 {
-  SLOTH_PROFILE_BEGIN;
-  if (!widget->parent) return Sloth_TreeWalk_Continue;
-  Sloth_V2 cb_min = widget->parent->cached->children_bounds_min;
-  Sloth_V2 cb_max = widget->parent->cached->children_bounds_max;  
+  Sloth_Widget* parent = sloth_widget_parent(sloth, widget);
+  Sloth_V2 cb_min = parent->cached->children_bounds_min;
+  Sloth_V2 cb_max = parent->cached->children_bounds_max;  
   Sloth_Widget_Cached* c = widget->cached;
   cb_min.x = Sloth_Min(c->offset.x,            cb_min.x);
   cb_min.y = Sloth_Min(c->offset.y,            cb_min.y);
   cb_max.x = Sloth_Max(c->offset.x + c->dim.x, cb_max.x);
   cb_max.y = Sloth_Max(c->offset.y + c->dim.y, cb_max.y);
-  widget->parent->cached->children_bounds_min = cb_min;
-  widget->parent->cached->children_bounds_max = cb_max;
-  
-  // Reset own children_bounds before evaluating children
+  parent->cached->children_bounds_min = cb_min;
+  parent->cached->children_bounds_max = cb_max;
+}
+
+Sloth_Function void
+sloth_measure_children_reset_(Sloth_Widget* widget)
+{
+  Sloth_Widget_Cached* c = widget->cached;
   c->children_bounds_min.x = Sloth_R32_Max;
   c->children_bounds_min.y = Sloth_R32_Max;
   c->children_bounds_max.x = Sloth_R32_Min;
   c->children_bounds_max.y = Sloth_R32_Min;
+}
+
+Sloth_Function Sloth_Tree_Walk_Result
+sloth_measure_children(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
+{
+  SLOTH_PROFILE_BEGIN;
+  if (!widget->parent) return Sloth_TreeWalk_Continue;
+  sloth_measure_children_accumulate_(sloth, widget);
+  
+  // Reset own children_bounds before evaluating children
+  sloth_measure_children_reset_(widget);
   
   return Sloth_TreeWalk_Continue;
 }
@@ -4040,27 +7182,109 @@ sloth_measure_children(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_da
 Sloth_Function Sloth_Tree_Walk_Result
 sloth_offset_and_clip_text(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 {  
+  Sloth_Widget_Text* text = sloth_widget_text(sloth, widget);
+  if (text->glyphs_len == 0 && !text->long_text) return Sloth_TreeWalk_Continue;
+  
+  Sloth_Size_Box margin = sloth_widget_layout(sloth, widget)->margin;
   Sloth_V2 offset = widget->cached->offset;
-  offset.x += sloth_size_evaluate_margin(widget, widget->layout.margin.left, Sloth_Axis_X);
-  offset.y += sloth_size_evaluate_margin(widget, widget->layout.margin.top,  Sloth_Axis_Y);
-  for (Sloth_U32 i = 0; i < widget->text_len; i++)
+  offset.x += sloth_size_evaluate_margin(sloth, widget, margin.left, Sloth_Axis_X);
+  offset.y += sloth_size_evaluate_margin(sloth, widget, margin.top,  Sloth_Axis_Y);
+  
+  // long text only gets glyphs once it is known which lines show
+  if (text->long_text) sloth_long_text_layout_visible_(sloth, widget, offset);
+  for (Sloth_U32 i = 0; i < text->glyphs_len; i++)
   {
     // offset
-    widget->text[i].bounds.value_min.x += offset.x;
-    widget->text[i].bounds.value_min.y += offset.y;
-    widget->text[i].bounds.value_max.x += offset.x;
-    widget->text[i].bounds.value_max.y += offset.y;
+    text->glyphs[i].bounds.value_min.x += offset.x;
+    text->glyphs[i].bounds.value_min.y += offset.y;
+    text->glyphs[i].bounds.value_max.x += offset.x;
+    text->glyphs[i].bounds.value_max.y += offset.y;
     
     // clip
-    if (sloth_render_clip_glyph_layout(sloth, widget->text + i, widget->cached->bounds))
+    if (sloth_render_clip_glyph_layout(sloth, text->glyphs + i, widget->cached->bounds))
     {
-      sloth_flags_add(widget->text[i].flags, Sloth_GlyphLayout_Draw);
+      sloth_flags_add(text->glyphs[i].flags, Sloth_GlyphLayout_Draw);
     }
   }
   
   return Sloth_TreeWalk_Continue;
 }
 
+// @FusedTreeWalkCB
+// The following callbacks each perform several of the passes above
+// in a single visit to each widget. Both axes are handled at once
+// wherever one axis doesn't depend on the other having been completed
+// for the entire tree. 
+// They must produce the same results as running each pass
+// separately (see SLOTH_LAYOUT_MULTI_PASS).
+
+// Preorder - everything that relies only on the widget itself
+// and its ancestors
+Sloth_Function Sloth_Tree_Walk_Result
+sloth_fused_size_from_parents_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Layout_Cache lc = SLOTH_ZII;
+  sloth_size_kind_text_contents_layout_text(sloth, widget, 0);
+  
+  lc.axis = Sloth_Axis_X; sloth_size_fixup_cb_fixed_size(sloth, widget, (Sloth_U8*)&lc);
+  lc.axis = Sloth_Axis_Y; sloth_size_fixup_cb_fixed_size(sloth, widget, (Sloth_U8*)&lc);
+  
+  lc.axis = Sloth_Axis_X; sloth_size_fixup_cb_percent_parent(sloth, widget, (Sloth_U8*)&lc);
+  sloth_percent_parent_width_layout_text(sloth, widget, 0);
+  lc.axis = Sloth_Axis_Y; sloth_size_fixup_cb_percent_parent(sloth, widget, (Sloth_U8*)&lc);
+  
+  // children will measure themselves into this during 
+  // sloth_fused_size_from_children_cb
+  if (widget->parent) sloth_measure_children_reset_(widget);
+  
+  return Sloth_TreeWalk_Continue;
+}
+
+// Postorder - everything that relies on the widget's children
+// By the time a widget is visited here, its size is final
+Sloth_Function Sloth_Tree_Walk_Result
+sloth_fused_size_from_children_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Layout_Cache lc = SLOTH_ZII;
+  lc.axis = Sloth_Axis_X; sloth_size_fixup_cb_children_sum(sloth, widget, (Sloth_U8*)&lc);
+  sloth_child_sum_width_layout_text(sloth, widget, 0);
+  lc.axis = Sloth_Axis_Y; sloth_size_fixup_cb_children_sum(sloth, widget, (Sloth_U8*)&lc);
+  
+  lc.axis = Sloth_Axis_X; sloth_size_fixup_cb_violations(sloth, widget, (Sloth_U8*)&lc);
+  lc.axis = Sloth_Axis_Y; sloth_size_fixup_cb_violations(sloth, widget, (Sloth_U8*)&lc);
+  
+  sloth_known_size_layout_text(sloth, widget, 0);
+  
+  if (widget->parent) sloth_measure_children_accumulate_(sloth, widget);
+  
+  return Sloth_TreeWalk_Continue;
+}
+
+// Preorder - final bounding boxes
+// NOTE: clipping can't be folded in here since children lay 
+// themselves out relative to their parent's unclipped bounds
+Sloth_Function Sloth_Tree_Walk_Result
+sloth_fused_layout_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
+{
+  SLOTH_PROFILE_BEGIN;
+  Sloth_Layout_Cache* lc = (Sloth_Layout_Cache*)user_data;
+  lc->axis = Sloth_Axis_X; sloth_layout_cb(sloth, widget, (Sloth_U8*)lc);
+  lc->axis = Sloth_Axis_Y; sloth_layout_cb(sloth, widget, (Sloth_U8*)lc);
+  return Sloth_TreeWalk_Continue;
+}
+
+// Preorder - clip widget bounds, then its text to those bounds
+Sloth_Function Sloth_Tree_Walk_Result
+sloth_fused_clip_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_clip_cb(sloth, widget, user_data);
+  sloth_offset_and_clip_text(sloth, widget, 0);
+  return Sloth_TreeWalk_Continue;
+}
+
 Sloth_Function void
 sloth_render_text_in_widget(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Rect text_bounds, Sloth_R32 z)
 {
@@ -4072,19 +7296,20 @@ sloth_render_text_in_widget(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_Rect t
   Sloth_U32 selection_line_start = 0;
   Sloth_Rect line_dim;
   Sloth_S32 selection_quad_v0 = -1;
-  Sloth_U8 text_vibuf_family = 0;
+  Sloth_U32 text_vibuf_atlas = 0;
   Sloth_VIBuffer* text_vibuf = 0;
   Sloth_VIBuffer* selection_vibuf = sloth->vibuffers + 0;
-  for (Sloth_U32 i = 0; i < widget->text_len; i++)
+  Sloth_Widget_Text* text = sloth_widget_text(sloth, widget);
+  for (Sloth_U32 i = 0; i < text->glyphs_len; i++)
   {
-    Sloth_Glyph_Layout gl = widget->text[i];
+    Sloth_Glyph_Layout gl = text->glyphs[i];
     if (!sloth_flags_has(gl.flags, Sloth_GlyphLayout_Draw)) continue;
     
     // Text Selection Rendering
-    if (text_vibuf_family != gl.glyph_id.family || text_vibuf == 0)
+    if (text_vibuf_atlas != gl.info.glyph.atlas_index || text_vibuf == 0)
     {
       text_vibuf = sloth_get_vibuffer_for_glyph(sloth, gl.glyph_id);
-      text_vibuf_family = gl.glyph_id.family;
+      text_vibuf_atlas = gl.info.glyph.atlas_index;
     }
     
     if (sloth_flags_has(gl.flags, Sloth_GlyphLayout_Selected)) 
@@ -4169,7 +7394,8 @@ Sloth_Function Sloth_Tree_Walk_Result
 sloth_render_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 {
   SLOTH_PROFILE_BEGIN;
-  if (widget->style.draw_flags == Sloth_Draw_None) return Sloth_TreeWalk_Continue_SkipChildren;
+  Sloth_Widget_Style* style = sloth_widget_style(sloth, widget);
+  if (style->draw_flags == Sloth_Draw_None) return Sloth_TreeWalk_Continue_SkipChildren;
   
   Sloth_Render_Ctx* rc = (Sloth_Render_Ctx*)user_data;
   
@@ -4186,7 +7412,7 @@ sloth_render_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
   rc->z_at            = Sloth_GetZOff(rc, Sloth_ZOff_Next);
   
   // Background
-  Sloth_Glyph_ID bg_id = widget->style.bg_glyph;
+  Sloth_Glyph_ID bg_id = style->bg_glyph;
   if (bg_id.value == 0) {
     sloth_zero_struct_(&bg_id);
     bg_id.id[0] = 1;
@@ -4196,17 +7422,17 @@ sloth_render_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
   Sloth_V2 bg_uv_max = bg_glyph.uv.value_max;  
   Sloth_VIBuffer* vibuf = sloth_get_vibuffer_for_glyph(sloth, bg_id);
   if (vibuf) {
-    sloth_render_quad_ptc(vibuf, bounds, z_bg, bg_uv_min, bg_uv_max, widget->style.color_bg);
+    sloth_render_quad_ptc(vibuf, bounds, z_bg, bg_uv_min, bg_uv_max, style->color_bg);
   }
   
   // Text
   sloth_render_text_in_widget(sloth, widget, widget->cached->bounds, z_text);
   
   // Outline
-  if (widget->style.outline_thickness > 0)
+  if (style->outline_thickness > 0)
   {
-    Sloth_R32 t = widget->style.outline_thickness;
-    Sloth_U32 c = widget->style.color_outline;
+    Sloth_R32 t = style->outline_thickness;
+    Sloth_U32 c = style->color_outline;
     
     vibuf = sloth_get_vibuffer_for_glyph(sloth, white_id);
     if (vibuf) {
@@ -4242,16 +7468,17 @@ sloth_render_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* user_data)
 Sloth_Function Sloth_Tree_Walk_Result
 sloth_find_hot_and_active(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* ud)
 {
-  if (sloth_flags_has(widget->input.flags, Sloth_WidgetInput_DoNotCaptureMouse)) return Sloth_TreeWalk_Continue;
+  if (sloth_flags_has(sloth_widget_input(sloth, widget)->flags, Sloth_WidgetInput_DoNotCaptureMouse)) return Sloth_TreeWalk_Continue;
   
   // Active
   if (sloth_mouse_button_is_down(sloth->mouse_button_l) &&
       sloth_rect_contains(widget->cached->bounds, sloth->mouse_down_pos))
   {
     sloth->active_widget = widget->id;
-    for (Sloth_U32 glyph_i = 0; glyph_i < widget->text_len; glyph_i++)
+    Sloth_Widget_Text* text = sloth_widget_text(sloth, widget);
+    for (Sloth_U32 glyph_i = 0; glyph_i < text->glyphs_len; glyph_i++)
     {
-      Sloth_Glyph_Layout g = widget->text[glyph_i];
+      Sloth_Glyph_Layout g = text->glyphs[glyph_i];
       if (sloth_rect_contains(g.bounds, sloth->mouse_down_pos)) {
         sloth->active_widget_selected_glyphs_first = glyph_i;
       }
@@ -4311,18 +7538,61 @@ sloth_frame_prepare(Sloth_Ctx* sloth, Sloth_Frame_Desc desc)
   
   sloth->hot_widget.value = 0;
   sloth->active_widget.value = 0;
+  SLOTH_PROFILE_PASS_BEGIN("find_hot_and_active");
   sloth_tree_walk_preorder(sloth, sloth_find_hot_and_active, 0);
+  SLOTH_PROFILE_PASS_END("find_hot_and_active");
+  
+  // Hand last frame's text to each id's cache before the widgets
+  // are reset. Its glyphs are in the arena that isn't cleared below
+  SLOTH_PROFILE_PASS_BEGIN("retain_text");
+  for (Sloth_U32 i = 1; i < sloth->widgets.len; i++)
+  {
+    Sloth_Widget* widget = sloth->widgets.values + i;
+    if (!widget->cached) continue;
+    widget->cached->text_last_frame = sloth->widgets.texts[i];
+    widget->cached->text_last_frame_index = sloth->frame_index;
+  }
+  SLOTH_PROFILE_PASS_END("retain_text");
+  
+  // Evict layouts and styles that no widget has used recently.
+  // Last frame's widgets are the only ones still around, and 
+  // they touched everything they use one frame ago
+  sloth->frame_index += 1;
+  SLOTH_PROFILE_PASS_BEGIN("evict_descriptors");
+  Sloth_U32 max_age = sloth->desc_evict_after_frames;
+  if (max_age == 0) max_age = SLOTH_DESC_EVICT_AFTER_FRAMES_DEFAULT;
+  if (max_age != SLOTH_DESC_PINNED)
+  {
+    sloth_desc_table_evict(&sloth->layouts, sloth->frame_index, max_age);
+    sloth_desc_table_evict(&sloth->styles, sloth->frame_index, max_age);
+  }
+  SLOTH_PROFILE_PASS_END("evict_descriptors");
+  
+  // Free the caches of ids that haven't been pushed recently,
+  // so transient ids don't hold onto memory forever
+  SLOTH_PROFILE_PASS_BEGIN("evict_widget_caches");
+  Sloth_U32 cache_max_age = sloth->widget_cache_evict_after_frames;
+  if (cache_max_age == 0) cache_max_age = SLOTH_WIDGET_CACHE_EVICT_AFTER_FRAMES_DEFAULT;
+  if (cache_max_age != SLOTH_DESC_PINNED)
+  {
+    sloth_widget_cached_pool_evict(sloth, cache_max_age);
+  }
+  SLOTH_PROFILE_PASS_END("evict_widget_caches");
   
-  // Fixup Tree
-  sloth->widget_tree_next_child = sloth->widget_tree_root;
+  // Reset Tree
   sloth->widget_tree_root = 0;
   sloth->widget_tree_parent_cur = 0;
+  sloth->widget_tree_child_last = 0;
+  sloth->id_scopes_len = 0;
   
   sloth->widgets.len = 0;
-  sloth->widgets.free_list = 0;
   
-  sloth_arena_clear(&sloth->per_frame_memory);
+  // frame_index has already moved on, so this is the arena
+  // frame_index - 2 used
+  SLOTH_PROFILE_PASS_BEGIN("clear_arenas");
+  sloth_arena_clear(sloth_frame_arena(sloth));
   sloth_arena_clear(&sloth->scratch);
+  SLOTH_PROFILE_PASS_END("clear_arenas");
   
   sloth->sentinel = SLOTH_DEBUG_DID_CALL_PREPARE;
 }
@@ -4342,6 +7612,13 @@ sloth_debug_validate_at_frame_advance_(Sloth_Ctx* sloth)
     printf("You forgot to close one of your open widgets. Widget tree in invalid state during sloth_frame_advance\n");
     sloth_invalid_code_path;
   }
+  
+  if (sloth->id_scopes_len != 0)
+  {
+    printf("\nSloth Error:\n");
+    printf("You forgot to pop one of your id scopes before sloth_frame_advance\n");
+    sloth_invalid_code_path;
+  }
 }
 
 // This is responsible for:
@@ -4356,18 +7633,37 @@ sloth_frame_advance(Sloth_Ctx* sloth)
   sloth_assert(sloth->sentinel == SLOTH_DEBUG_DID_CALL_PREPARE);
   sloth_debug_validate_at_frame_advance(sloth);
   
+  // popping the root is optional, so make sure its subtree
+  // covers everything that was pushed this frame
+  Sloth_Widget* root = sloth_widget_get(sloth, sloth->widget_tree_root);
+  if (root) root->subtree_size = sloth->widgets.len - sloth->widget_tree_root;
+  
   Sloth_Layout_Cache lc;
   
+  // Every glyph text needs has to be registered before any of it is
+  // laid out, and before the atlases are uploaded
+  SLOTH_PROFILE_PASS_BEGIN("register_glyphs");
+  sloth_font_register_requested_glyphs_(sloth);
+  SLOTH_PROFILE_PASS_END("register_glyphs");
+  
   // Update the atlas_texture if necessary
   Sloth_Glyph_Store store = sloth->glyph_store;
   Sloth_Renderer_Atlas_Updated* renderer_atlas_updated = sloth->renderer_atlas_updated;
+  SLOTH_PROFILE_PASS_BEGIN("atlas_updated");
   for (Sloth_U32 atlas_i = 0; atlas_i < sloth->glyph_atlases_cap; atlas_i++)
   {
     Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + atlas_i;
     if (atlas->dirty_state == Sloth_GlyphAtlas_Clean) continue;
-    renderer_atlas_updated(sloth, atlas_i);
+    if (atlas->dirty_state == Sloth_GlyphAtlas_Dirty_Grow)
+    {
+      atlas->dirty_rects[0] = (Sloth_Glyph_Atlas_Dirty_Rect){ 0, 0, atlas->dim, atlas->dim };
+      atlas->dirty_rects_len = 1;
+    }
+    renderer_atlas_updated(sloth, atlas_i, atlas->dirty_rects, atlas->dirty_rects_len);
     atlas->dirty_state = Sloth_GlyphAtlas_Clean;
+    atlas->dirty_rects_len = 0;
   }
+  SLOTH_PROFILE_PASS_END("atlas_updated");
   
   // TODO(PS): come back here and do better at cleaning breaking out
   // text related tasks
@@ -4375,68 +7671,169 @@ sloth_frame_advance(Sloth_Ctx* sloth)
   // - Shaping - treat it all as one line, figure out spacing
   // - Layout - line breaks, etc.
   
+#if SLOTH_LAYOUT_MULTI_PASS
   // Layout text for widgets that will rely on the size of their
   // text contents.
+  SLOTH_PROFILE_PASS_BEGIN("text_contents_layout_text");
   sloth_tree_walk_preorder(sloth, sloth_size_kind_text_contents_layout_text, 0);
+  SLOTH_PROFILE_PASS_END("text_contents_layout_text");
   
   // Update widget's cached sizes in the following ways:
   // 1. Preorder - Sloth_SizeKind_Pixels & Sloth_SizeKind_TextContent
   //    can be set outright, don't rely on other information
+  SLOTH_PROFILE_PASS_BEGIN("fixed_size");
   lc.axis = 0; sloth_tree_walk_preorder(sloth, sloth_size_fixup_cb_fixed_size, (Sloth_U8*)&lc);
   lc.axis = 1; sloth_tree_walk_preorder(sloth, sloth_size_fixup_cb_fixed_size, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("fixed_size");
   
   // 2. Preorder - Calculate sizes that rely on parents
+  SLOTH_PROFILE_PASS_BEGIN("percent_parent");
   lc.axis = 0; sloth_tree_walk_preorder(sloth, sloth_size_fixup_cb_percent_parent, (Sloth_U8*)&lc);
   sloth_tree_walk_preorder(sloth, sloth_percent_parent_width_layout_text, 0);
   lc.axis = 1; sloth_tree_walk_preorder(sloth, sloth_size_fixup_cb_percent_parent, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("percent_parent");
   
   // 3. Postorder - Calculate sizes that rely on size of children
+  SLOTH_PROFILE_PASS_BEGIN("children_sum");
   lc.axis = 0; sloth_tree_walk_postorder(sloth, sloth_size_fixup_cb_children_sum, (Sloth_U8*)&lc);
   sloth_tree_walk_preorder(sloth, sloth_child_sum_width_layout_text, 0);
   lc.axis = 1; sloth_tree_walk_postorder(sloth, sloth_size_fixup_cb_children_sum, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("children_sum");
   
   // 4. Preorder - Handle any unhandled cases, including ones that
   //    might not have a neat solution. 
+  SLOTH_PROFILE_PASS_BEGIN("violations");
   lc.axis = 0; sloth_tree_walk_preorder(sloth, sloth_size_fixup_cb_violations, (Sloth_U8*)&lc);
   lc.axis = 1; sloth_tree_walk_preorder(sloth, sloth_size_fixup_cb_violations, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("violations");
   
   // Pass: Final Text Layout
   // Layout text for widgets didn't previously layout their text
   // for sizing purposes. This procedure also clips text for all widgets
+  SLOTH_PROFILE_PASS_BEGIN("known_size_layout_text");
   sloth_tree_walk_preorder(sloth, sloth_known_size_layout_text, 0);
+  SLOTH_PROFILE_PASS_END("known_size_layout_text");
   
   // Pass: Measure Children
   // Before clipping, we want to know the total size of each nodes children
   // This information is used in offsetting in the case where the offset
   // is a percent of that total size (as opposed to a static pixel value)
+  SLOTH_PROFILE_PASS_BEGIN("measure_children");
   sloth_tree_walk_preorder(sloth, sloth_measure_children, 0);
+  SLOTH_PROFILE_PASS_END("measure_children");
   
   // Pass: Set final bounding boxes for all widgets (preorder)
+  SLOTH_PROFILE_PASS_BEGIN("layout");
   lc.axis = 0; 
   lc.last_sibling_end = 0;
   sloth_tree_walk_preorder(sloth, sloth_layout_cb, (Sloth_U8*)&lc);
   lc.axis = 1; 
   lc.last_sibling_end = 0;
   sloth_tree_walk_preorder(sloth, sloth_layout_cb, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("layout");
   
   // Pass: Clipping
+  SLOTH_PROFILE_PASS_BEGIN("clip");
   sloth_tree_walk_preorder(sloth, sloth_clip_cb, (Sloth_U8*)&lc);
   sloth_tree_walk_preorder(sloth, sloth_offset_and_clip_text, 0);
+  SLOTH_PROFILE_PASS_END("clip");
+  
+#else
+  
+  // Pass: Sizes that rely on the widget itself or its parents
+  SLOTH_PROFILE_PASS_BEGIN("size_from_parents");
+  sloth_tree_walk_preorder(sloth, sloth_fused_size_from_parents_cb, 0);
+  SLOTH_PROFILE_PASS_END("size_from_parents");
+  
+  // Pass: Sizes that rely on a widget's children, final text
+  // layout, and measuring children
+  SLOTH_PROFILE_PASS_BEGIN("size_from_children");
+  sloth_tree_walk_postorder(sloth, sloth_fused_size_from_children_cb, 0);
+  SLOTH_PROFILE_PASS_END("size_from_children");
+  
+  // Pass: Set final bounding boxes for all widgets
+  SLOTH_PROFILE_PASS_BEGIN("layout");
+  lc.last_sibling_end = 0;
+  sloth_tree_walk_preorder(sloth, sloth_fused_layout_cb, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("layout");
+  
+  // Pass: Clipping
+  SLOTH_PROFILE_PASS_BEGIN("clip");
+  sloth_tree_walk_preorder(sloth, sloth_fused_clip_cb, (Sloth_U8*)&lc);
+  SLOTH_PROFILE_PASS_END("clip");
+  
+#endif // SLOTH_LAYOUT_MULTI_PASS
   
   // Pass: Widgets -> Vertex Buffers
   // Each vertex buffer is associated with a texture. 
   Sloth_Render_Ctx rc = SLOTH_ZII;
   Sloth_R32 z_depth = sloth->z_depth_min - sloth->z_depth_max;
   Sloth_R32 z_step_dir = z_depth >= 0 ? 1 : -1; // sign(z_depth)
-  rc.z_step = z_depth / (Sloth_R32)(sloth->widgets.len * Sloth_ZOff_Next);
+  Sloth_U32 widgets_count = root ? root->subtree_size : 0;
+  rc.z_step = z_depth / (Sloth_R32)(widgets_count * Sloth_ZOff_Next);
   rc.z_at = sloth->z_depth_max;
+  SLOTH_PROFILE_PASS_BEGIN("render");
   sloth_tree_walk_preorder(sloth, sloth_render_cb, (Sloth_U8*)&rc);
+  SLOTH_PROFILE_PASS_END("render");
   
   sloth->sentinel = SLOTH_DEBUG_DID_CALL_ADVANCE;
 }
 
+#if SLOTH_VERTEX_PACKED
+
+// color is 0xRRGGBBAA, and is stored r first
+Sloth_Function Sloth_Vertex_Color
+sloth_vertex_color(Sloth_U32 color)
+{
+  Sloth_U8 bytes[4];
+  bytes[0] = (color >> 24) & 0xFF;
+  bytes[1] = (color >> 16) & 0xFF;
+  bytes[2] = (color >>  8) & 0xFF;
+  bytes[3] = (color >>  0) & 0xFF;
+  Sloth_Vertex_Color result;
+  sloth_copy_memory(&result, bytes, sizeof(result));
+  return result;
+}
+
+Sloth_Function Sloth_U16
+sloth_vertex_unorm16_(Sloth_R32 v)
+{
+  v = Sloth_Clamp(0.0f, v, 1.0f);
+  return (Sloth_U16)((v * 65535.0f) + 0.5f);
+}
+
+Sloth_Function void
+sloth_vibuffer_set_vert(Sloth_VIBuffer* buf, Sloth_U32 vert_index, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_Vertex_Color c)
+{
+  Sloth_U32 vi = vert_index * SLOTH_VERTEX_STRIDE;
+  buf->verts[vi++] = x;
+  buf->verts[vi++] = y;
+  buf->verts[vi++] = z;
+  
+  // uv and color are copied in rather than written through casts,
+  // since verts is Sloth_R32 storage
+  Sloth_U16 uv[2];
+  uv[0] = sloth_vertex_unorm16_(u);
+  uv[1] = sloth_vertex_unorm16_(v);
+  sloth_copy_memory(buf->verts + vi++, uv, sizeof(uv));
+  sloth_copy_memory(buf->verts + vi++, &c, sizeof(c));
+}
+
+#else
+
+Sloth_Function Sloth_Vertex_Color
+sloth_vertex_color(Sloth_U32 color)
+{
+  Sloth_V4 result;
+  result.r = (Sloth_R32)((color >> 24) & 0xFF) / 255.0f;
+  result.g = (Sloth_R32)((color >> 16) & 0xFF) / 255.0f;
+  result.b = (Sloth_R32)((color >>  8) & 0xFF) / 255.0f;
+  result.a = (Sloth_R32)((color >>  0) & 0xFF) / 255.0f;
+  return result;
+}
+
 Sloth_Function void
-sloth_vibuffer_set_vert(Sloth_VIBuffer* buf, Sloth_U32 vert_index, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_V4 c)
+sloth_vibuffer_set_vert(Sloth_VIBuffer* buf, Sloth_U32 vert_index, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_Vertex_Color c)
 {
   Sloth_U32 vi = vert_index * SLOTH_VERTEX_STRIDE;
   buf->verts[vi++] = x;
@@ -4450,10 +7847,34 @@ sloth_vibuffer_set_vert(Sloth_VIBuffer* buf, Sloth_U32 vert_index, Sloth_R32 x,
   buf->verts[vi++] = c.w;
 }
 
+#endif // SLOTH_VERTEX_PACKED
+
+Sloth_Function void
+sloth_vibuffer_reserve_verts(Sloth_VIBuffer* buf, Sloth_U32 count)
+{
+  SLOTH_PROFILE_BEGIN;
+  sloth_assert(count <= SLOTH_VIBUFFER_BATCH_VERTS);
+  Sloth_U32 verts_count = buf->verts_len / SLOTH_VERTEX_STRIDE;
+  if (buf->batches_len > 0) {
+    Sloth_VIBuffer_Batch* batch = buf->batches + (buf->batches_len - 1);
+    if ((verts_count + count) - batch->first_vert <= SLOTH_VIBUFFER_BATCH_VERTS) return;
+  }
+  
+  buf->batches = sloth_array_grow(buf->batches,
+    buf->batches_len,
+    &buf->batches_cap,
+    4,
+    Sloth_VIBuffer_Batch);
+  Sloth_VIBuffer_Batch* batch = buf->batches + buf->batches_len++;
+  batch->first_vert = verts_count;
+  batch->first_index = buf->indices_len;
+}
+
 Sloth_Function Sloth_U32 
-sloth_vibuffer_push_vert(Sloth_VIBuffer* buf, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_V4 c)
+sloth_vibuffer_push_vert(Sloth_VIBuffer* buf, Sloth_R32 x, Sloth_R32 y, Sloth_R32 z, Sloth_R32 u, Sloth_R32 v, Sloth_Vertex_Color c)
 {
   SLOTH_PROFILE_BEGIN;
+  sloth_vibuffer_reserve_verts(buf, 1);
   buf->verts = sloth_array_grow(buf->verts,
     buf->verts_len,
     &buf->verts_cap,
@@ -4478,13 +7899,21 @@ sloth_vibuffer_push_tri(Sloth_VIBuffer* buf, Sloth_U32 a, Sloth_U32 b, Sloth_U32
     buf->indices_len,
     &buf->indices_cap,
     3 * (256 / 4),
-    Sloth_U32
+    Sloth_U16
   );
   sloth_assert((buf->indices_len % 3) == 0);
+  
+  // Triangles can only reference verts in the current batch
+  sloth_assert(buf->batches_len > 0);
+  Sloth_U32 first_vert = buf->batches[buf->batches_len - 1].first_vert;
+  sloth_assert(a >= first_vert && (a - first_vert) < SLOTH_VIBUFFER_BATCH_VERTS);
+  sloth_assert(b >= first_vert && (b - first_vert) < SLOTH_VIBUFFER_BATCH_VERTS);
+  sloth_assert(c >= first_vert && (c - first_vert) < SLOTH_VIBUFFER_BATCH_VERTS);
+  
   Sloth_U32 tri_index = buf->indices_len / 3;
-  buf->indices[buf->indices_len++] = a;
-  buf->indices[buf->indices_len++] = b;
-  buf->indices[buf->indices_len++] = c;
+  buf->indices[buf->indices_len++] = (Sloth_U16)(a - first_vert);
+  buf->indices[buf->indices_len++] = (Sloth_U16)(b - first_vert);
+  buf->indices[buf->indices_len++] = (Sloth_U16)(c - first_vert);
   sloth_assert((buf->indices_len % 3) == 0);
   return tri_index;
 }
@@ -4502,6 +7931,19 @@ sloth_vibuffer_reset(Sloth_VIBuffer* buf)
 {
   buf->verts_len = 0;
   buf->indices_len = 0;
+  buf->batches_len = 0;
+}
+
+Sloth_Function Sloth_U32
+sloth_vibuffer_batch_indices_len(Sloth_VIBuffer* buf, Sloth_U32 batch_index)
+{
+  sloth_assert(batch_index < buf->batches_len);
+  Sloth_U32 first_index = buf->batches[batch_index].first_index;
+  Sloth_U32 one_past_last_index = buf->indices_len;
+  if (batch_index + 1 < buf->batches_len) {
+    one_past_last_index = buf->batches[batch_index + 1].first_index;
+  }
+  return one_past_last_index - first_index;
 }
 
 Sloth_Function void
@@ -4510,7 +7952,8 @@ sloth_vibuffer_free(Sloth_VIBuffer* buf)
   SLOTH_PROFILE_BEGIN;
   Sloth_U8* unused;
   unused = (Sloth_U8*)sloth_realloc_array(buf->verts, Sloth_R32, buf->verts_cap, 0);
-  unused = (Sloth_U8*)sloth_realloc_array(buf->indices, Sloth_U32, buf->indices_cap, 0);
+  unused = (Sloth_U8*)sloth_realloc_array(buf->indices, Sloth_U16, buf->indices_cap, 0);
+  unused = (Sloth_U8*)sloth_realloc_array(buf->batches, Sloth_VIBuffer_Batch, buf->batches_cap, 0);
 }
 
 Sloth_Function void
@@ -4518,8 +7961,15 @@ sloth_ctx_free(Sloth_Ctx* sloth)
 {
   SLOTH_PROFILE_BEGIN;
   sloth_widget_pool_free(&sloth->widgets);
-  sloth_arena_free(&sloth->per_frame_memory);
+  sloth_widget_cached_pool_free(&sloth->widget_caches);
+  sloth_hashtable_free(&sloth->widget_cache_lut);
+  sloth_desc_table_free(&sloth->layouts);
+  sloth_desc_table_free(&sloth->styles);
+  sloth_arena_free(sloth->per_frame_memory + 0);
+  sloth_arena_free(sloth->per_frame_memory + 1);
   sloth_arena_free(&sloth->scratch);
+  sloth->glyph_requests = sloth_realloc_array(sloth->glyph_requests, Sloth_Glyph_Request, sloth->glyph_requests_cap, 0);
+  sloth_hashtable_free(&sloth->glyph_requests_lut);
   
   for (Sloth_U32 vibuf_i = 0; vibuf_i < sloth->glyph_atlases_cap; vibuf_i++)
   {
@@ -4530,6 +7980,7 @@ sloth_ctx_free(Sloth_Ctx* sloth)
   {
     Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + atlas_i;
     Sloth_U8* unused = sloth_realloc(atlas->data, atlas->dim * atlas->dim, 0);
+    atlas->skyline = sloth_realloc_array(atlas->skyline, Sloth_Skyline_Node, atlas->skyline_cap, 0);
   }
   
 }
@@ -4540,6 +7991,14 @@ sloth_frame_render(Sloth_Ctx* sloth)
   Sloth_Renderer_Render* cb = sloth->renderer_render;
   if (!cb) return;
   
+#if SLOTH_ATLAS_MERGED
+  // every quad is in vibuffers[0]
+  if (sloth->glyph_atlases_merged)
+  {
+    if (sloth->glyph_atlases_cap > 0) cb(sloth, 0);
+    return;
+  }
+#endif
   for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++)
   {
     cb(sloth, i);
@@ -4579,7 +8038,7 @@ sloth_widget_tree_print_cb(Sloth_Ctx* sloth, Sloth_Widget* widget, Sloth_U8* use
     d->indent * 2, "                                                ",
     widget->str);
   
-  if (widget->child_first) {
+  if (sloth_widget_child_first(sloth, widget)) {
     d->indent += 1;
   } else if (!widget->sibling_next) {
     d->indent -= 1;
@@ -4708,8 +8167,7 @@ sloth_cmp_space_axis(Sloth_Ctx* sloth, Sloth_Size size, Sloth_U32 on_axis)
   // The id for this widget is constructed using the id of its
   // previous sibling. Since that widget should have had a unique
   // id, that will make this spacer unique
-  Sloth_Widget* parent = sloth->widget_tree_parent_cur;
-  Sloth_Widget* sibling_last = parent->child_last;
+  Sloth_Widget* sibling_last = sloth_widget_get(sloth, sloth->widget_tree_child_last);
   
   Sloth_Widget_Result r = sloth_push_widget_f(sloth, desc, "##VSpaceAfter%u", sibling_last->id.value);
   sloth_pop_widget_safe(sloth, r);
@@ -4736,18 +8194,21 @@ sloth_cmp_button_vd(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* fmt, va_list
   Sloth_Widget_Result wr = sloth_push_widget_v(sloth, desc, fmt, args);
   sloth_pop_widget(sloth);
   
-  if (sloth_ids_equal(sloth->hot_widget, wr.widget->id))
+  Sloth_Widget_Style style = *sloth_widget_style(sloth, wr.widget);
+  Sloth_Bool is_hot = sloth_ids_equal(sloth->hot_widget, wr.widget->id);
+  if (is_hot)
   {
-    wr.widget->style.color_outline = 0xFFFFFFFF;
+    style.color_outline = 0xFFFFFFFF;
   }
   
   Sloth_Bool result = wr.clicked;
   if (result) 
   {
-    Sloth_U32 new_color_text = wr.widget->style.color_bg;
-    wr.widget->style.color_bg   = wr.widget->style.color_text;
-    wr.widget->style.color_text = new_color_text;
+    Sloth_U32 new_color_text = style.color_bg;
+    style.color_bg   = style.color_text;
+    style.color_text = new_color_text;
   }
+  if (is_hot || result) sloth_widget_style_set(sloth, wr.widget, style);
   return result;
 }
 
@@ -4821,7 +8282,9 @@ sloth_cmp_toggle_v(Sloth_Ctx* sloth, Sloth_Bool state, Sloth_U32 color_bg, Sloth
   
   if (sloth_ids_equal(sloth->hot_widget, wr.widget->id))
   {
-    wr.widget->style.color_outline = 0xFFFFFFFF;
+    Sloth_Widget_Style style = *sloth_widget_style(sloth, wr.widget);
+    style.color_outline = 0xFFFFFFFF;
+    sloth_widget_style_set(sloth, wr.widget, style);
   }
   
   Sloth_Bool result = wr.clicked ? !state : state;
@@ -4856,6 +8319,7 @@ sloth_cmp_slider_v(Sloth_Ctx* sloth,
 {
   // Slider ID
   Sloth_ID_Result idr = sloth_make_id_v(&sloth->scratch, fmt, args);
+  idr.id = sloth_id_scoped(sloth, idr.id);
   
   // @: Get the appropriate value if it exists, using value otherwise  
   Sloth_V2* value_cached = sloth_persistent_value_get(sloth, idr.id, Sloth_V2, &value);
@@ -4878,8 +8342,8 @@ sloth_cmp_slider_v(Sloth_Ctx* sloth,
   desc.input.flags |= Sloth_WidgetInput_Draggable;
   
   result.widget_result = sloth_push_widget_id(sloth, desc, idr.id);
-  sloth_widget_allocate_text(sloth, result.widget_result, idr.display_len);
-  sloth_widget_text_to_glyphs_append(sloth, result.widget_result, result.widget_result.widget->style.font, idr.formatted, idr.display_len);
+  sloth_widget_allocate_text(sloth, result.widget_result, sloth_utf8_glyph_count(idr.formatted, idr.display_len));
+  sloth_widget_text_to_glyphs_append(sloth, result.widget_result, sloth_widget_style(sloth, result.widget_result.widget)->font, idr.formatted, idr.display_len);
   sloth_pop_widget(sloth);
   
   // NOTE(PS): These values are meaningless except when the widget
@@ -4909,7 +8373,9 @@ sloth_cmp_slider_v(Sloth_Ctx* sloth,
   // If the widget is being dragged, draw a new widget at the drag position
   if (result.widget_result.held) 
   {
-    result.widget_result.widget->style.draw_flags = Sloth_Draw_None;
+    Sloth_Widget_Style hidden_style = *sloth_widget_style(sloth, result.widget_result.widget);
+    hidden_style.draw_flags = Sloth_Draw_None;
+    sloth_widget_style_set(sloth, result.widget_result.widget, hidden_style);
     
     Sloth_Layout_Position drag_position = desc.layout.position;
     drag_position.at.E[Sloth_Axis_X].E[x_root] = SLOTH_SIZE_PERCENT_OF_PARENT(pct_x1);
@@ -4935,7 +8401,9 @@ sloth_cmp_slider_v(Sloth_Ctx* sloth,
     // Update the handle so it doesn't jump
     position.at.E[Sloth_Axis_X].E[x_root] = SLOTH_SIZE_PERCENT_OF_PARENT(pct_x1);
     position.at.E[Sloth_Axis_Y].E[y_root] = SLOTH_SIZE_PERCENT_OF_PARENT(pct_y1);
-    result.widget_result.widget->layout.position = position;
+    Sloth_Widget_Layout handle_layout = *sloth_widget_layout(sloth, result.widget_result.widget);
+    handle_layout.position = position;
+    sloth_widget_layout_set(sloth, result.widget_result.widget, handle_layout);
   }
   
   return result;
@@ -5129,8 +8597,11 @@ sloth_cmp_push_scroll_area_f(Sloth_Ctx* sloth, Sloth_Widget_Desc desc, char* fmt
 Sloth_Function void
 sloth_cmp_pop_scroll_area(Sloth_Ctx* sloth, Sloth_Widget_Result* result)
 {
-  Sloth_ID id = result->widget->id;
-  Sloth_Widget* content_container = result->widget->child_first->child_first;
+  // NOTE: result->widget may have moved since it was pushed
+  Sloth_Widget* scroll_area = sloth_widget_get(sloth, result->widget_index);
+  Sloth_ID id = scroll_area->id;
+  Sloth_Widget* y_scroll_area = sloth_widget_child_first(sloth, scroll_area);
+  Sloth_Widget* content_container = sloth_widget_child_first(sloth, y_scroll_area);
   Sloth_ID content_container_id = content_container->id;
   Sloth_Widget_Cached* cached = sloth_get_cached_data_for_id(sloth, content_container_id);
   sloth_pop_widget(sloth); // content container
@@ -5191,8 +8662,11 @@ sloth_stbtt_font_init(Sloth_Ctx* sloth, Sloth_Font* font, Sloth_U8* font_memory,
   return (Sloth_U8*)result;
 }
 
-Sloth_Function Sloth_Glyph_ID
-sloth_stbtt_register_glyph(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint)
+// Renders codepoint into a bitmap that gd->data points to, which
+// must be freed with stbtt_FreeBitmap. Only reads the font, so 
+// several glyphs can be rasterized at once
+Sloth_Function void
+sloth_stbtt_rasterize_glyph_(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint, Sloth_Glyph_Desc* gd_out)
 {
   Sloth_Font* font = sloth_font_get_(sloth, font_id);
   Sloth_Stbtt_Font* stb_font = (Sloth_Stbtt_Font*)font->renderer_data;
@@ -5232,22 +8706,65 @@ sloth_stbtt_register_glyph(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 co
   gd.cursor_to_glyph_start_xoff = stb_font->scale * (Sloth_R32)lsb;
   gd.cursor_to_next_glyph = stb_font->scale * (Sloth_R32)advance;
   gd.baseline_offset_y = y0;
-  
+  *gd_out = gd;
+}
+
+Sloth_Function Sloth_Glyph_ID
+sloth_stbtt_register_glyph(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint)
+{
+  Sloth_Glyph_Desc gd;
+  sloth_stbtt_rasterize_glyph_(sloth, font_id, codepoint, &gd);
   Sloth_Glyph_ID result = sloth_register_glyph(sloth, gd);
   
   // TODO(PS): It might be better if we don't free the bitmap each time
   // but use a persistent backbuffer that gets saved in something like
   // a Sloth_Stbtt_Ctx thing?
-  stbtt_FreeBitmap(bitmap, 0);
+  stbtt_FreeBitmap(gd.data, 0);
   
   return result;
 }
 
+typedef struct Sloth_Stbtt_Batch_ Sloth_Stbtt_Batch_;
+struct Sloth_Stbtt_Batch_
+{
+  Sloth_Glyph_Request* requests;
+  Sloth_Glyph_Desc* descs;
+};
+
+Sloth_Function void
+sloth_stbtt_rasterize_job_(Sloth_Ctx* sloth, Sloth_U32 index, Sloth_U8* user_data)
+{
+  Sloth_Stbtt_Batch_* batch = (Sloth_Stbtt_Batch_*)user_data;
+  Sloth_Glyph_Request r = batch->requests[index];
+  sloth_stbtt_rasterize_glyph_(sloth, r.font, r.codepoint, batch->descs + index);
+}
+
+// Rasterizing is the slow part, and each glyph is independent, so
+// the whole batch is rasterized (in parallel, given 
+// sloth->parallel_for) before any of it is copied into an atlas
+Sloth_Function void
+sloth_stbtt_register_glyphs(Sloth_Ctx* sloth, Sloth_Glyph_Request* requests, Sloth_U32 requests_len)
+{
+  Sloth_Arena_Loc scratch_at = sloth_arena_at(&sloth->scratch);
+  Sloth_Stbtt_Batch_ batch;
+  batch.requests = requests;
+  batch.descs = sloth_arena_push_array(&sloth->scratch, Sloth_Glyph_Desc, requests_len);
+  sloth_parallel_for_(sloth, requests_len, sloth_stbtt_rasterize_job_, (Sloth_U8*)&batch);
+  
+  for (Sloth_U32 i = 0; i < requests_len; i++)
+  {
+    sloth_register_glyph(sloth, batch.descs[i]);
+    stbtt_FreeBitmap(batch.descs[i].data, 0);
+  }
+  sloth_arena_pop(&sloth->scratch, scratch_at);
+}
+
 Sloth_Function void
 sloth_stbtt_init(Sloth_Ctx* sloth)
 {
   sloth->font_renderer_load_font = sloth_stbtt_font_init;
   sloth->font_renderer_register_glyph = sloth_stbtt_register_glyph;
+  sloth->font_renderer_register_glyphs = sloth_stbtt_register_glyphs;
 }
 
 #endif // SLOTH_STBTT_ATLAS
@@ -5386,6 +8903,15 @@ struct Sloth_Sokol_Data
   
   sg_pass_action pass_action;
   sg_pipeline pip;
+  
+#if SLOTH_ATLAS_MERGED
+  // The merged texture's pixels. Atlases are copied into their tiles 
+  // as they change, and the whole texture is uploaded once at render
+  // since sg_update_image can only be called once per frame
+  Sloth_U8* merged_data;
+  Sloth_U32 merged_dim;
+  Sloth_Bool merged_dirty;
+#endif
 };
 
 Sloth_Function Sloth_U32
@@ -5410,7 +8936,7 @@ sloth_render_sokol_buffers_create(Sloth_Sokol_Data* sd, sg_bindings* pass_bind,
   sg_buffer_desc ibd = SLOTH_ZII;
   ibd.usage = SG_USAGE_STREAM;
   ibd.type = SG_BUFFERTYPE_INDEXBUFFER;
-  ibd.data.size = quads * 6 * sizeof(Sloth_U32);
+  ibd.data.size = quads * 6 * sizeof(Sloth_U16);
   ibd.label = "sloth sokol indices";
   
   pass_bind->vertex_buffers[0] = sg_make_buffer(&vbd);
@@ -5419,20 +8945,125 @@ sloth_render_sokol_buffers_create(Sloth_Sokol_Data* sd, sg_bindings* pass_bind,
   return quads;
 }
 
+#if SLOTH_ATLAS_MERGED
+
+Sloth_Function void
+sloth_renderer_sokol_merged_copy_rect_(Sloth_Ctx* sloth, Sloth_Sokol_Data* sd, Sloth_Glyph_Atlas* atlas, Sloth_Glyph_Atlas_Dirty_Rect rect)
+{
+  Sloth_U32 tile_x, tile_y;
+  sloth_glyph_atlas_merged_origin_(sloth, atlas, &tile_x, &tile_y);
+  Sloth_U32 row_size = rect.width * sizeof(Sloth_U32);
+  for (Sloth_U32 y = rect.y; y < rect.y + rect.height; y++)
+  {
+    Sloth_U32 src = sloth_xy_to_texture_offset_u32(rect.x, y, atlas->dim);
+    Sloth_U32 dst = sloth_xy_to_texture_offset_u32(tile_x + rect.x, tile_y + y, sd->merged_dim);
+    sloth_copy_memory(sd->merged_data + dst, atlas->data + src, row_size);
+  }
+}
+
+Sloth_Function void
+sloth_renderer_sokol_merged_copy_atlas_(Sloth_Ctx* sloth, Sloth_Sokol_Data* sd, Sloth_Glyph_Atlas* atlas)
+{
+  Sloth_Glyph_Atlas_Dirty_Rect all = { 0, 0, atlas->dim, atlas->dim };
+  sloth_renderer_sokol_merged_copy_rect_(sloth, sd, atlas, all);
+}
+
+Sloth_Function void
+sloth_renderer_sokol_merged_atlas_updated_(Sloth_Ctx* sloth, Sloth_Sokol_Data* sd, Sloth_U32 atlas_index, Sloth_Glyph_Atlas_Dirty_Rect* rects, Sloth_U32 rects_len)
+{
+  Sloth_Sokol_Pass* pass = sd->passes + 0;
+  sg_bindings* pass_bind = &pass->bind;
+  
+  // A new atlas or a grown one can change the layout of every tile,
+  // so the merged texture is rebuilt from all of them
+  Sloth_U32 merged_dim = sloth->glyph_atlases_merged_dim;
+  if (sd->merged_data == 0 || sd->merged_dim != merged_dim)
+  {
+    Sloth_U64 old_size = (Sloth_U64)sd->merged_dim * sd->merged_dim * sizeof(Sloth_U32);
+    Sloth_U64 new_size = (Sloth_U64)merged_dim * merged_dim * sizeof(Sloth_U32);
+    sloth_assert(new_size <= 0xFFFFFFFF);
+    sd->merged_data = sloth_realloc(sd->merged_data, (Sloth_U32)old_size, (Sloth_U32)new_size);
+    sloth_zero_size__((Sloth_U32)new_size, sd->merged_data);
+    sd->merged_dim = merged_dim;
+    
+    sg_image_desc merged_texture_desc = {
+      .width  = merged_dim,
+      .height = merged_dim,
+      .usage = SG_USAGE_DYNAMIC,
+      .min_filter = SG_FILTER_NEAREST,
+      .mag_filter = SG_FILTER_NEAREST,
+      .label = "sloth merged atlas texture",
+    };
+    sg_image old_texture = pass_bind->fs_images[SLOT_tex];
+    if (old_texture.id != 0) sg_destroy_image(old_texture);
+    pass_bind->fs_images[SLOT_tex] = sg_make_image(&merged_texture_desc);
+    
+    for (Sloth_U32 i = 0; i < sloth->glyph_atlases_cap; i++)
+    {
+      Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + i;
+      if (atlas->data) sloth_renderer_sokol_merged_copy_atlas_(sloth, sd, atlas);
+    }
+  }
+  else
+  {
+    Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + atlas_index;
+    for (Sloth_U32 i = 0; i < rects_len; i++) {
+      sloth_renderer_sokol_merged_copy_rect_(sloth, sd, atlas, rects[i]);
+    }
+  }
+  sd->merged_dirty = true;
+}
+
+// Once the merged texture would be too big, atlases go back to
+// being drawn from their own textures
+Sloth_Function void
+sloth_renderer_sokol_merged_free_(Sloth_Sokol_Data* sd)
+{
+  if (!sd->merged_data) return;
+  Sloth_U64 size = (Sloth_U64)sd->merged_dim * sd->merged_dim * sizeof(Sloth_U32);
+  sloth_free((void*)sd->merged_data, (Sloth_U32)size);
+  sd->merged_data = 0;
+  sd->merged_dim = 0;
+  sd->merged_dirty = false;
+}
+
+#endif // SLOTH_ATLAS_MERGED
+
 Sloth_Function void
-sloth_renderer_sokol_atlas_updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index)
+sloth_renderer_sokol_atlas_updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index, Sloth_Glyph_Atlas_Dirty_Rect* rects, Sloth_U32 rects_len)
 {
   Sloth_Sokol_Data* sd = (Sloth_Sokol_Data*)sloth->render_data;
   sloth_assert(sd != 0);
   
   // Resize texture array if needed
+  Sloth_U32 pass_index = atlas_index;
+#if SLOTH_ATLAS_MERGED
+  // every atlas is drawn from pass 0
+  if (sloth->glyph_atlases_merged) pass_index = 0;
+#endif
   Sloth_U32 passes_before = sd->passes_cap;
-  sd->passes = sloth_array_grow(sd->passes, atlas_index, &sd->passes_cap, SLOTH_GLYPH_ATLASES_MIN_CAP, Sloth_Sokol_Pass);
+  while (pass_index >= sd->passes_cap) {
+    sd->passes = sloth_array_grow(sd->passes, sd->passes_cap, &sd->passes_cap, SLOTH_GLYPH_ATLASES_MIN_CAP, Sloth_Sokol_Pass);
+  }
   for (Sloth_U32 i = passes_before; i < sd->passes_cap; i++) {
     sloth_zero_struct_(&sd->passes[i]);
-    sloth_render_sokol_buffers_create(sd, &sd->passes[i].bind, 1024);
   }
   
+  // Only passes with an atlas get buffers, since pages are stored 
+  // well past the last family's atlas
+  if (sd->passes[pass_index].quad_cap == 0) {
+    sd->passes[pass_index].quad_cap = sloth_render_sokol_buffers_create(sd, &sd->passes[pass_index].bind, 1024);
+  }
+  
+#if SLOTH_ATLAS_MERGED
+  if (sloth->glyph_atlases_merged)
+  {
+    sloth_renderer_sokol_merged_atlas_updated_(sloth, sd, atlas_index, rects, rects_len);
+    return;
+  }
+  sloth_renderer_sokol_merged_free_(sd);
+#endif
+  
   Sloth_Glyph_Store store = sloth->glyph_store;
   Sloth_Glyph_Atlas* atlas = sloth->glyph_atlases + atlas_index;
   Sloth_U32 atlas_dim = atlas->dim;
@@ -5463,7 +9094,8 @@ sloth_renderer_sokol_atlas_updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index)
   
   if (atlas->dirty_state == Sloth_GlyphAtlas_Dirty_UpdateData)
   {
-    // update the data of the existing texture since the new data still fits
+    // update the data of the existing texture since the new data still fits.
+    // sokol_gfx can only replace a whole image, so rects aren't used here
     sg_image_data data = SLOTH_ZII;
     data.subimage[0][0].ptr = (const char*)atlas->data;
     data.subimage[0][0].size = atlas_dim * atlas_dim * sizeof(Sloth_U32);
@@ -5519,6 +9151,17 @@ sloth_render_sokol_(Sloth_Ctx* sloth, Sloth_U32 pass_index, Sloth_U32 width, Slo
   Sloth_Sokol_Pass* pass = sd->passes + pass_index;
   sg_bindings* pass_bind = &pass->bind;
   
+#if SLOTH_ATLAS_MERGED
+  if (sloth->glyph_atlases_merged && sd->merged_dirty)
+  {
+    sg_image_data data = SLOTH_ZII;
+    data.subimage[0][0].ptr = (const char*)sd->merged_data;
+    data.subimage[0][0].size = (size_t)sd->merged_dim * sd->merged_dim * sizeof(Sloth_U32);
+    sg_update_image(pass_bind->fs_images[SLOT_tex], &data);
+    sd->merged_dirty = false;
+  }
+#endif
+  
   // Update the bindings
   if (vibuf->verts_len > pass->quad_cap * 4) {
     Sloth_U32 new_cap = pass->quad_cap * 2;
@@ -5533,14 +9176,13 @@ sloth_render_sokol_(Sloth_Ctx* sloth, Sloth_U32 pass_index, Sloth_U32 width, Slo
   
   sg_range index_range;
   index_range.ptr = (const void*)vibuf->indices;
-  index_range.size = vibuf->indices_len * sizeof(Sloth_U32);
+  index_range.size = vibuf->indices_len * sizeof(Sloth_U16);
   sg_update_buffer(pass_bind->index_buffer, (const sg_range*)&index_range);
   
   // Draw the Frame
   if (vibuf->indices_len > 0)
   {
     sg_apply_pipeline(sd->pip);
-    sg_apply_bindings(pass_bind);
     
     // Calculate Orthographic Projection Matrix
     Sloth_R32 left = 0;
@@ -5558,11 +9200,22 @@ sloth_render_sokol_(Sloth_Ctx* sloth, Sloth_U32 pass_index, Sloth_U32 width, Slo
     sloth_viz_vs_params2.mvp[3][2] = (far + near) / (near - far);
     sloth_viz_vs_params2.mvp[3][3] = 1;
     
-    sg_apply_uniforms(SG_SHADERSTAGE_VS, 
-      SLOT_sloth_viz_vs_params, 
-      &SG_RANGE(sloth_viz_vs_params2));
-    
-    sg_draw(0, vibuf->indices_len, 1);
+    // One draw per batch, with the vertex buffer bound at the
+    // batch's first vert so its u16 indices address it directly
+    for (Sloth_U32 batch_i = 0; batch_i < vibuf->batches_len; batch_i++)
+    {
+      Sloth_VIBuffer_Batch batch = vibuf->batches[batch_i];
+      Sloth_U32 batch_indices_len = sloth_vibuffer_batch_indices_len(vibuf, batch_i);
+      if (batch_indices_len == 0) continue;
+      
+      pass_bind->vertex_buffer_offsets[0] = (int)(batch.first_vert * SLOTH_VERTEX_STRIDE * sizeof(Sloth_R32));
+      sg_apply_bindings(pass_bind);
+      sg_apply_uniforms(SG_SHADERSTAGE_VS, 
+        SLOT_sloth_viz_vs_params, 
+        &SG_RANGE(sloth_viz_vs_params2));
+      
+      sg_draw(batch.first_index, batch_indices_len, 1);
+    }
   }
 }
 
@@ -5585,6 +9238,10 @@ sloth_sokol_init(Sloth_Ctx* sloth)
   Sloth_Sokol_Data* sd = (Sloth_Sokol_Data*)sloth->render_data;
   sloth_zero_struct_(sd);
   
+  // the merged atlas texture can't be bigger than the backend allows
+  sloth->glyph_atlases_merged_max_dim = (Sloth_U32)sg_query_limits().max_image_size_2d;
+  if (sloth->glyph_atlases_merged_tiles > 0) sloth_glyph_atlases_layout_merged_(sloth);
+  
   sg_pass_action pass_action = SLOTH_ZII;
   pass_action.colors[0].action = SG_ACTION_CLEAR;
   pass_action.colors[0].value.r = 0;
@@ -5595,10 +9252,15 @@ sloth_sokol_init(Sloth_Ctx* sloth)
   
   sg_pipeline_desc pd = SLOTH_ZII;
   pd.shader = sg_make_shader(sloth_viz_shader_desc(sg_query_backend()));
-  pd.index_type = SG_INDEXTYPE_UINT32;
+  pd.index_type = SG_INDEXTYPE_UINT16;
   pd.layout.attrs[ATTR_sloth_viz_vs_position].format = SG_VERTEXFORMAT_FLOAT3;
+#if SLOTH_VERTEX_PACKED
+  pd.layout.attrs[ATTR_sloth_viz_vs_uv].format       = SG_VERTEXFORMAT_USHORT2N;
+  pd.layout.attrs[ATTR_sloth_viz_vs_color].format    = SG_VERTEXFORMAT_UBYTE4N;
+#else
   pd.layout.attrs[ATTR_sloth_viz_vs_uv].format       = SG_VERTEXFORMAT_FLOAT2;
   pd.layout.attrs[ATTR_sloth_viz_vs_color].format    = SG_VERTEXFORMAT_FLOAT4;
+#endif
   pd.label = "sloth sokol pipeline";
   pd.colors[0].blend.enabled = true;
   pd.colors[0].blend.src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA;
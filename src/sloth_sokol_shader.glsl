@@ -7,10 +7,11 @@ uniform sloth_viz_vs_params {
 };
 
 in vec3 position;
+// uv and color are either floats, or normalized u16s and u8s
+// when sloth is built with SLOTH_VERTEX_PACKED. The pipeline's 
+// vertex formats expand the packed values before they get here,
+// so this one program serves both layouts
 in vec2 uv;
-// TODO: This is really wasteful of data we have to 
-// send to the gpu every frame but I can't figure out 
-// how to pass uints to a shader
 in vec4 color;
 
 out vec2 o_uv;
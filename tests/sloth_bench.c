@@ -0,0 +1,434 @@
+// Headless benchmark for sloth_frame_prepare / sloth_frame_advance
+//
+// Builds synthetic widget trees of increasing size and reports how
+// long each pass of a frame takes. No window, gpu, or font file is
+// required - the font and renderer backends are stubbed out below.
+//
+// Usage:
+//   sloth_bench [frames_per_size] [widget_count ...]
+//
+// By default, runs trees of 1k, 10k, and 100k widgets
+//
+// Compile with -DSLOTH_LAYOUT_MULTI_PASS=1 to time the original
+// one-walk-per-step layout path for comparison.
+//
+// After the frame timings, the Robin Hood and swiss hashtables are 
+// compared on hit, miss, and churn workloads with as many keys as 
+// each tree has widgets. Compile with -DSLOTH_HASHTABLE_NO_SIMD to
+// see the swiss table without SSE2 / NEON.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+//////// PASS TIMING ////////
+// These hook into SLOTH_PROFILE_PASS_BEGIN/END, so they need to be
+// declared before sloth.h is included
+
+static unsigned long long sloth_bench_ns_now();
+static void sloth_bench_pass_begin(char* name);
+static void sloth_bench_pass_end(char* name);
+
+#define SLOTH_PROFILE_PASS_BEGIN(name) sloth_bench_pass_begin((char*)(name))
+#define SLOTH_PROFILE_PASS_END(name) sloth_bench_pass_end((char*)(name))
+
+#define SLOTH_IMPLEMENTATION 1
+#include "../src/sloth.h"
+
+typedef struct Sloth_Bench_Pass Sloth_Bench_Pass;
+struct Sloth_Bench_Pass
+{
+  char* name;
+  Sloth_U64 ns_total;
+};
+
+#define SLOTH_BENCH_PASSES_CAP 32
+static Sloth_Bench_Pass sloth_bench_passes[SLOTH_BENCH_PASSES_CAP];
+static Sloth_U32 sloth_bench_passes_len = 0;
+static Sloth_U64 sloth_bench_pass_start = 0;
+
+static Sloth_U64
+sloth_bench_ns_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((Sloth_U64)ts.tv_sec * 1000000000ULL) + (Sloth_U64)ts.tv_nsec;
+}
+
+static Sloth_Bench_Pass*
+sloth_bench_pass_get(char* name)
+{
+  for (Sloth_U32 i = 0; i < sloth_bench_passes_len; i++)
+  {
+    if (strcmp(sloth_bench_passes[i].name, name) == 0) return sloth_bench_passes + i;
+  }
+  if (sloth_bench_passes_len >= SLOTH_BENCH_PASSES_CAP) return 0;
+  Sloth_Bench_Pass* result = sloth_bench_passes + sloth_bench_passes_len++;
+  result->name = name;
+  result->ns_total = 0;
+  return result;
+}
+
+static void
+sloth_bench_pass_begin(char* name)
+{
+  sloth_bench_pass_start = sloth_bench_ns_now();
+}
+
+static void
+sloth_bench_pass_end(char* name)
+{
+  Sloth_U64 elapsed = sloth_bench_ns_now() - sloth_bench_pass_start;
+  Sloth_Bench_Pass* pass = sloth_bench_pass_get(name);
+  if (pass) pass->ns_total += elapsed;
+}
+
+static void
+sloth_bench_passes_reset()
+{
+  sloth_bench_passes_len = 0;
+}
+
+//////// STUB BACKENDS ////////
+
+static Sloth_U32 sloth_bench_atlas_updates = 0;
+
+static void
+sloth_bench_atlas_updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index, Sloth_Glyph_Atlas_Dirty_Rect* rects, Sloth_U32 rects_len)
+{
+  sloth_bench_atlas_updates += 1;
+}
+
+static Sloth_U8*
+sloth_bench_font_init(Sloth_Ctx* sloth, Sloth_Font* font, Sloth_U8* font_memory, Sloth_U32 font_memory_size, Sloth_U32 font_index, Sloth_R32 pixel_height)
+{
+  font->metrics.line_height = pixel_height + 4;
+  font->metrics.to_baseline = pixel_height;
+  return 0;
+}
+
+// Every codepoint gets the same solid block, which is all
+// the layout and vertex passes care about
+static Sloth_Glyph_ID
+sloth_bench_register_glyph(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint)
+{
+  static Sloth_U8 pixels[8 * 12];
+  memset(pixels, 0xFF, sizeof(pixels));
+
+  Sloth_Font* font = sloth_font_get_(sloth, font_id);
+  Sloth_Glyph_Desc gd = SLOTH_ZII;
+  gd.family = font->weights[font_id.weight_index].glyph_family;
+  gd.id = codepoint;
+  gd.format = Sloth_GlyphData_Alpha8;
+  gd.data = pixels;
+  gd.src_width = 8;
+  gd.src_height = 12;
+  gd.stride = 8;
+  gd.cursor_to_glyph_start_xoff = 0;
+  gd.cursor_to_next_glyph = 9;
+  gd.baseline_offset_y = -12;
+  return sloth_register_glyph(sloth, gd);
+}
+
+//////// SYNTHETIC TREES ////////
+
+static Sloth_Widget_Desc
+sloth_bench_desc(Sloth_Size width, Sloth_Size height, Sloth_U32 color_bg)
+{
+  Sloth_Widget_Desc result = SLOTH_ZII;
+  result.layout.width = width;
+  result.layout.height = height;
+  result.style.color_bg = color_bg;
+  result.style.color_text = 0xFFFFFFFF;
+  return result;
+}
+
+// Emits panels of mixed widgets until widget_count widgets exist.
+// Each panel contains:
+// - a text label sized to its contents
+// - a fixed size button
+// - a bar that is a percent of its parent
+// - a wrapping paragraph with a percent width and text height
+// - a nested group that sums the size of its own labels
+static Sloth_U32
+sloth_bench_build_tree(Sloth_Ctx* sloth, Sloth_U32 widget_count)
+{
+  Sloth_U32 count = 0;
+
+  Sloth_Widget_Desc root_desc = sloth_bench_desc(SLOTH_SIZE_PIXELS(1920), SLOTH_SIZE_PIXELS(1080), 0x202020FF);
+  Sloth_Widget_Result root = sloth_push_widget(sloth, root_desc, "##root");
+  count += 1;
+
+  for (Sloth_U32 panel_i = 0; count < widget_count; panel_i++)
+  {
+    Sloth_Widget_Desc panel_desc = sloth_bench_desc(SLOTH_SIZE_CHILDREN_SUM, SLOTH_SIZE_CHILDREN_SUM, 0x303030FF);
+    panel_desc.layout.direction = (panel_i & 1) ? Sloth_LayoutDirection_LeftToRight : Sloth_LayoutDirection_TopDown;
+    panel_desc.layout.margin.left = SLOTH_SIZE_PIXELS(4);
+    panel_desc.layout.margin.top = SLOTH_SIZE_PIXELS(4);
+    sloth_push_widget_f(sloth, panel_desc, "##panel_%u", panel_i);
+    count += 1;
+    {
+      Sloth_Widget_Desc label = sloth_bench_desc(SLOTH_SIZE_TEXT_CONTENT, SLOTH_SIZE_TEXT_CONTENT, 0);
+      sloth_push_widget_f(sloth, label, "Label %u###label_%u", panel_i, panel_i);
+      sloth_pop_widget(sloth);
+
+      Sloth_Widget_Desc button = sloth_bench_desc(SLOTH_SIZE_PIXELS(96), SLOTH_SIZE_PIXELS(24), 0x4050A0FF);
+      button.style.outline_thickness = 1;
+      button.style.color_outline = 0xFFFFFFFF;
+      button.style.text_style = Sloth_TextStyle_Align_Center;
+      sloth_push_widget_f(sloth, button, "Apply###button_%u", panel_i);
+      sloth_pop_widget(sloth);
+
+      Sloth_Widget_Desc bar = sloth_bench_desc(SLOTH_SIZE_PERCENT_OF_PARENT(0.5f), SLOTH_SIZE_PIXELS(4), 0x80FF80FF);
+      sloth_push_widget_f(sloth, bar, "##bar_%u", panel_i);
+      sloth_pop_widget(sloth);
+
+      Sloth_Widget_Desc paragraph = sloth_bench_desc(SLOTH_SIZE_PERCENT_OF_PARENT(1), SLOTH_SIZE_TEXT_CONTENT, 0);
+      sloth_push_widget_f(sloth, paragraph, "the quick brown fox jumps over the lazy dog###paragraph_%u", panel_i);
+      sloth_pop_widget(sloth);
+
+      Sloth_Widget_Desc group = sloth_bench_desc(SLOTH_SIZE_CHILDREN_SUM, SLOTH_SIZE_CHILDREN_SUM, 0);
+      group.layout.direction = Sloth_LayoutDirection_LeftToRight;
+      sloth_push_widget_f(sloth, group, "##group_%u", panel_i);
+      {
+        sloth_push_widget_f(sloth, label, "Key###key_%u", panel_i);
+        sloth_pop_widget(sloth);
+        sloth_push_widget_f(sloth, label, "%u###value_%u", panel_i * 7, panel_i);
+        sloth_pop_widget(sloth);
+      }
+      sloth_pop_widget(sloth);
+      count += 7;
+    }
+    sloth_pop_widget(sloth);
+  }
+
+  sloth_pop_widget_safe(sloth, root);
+  return count;
+}
+
+//////// BENCHMARK ////////
+
+static void
+sloth_bench_run(Sloth_U32 widget_count, Sloth_U32 frames)
+{
+  Sloth_Ctx sloth = SLOTH_ZII;
+  sloth.font_renderer_load_font = sloth_bench_font_init;
+  sloth.font_renderer_register_glyph = sloth_bench_register_glyph;
+  sloth.renderer_atlas_updated = sloth_bench_atlas_updated;
+  sloth.screen_dpi_scale = 1;
+  sloth_ctx_init(&sloth);
+
+  Sloth_Font_ID font = sloth_font_load_from_memory(&sloth, "bench", 5, 0, 0, 14);
+  sloth_font_register_family(&sloth, font, 0, 1);
+  sloth_set_current_font(&sloth, font);
+
+  Sloth_Frame_Desc fd = SLOTH_ZII;
+  fd.screen_dim = sloth_make_v2(1920, 1080);
+  fd.mouse_pos = sloth_make_v2(100, 100);
+  fd.dpi_scale = 1;
+
+  // Warm up
+  // The first frames register glyphs, grow atlases, and populate
+  // the widget cache. That isn't representative of steady state.
+  Sloth_U32 warmup_frames = 2;
+  Sloth_U32 widgets_built = 0;
+  for (Sloth_U32 i = 0; i < warmup_frames; i++)
+  {
+    sloth_frame_prepare(&sloth, fd);
+    widgets_built = sloth_bench_build_tree(&sloth, widget_count);
+    sloth_frame_advance(&sloth);
+  }
+  sloth_bench_passes_reset();
+
+  Sloth_U64 ns_prepare = 0;
+  Sloth_U64 ns_build = 0;
+  Sloth_U64 ns_advance = 0;
+  for (Sloth_U32 i = 0; i < frames; i++)
+  {
+    Sloth_U64 t0 = sloth_bench_ns_now();
+    sloth_frame_prepare(&sloth, fd);
+    Sloth_U64 t1 = sloth_bench_ns_now();
+    sloth_bench_build_tree(&sloth, widget_count);
+    Sloth_U64 t2 = sloth_bench_ns_now();
+    sloth_frame_advance(&sloth);
+    Sloth_U64 t3 = sloth_bench_ns_now();
+
+    ns_prepare += t1 - t0;
+    ns_build   += t2 - t1;
+    ns_advance += t3 - t2;
+  }
+
+  Sloth_U32 verts = 0;
+  Sloth_U32 indices = 0;
+  for (Sloth_U32 i = 0; i < sloth.glyph_atlases_cap; i++)
+  {
+    verts += sloth.vibuffers[i].verts_len / SLOTH_VERTEX_STRIDE;
+    indices += sloth.vibuffers[i].indices_len;
+  }
+
+  printf("\n%u widgets (%u frames, %u verts, %u indices)\n", widgets_built, frames, verts, indices);
+  printf("  %-28s %14s %8s\n", "pass", "ns/frame", "%frame");
+
+  double prepare_ns = (double)ns_prepare / frames;
+  double build_ns   = (double)ns_build / frames;
+  double advance_ns = (double)ns_advance / frames;
+  double frame_ns   = prepare_ns + build_ns + advance_ns;
+  printf("  %-28s %14.0f %7.1f%%\n", "sloth_frame_prepare", prepare_ns, 100 * prepare_ns / frame_ns);
+  printf("  %-28s %14.0f %7.1f%%\n", "build tree (push/pop)", build_ns, 100 * build_ns / frame_ns);
+  printf("  %-28s %14.0f %7.1f%%\n", "sloth_frame_advance", advance_ns, 100 * advance_ns / frame_ns);
+  for (Sloth_U32 i = 0; i < sloth_bench_passes_len; i++)
+  {
+    Sloth_Bench_Pass p = sloth_bench_passes[i];
+    double pass_ns = (double)p.ns_total / frames;
+    printf("    %-26s %14.0f %7.1f%%\n", p.name, pass_ns, 100 * pass_ns / frame_ns);
+  }
+  
+  sloth_ctx_free(&sloth);
+}
+
+//////// HASHTABLE ////////
+
+typedef struct Sloth_Bench_Hashtable_Impl Sloth_Bench_Hashtable_Impl;
+struct Sloth_Bench_Hashtable_Impl
+{
+  char* name;
+  void       (*add)(Sloth_Hashtable* table, Sloth_U32 key, Sloth_U8* value);
+  Sloth_Bool (*rem)(Sloth_Hashtable* table, Sloth_U32 key);
+  Sloth_U8*  (*get)(Sloth_Hashtable* table, Sloth_U32 key);
+};
+
+// Widget ids are hashes, so the keys are random rather than sequential
+static Sloth_U32
+sloth_bench_key_next(Sloth_U32* state)
+{
+  Sloth_U32 x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+// Enough operations per workload that small tables still
+// take long enough to time
+#define SLOTH_BENCH_HASHTABLE_OPS 2000000
+
+static void
+sloth_bench_hashtable_run(Sloth_Bench_Hashtable_Impl impl, Sloth_U32 key_count)
+{
+  Sloth_U32* keys = (Sloth_U32*)malloc(sizeof(Sloth_U32) * key_count);
+  Sloth_U32* misses = (Sloth_U32*)malloc(sizeof(Sloth_U32) * key_count);
+  Sloth_U32 state = 0x9E3779B9;
+  for (Sloth_U32 i = 0; i < key_count; i++)
+  {
+    // the top bit keeps misses disjoint from keys
+    keys[i] = sloth_bench_key_next(&state) & 0x7FFFFFFF;
+    if (keys[i] == 0) keys[i] = 1;
+    misses[i] = keys[i] | 0x80000000;
+  }
+  
+  Sloth_Hashtable table = SLOTH_ZII;
+  for (Sloth_U32 i = 0; i < key_count; i++)
+  {
+    if (!impl.get(&table, keys[i])) impl.add(&table, keys[i], (Sloth_U8*)(keys + i));
+  }
+  
+  Sloth_U32 rounds = (SLOTH_BENCH_HASHTABLE_OPS / key_count) + 1;
+  Sloth_U64 ops = (Sloth_U64)rounds * key_count;
+  Sloth_U64 found = 0;
+  
+  Sloth_U64 t0 = sloth_bench_ns_now();
+  for (Sloth_U32 r = 0; r < rounds; r++)
+  {
+    for (Sloth_U32 i = 0; i < key_count; i++) found += impl.get(&table, keys[i]) != 0;
+  }
+  Sloth_U64 t1 = sloth_bench_ns_now();
+  for (Sloth_U32 r = 0; r < rounds; r++)
+  {
+    for (Sloth_U32 i = 0; i < key_count; i++) found += impl.get(&table, misses[i]) != 0;
+  }
+  Sloth_U64 t2 = sloth_bench_ns_now();
+  
+  // churn swaps every key for its miss and back, the way widgets
+  // come and go between frames. each swap is a rem and an add
+  for (Sloth_U32 r = 0; r < rounds; r++)
+  {
+    Sloth_U32* from = (r & 1) ? misses : keys;
+    Sloth_U32* to   = (r & 1) ? keys : misses;
+    for (Sloth_U32 i = 0; i < key_count; i++)
+    {
+      impl.rem(&table, from[i]);
+      impl.add(&table, to[i], (Sloth_U8*)(to + i));
+    }
+  }
+  Sloth_U64 t3 = sloth_bench_ns_now();
+  
+  Sloth_Hashtable_Stats stats = sloth_hashtable_stats(&table);
+  printf("  %-28s %10.1f %10.1f %10.1f %9u %9u\n", impl.name,
+    (double)(t1 - t0) / ops, (double)(t2 - t1) / ops, (double)(t3 - t2) / (ops * 2),
+    stats.cap, stats.rehashes);
+  
+  // found is printed so the lookups can't be optimized away
+  if (found != ops) printf("    (%llu of %llu hits found)\n", found, ops);
+  
+  sloth_hashtable_free(&table);
+  free(keys);
+  free(misses);
+}
+
+static void
+sloth_bench_hashtables(Sloth_U32 key_count)
+{
+  if (key_count == 0) return;
+  
+  Sloth_Bench_Hashtable_Impl robin_hood = { "robin hood", sloth_hashtable_rh_add, sloth_hashtable_rh_rem, sloth_hashtable_rh_get };
+#if SLOTH_HASHTABLE_SSE2
+  Sloth_Bench_Hashtable_Impl swiss = { "swiss (sse2)", sloth_hashtable_swiss_add, sloth_hashtable_swiss_rem, sloth_hashtable_swiss_get };
+#elif SLOTH_HASHTABLE_NEON
+  Sloth_Bench_Hashtable_Impl swiss = { "swiss (neon)", sloth_hashtable_swiss_add, sloth_hashtable_swiss_rem, sloth_hashtable_swiss_get };
+#else
+  Sloth_Bench_Hashtable_Impl swiss = { "swiss (scalar)", sloth_hashtable_swiss_add, sloth_hashtable_swiss_rem, sloth_hashtable_swiss_get };
+#endif
+  
+  printf("\nhashtable, %u keys\n", key_count);
+  printf("  %-28s %10s %10s %10s %9s %9s\n", "impl", "hit ns", "miss ns", "churn ns", "cap", "rehashes");
+  sloth_bench_hashtable_run(robin_hood, key_count);
+  sloth_bench_hashtable_run(swiss, key_count);
+}
+
+int main(int argc, char** argv)
+{
+  Sloth_U32 frames = 10;
+  if (argc > 1) frames = (Sloth_U32)atoi(argv[1]);
+  if (frames == 0) frames = 1;
+
+  Sloth_U32 default_counts[] = { 1000, 10000, 100000 };
+  Sloth_U32* counts = default_counts;
+  Sloth_U32 counts_len = sizeof(default_counts) / sizeof(default_counts[0]);
+
+  Sloth_U32 arg_counts[16];
+  if (argc > 2)
+  {
+    counts = arg_counts;
+    counts_len = 0;
+    for (int i = 2; i < argc && counts_len < 16; i++)
+    {
+      arg_counts[counts_len++] = (Sloth_U32)atoi(argv[i]);
+    }
+  }
+
+  printf("Sloth Frame Benchmark\n");
+  for (Sloth_U32 i = 0; i < counts_len; i++)
+  {
+    sloth_bench_run(counts[i], frames);
+  }
+  
+  for (Sloth_U32 i = 0; i < counts_len; i++)
+  {
+    sloth_bench_hashtables(counts[i]);
+  }
+
+  return 0;
+}
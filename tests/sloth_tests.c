@@ -95,6 +95,44 @@ sloth_test_multi_frame_removal_frame_b(Sloth_Ctx* sloth, int num_to_remove)
   sloth_frame_advance(sloth);
 }
 
+// Lays out one frame of text in a widget width pixels wide and as 
+// tall as its text, in a 400x120 root. If long_widget isn't 0, the
+// same text is also pushed as long text beside it. text_len may be
+// 0 if text is null terminated
+Sloth_Widget*
+sloth_test_text_frame(Sloth_Ctx* sloth, char* text, Sloth_U32 text_len, Sloth_R32 width, Sloth_Text_Style_Flags text_style, Sloth_Widget** long_widget)
+{
+  if (text_len == 0) {
+    while (text[text_len]) text_len++;
+  }
+  Sloth_Widget_Desc root = {
+    .layout = {
+      .width = SLOTH_SIZE_PIXELS(400),
+      .height = SLOTH_SIZE_PIXELS(120),
+      .direction = Sloth_LayoutDirection_LeftToRight,
+    },
+  };
+  Sloth_Widget_Desc d = {
+    .layout = {
+      .width = SLOTH_SIZE_PIXELS(width),
+      .height = SLOTH_SIZE_TEXT_CONTENT,
+    },
+    .style.text_style = text_style,
+  };
+  sloth_frame_prepare(sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(sloth, root, "root");
+  if (long_widget) 
+  {
+    *long_widget = sloth_push_widget_long_text(sloth, d, SLOTH_ID("long"), text, text_len).widget;
+    sloth_pop_widget(sloth);
+  }
+  Sloth_Widget* result = sloth_push_widget_f(sloth, d, "%.*s###text", text_len, text).widget;
+  sloth_pop_widget(sloth);
+  sloth_pop_widget(sloth);
+  sloth_frame_advance(sloth);
+  return result;
+}
+
 UTEST(widget_tree, multi_frame_removal)
 {
   return;
@@ -290,6 +328,124 @@ UTEST(data, hashtable)
   EXPECT_TRUE(r0);
   v0 = (Sloth_U64)sloth_hashtable_get(&table, 256);
   EXPECT_EQ(v0, 0);
+  
+  // removing a key that isn't present
+  Sloth_Bool r1 = sloth_hashtable_rem(&table, 3333);
+  EXPECT_FALSE(r1);
+  EXPECT_EQ(table.used, 3);
+  
+  sloth_hashtable_free(&table);
+}
+
+UTEST(data, hashtable_growth)
+{
+  Sloth_Hashtable table = {};
+  table.max_load = 0.5f;
+  
+  // well past the initial cap
+  Sloth_U32 count = SLOTH_HASHTABLE_CAP_DEFAULT * 4;
+  for (Sloth_U32 i = 1; i <= count; i++) {
+    sloth_hashtable_add(&table, i * 7919, (Sloth_U8*)(Sloth_U64)i);
+  }
+  EXPECT_EQ(table.used, count);
+  EXPECT_LE((Sloth_R32)table.used, (Sloth_R32)table.cap * table.max_load);
+  
+  Sloth_Bool all_found = true;
+  for (Sloth_U32 i = 1; i <= count; i++) {
+    all_found &= (Sloth_U64)sloth_hashtable_get(&table, i * 7919) == i;
+  }
+  EXPECT_TRUE(all_found);
+  
+  Sloth_Hashtable_Stats stats = sloth_hashtable_stats(&table);
+  EXPECT_GT(stats.rehashes, (Sloth_U32)0);
+  EXPECT_EQ(stats.lookups, (Sloth_U64)count);
+  
+  // churn - removed keys don't leave anything behind to fill 
+  // or grow the table
+  for (Sloth_U32 i = (count / 2) + 1; i <= count; i++) {
+    sloth_hashtable_rem(&table, i * 7919);
+  }
+  Sloth_U32 cap_before = table.cap;
+  for (Sloth_U32 round = 0; round < 8; round++) {
+    for (Sloth_U32 i = 1; i <= count / 2; i++) {
+      sloth_hashtable_rem(&table, i * 7919 + round);
+      sloth_hashtable_add(&table, i * 7919 + round + 1, (Sloth_U8*)(Sloth_U64)i);
+    }
+  }
+  EXPECT_EQ(table.used, count / 2);
+  EXPECT_EQ(table.cap, cap_before);
+  EXPECT_EQ((Sloth_U64)sloth_hashtable_get(&table, 7919 * 2 + 8), 2);
+  
+  // every key is reachable without probing past an empty slot,
+  // and misses stop early
+  sloth_hashtable_stats_reset(&table);
+  Sloth_Bool none_found = true;
+  for (Sloth_U32 i = 1; i <= count; i++) {
+    none_found &= sloth_hashtable_get(&table, i * 7919 + 3) == 0;
+  }
+  EXPECT_TRUE(none_found);
+  stats = sloth_hashtable_stats(&table);
+  EXPECT_LE(stats.lookup_probe_max, stats.key_dist_max + 1);
+  EXPECT_EQ((Sloth_U64)sloth_hashtable_get(&table, 7919 + 8), 1);
+  
+  sloth_hashtable_free(&table);
+}
+
+UTEST(data, hashtable_swiss)
+{
+  // called directly so it's covered whichever implementation
+  // SLOTH_HASHTABLE_SWISS selects
+  Sloth_Hashtable table = {};
+  sloth_hashtable_swiss_realloc(&table, 0, 64);
+  EXPECT_EQ(table.cap, 64);
+  
+  // 40 keys in 4 groups of 16 - some groups will overflow
+  Sloth_U32 count = 40;
+  for (Sloth_U32 i = 1; i <= count; i++) {
+    sloth_hashtable_swiss_add(&table, i, (Sloth_U8*)(Sloth_U64)i);
+  }
+  EXPECT_EQ(table.used, count);
+  EXPECT_EQ(table.cap, 64);
+  
+  Sloth_Bool all_found = true;
+  for (Sloth_U32 i = 1; i <= count; i++) {
+    all_found &= (Sloth_U64)sloth_hashtable_swiss_get(&table, i) == i;
+  }
+  EXPECT_TRUE(all_found);
+  EXPECT_EQ((Sloth_U64)sloth_hashtable_swiss_get(&table, count + 1), 0);
+  
+  EXPECT_TRUE(sloth_hashtable_swiss_rem(&table, 7));
+  EXPECT_FALSE(sloth_hashtable_swiss_rem(&table, 7));
+  EXPECT_EQ((Sloth_U64)sloth_hashtable_swiss_get(&table, 7), 0);
+  EXPECT_EQ((Sloth_U64)sloth_hashtable_swiss_get(&table, 8), 8);
+  sloth_hashtable_swiss_add(&table, 7, (Sloth_U8*)7);
+  
+  // churn - once the table has room, most removals empty their slot
+  // outright, so tombstones don't build up and the table settles
+  Sloth_U32 cap_settled = 0;
+  Sloth_U32 rehashes_settled = 0;
+  for (Sloth_U32 round = 1; round <= 32; round++) {
+    for (Sloth_U32 i = 1; i <= count; i++) {
+      sloth_hashtable_swiss_rem(&table, ((round - 1) * 1000) + i);
+      sloth_hashtable_swiss_add(&table, (round * 1000) + i, (Sloth_U8*)(Sloth_U64)i);
+    }
+    if (round == 4) {
+      cap_settled = table.cap;
+      rehashes_settled = table.stats_rehashes;
+    }
+  }
+  EXPECT_EQ(table.used, count);
+  EXPECT_EQ(table.cap, cap_settled);
+  EXPECT_EQ(table.stats_rehashes, rehashes_settled);
+  EXPECT_LE(table.used + table.deleted, (Sloth_U32)(table.cap * SLOTH_HASHTABLE_MAX_LOAD_DEFAULT));
+  
+  all_found = true;
+  for (Sloth_U32 i = 1; i <= count; i++) {
+    all_found &= (Sloth_U64)sloth_hashtable_swiss_get(&table, (32 * 1000) + i) == i;
+  }
+  EXPECT_TRUE(all_found);
+  
+  sloth_hashtable_free(&table);
 }
 
 UTEST(memory, arena)
@@ -311,10 +467,10 @@ UTEST(memory, arena)
   
   // testing memory reuse after popping
   sloth_arena_pop(&arena, old_at);
-  // test that in debug mode, popped memory is cleared
-  // NOTE: that if we aren't in debug mode, sloth_test_assert evaluates to
-  // nothing, so the test won't run
+  // popped memory is only cleared in debug builds
+#ifdef DEBUG
   for (Sloth_U32 i = 0; i < 32; i++) EXPECT_EQ(array_1[i], 0);
+#endif
   
   Sloth_U32* array_1b = sloth_arena_push_array(&arena, Sloth_U32, 32);
   EXPECT_EQ(array_1, array_1b);
@@ -332,6 +488,81 @@ UTEST(memory, arena)
   EXPECT_EQ(arena.curr_bucket_len, 0);
 }
 
+UTEST(memory, arena_stats)
+{
+  Sloth_Arena arena = {};
+  
+  Sloth_Arena_Loc at = sloth_arena_at(&arena);
+  sloth_arena_push(&arena, 100);
+  sloth_arena_push(&arena, 300);
+  sloth_arena_pop(&arena, at);
+  sloth_arena_push(&arena, 50);
+  
+  Sloth_Arena_Stats stats = sloth_arena_stats(&arena);
+  EXPECT_EQ(stats.used, 50);
+  EXPECT_EQ(stats.cycle.pushes, 3);
+  EXPECT_EQ(stats.cycle.pushed, 450);
+  EXPECT_EQ(stats.cycle.peak, 400);
+  EXPECT_EQ(stats.cycle.grows, 1);
+  EXPECT_GE(stats.committed, 400);
+  
+  // clearing hands the cycle over to last_cycle
+  sloth_arena_clear(&arena);
+  sloth_arena_push(&arena, 10);
+  stats = sloth_arena_stats(&arena);
+  EXPECT_EQ(stats.last_cycle.pushed, 450);
+  EXPECT_EQ(stats.last_cycle.peak, 400);
+  EXPECT_EQ(stats.cycle.pushes, 1);
+  EXPECT_EQ(stats.cycle.peak, 10);
+  EXPECT_EQ(stats.cycle.grows, 0);
+  EXPECT_EQ(stats.peak_max, 400);
+  
+  sloth_arena_free(&arena);
+  stats = sloth_arena_stats(&arena);
+  EXPECT_EQ(stats.committed, 0);
+  EXPECT_EQ(stats.peak_max, 0);
+}
+
+#if SLOTH_ARENA_VIRTUAL
+UTEST(memory, arena_virtual)
+{
+  Sloth_Arena arena = {};
+  
+  // pushes well past the old 64 bucket ceiling land in one range
+  Sloth_U8* first = sloth_arena_push(&arena, 1024);
+  EXPECT_NE(first, (Sloth_U8*)0);
+  EXPECT_EQ(arena.committed, SLOTH_ARENA_COMMIT_SIZE);
+  Sloth_U32 chunk = 4 * 1024 * 1024;
+  Sloth_Bool contiguous = true;
+  for (Sloth_U32 i = 0; i < 24; i++) {
+    Sloth_U8* at = sloth_arena_push(&arena, chunk);
+    contiguous &= at == first + 1024 + (i * chunk);
+  }
+  EXPECT_TRUE(contiguous);
+  EXPECT_EQ(arena.at, 1024 + (24 * chunk));
+  EXPECT_GE(arena.committed, arena.at);
+  
+  // a cleared cycle that uses less gives the rest back
+  Sloth_U32 spike_committed = arena.committed;
+  sloth_arena_clear(&arena);
+  EXPECT_EQ(arena.committed, spike_committed);
+  Sloth_U8* small = sloth_arena_push(&arena, 512);
+  EXPECT_EQ(small, first);
+  small[511] = 1;
+  sloth_arena_clear(&arena);
+  EXPECT_EQ(arena.committed, SLOTH_ARENA_COMMIT_SIZE);
+  
+  // pages decommitted on clear are recommitted on demand
+  Sloth_U8* again = sloth_arena_push(&arena, chunk);
+  again[chunk - 1] = 1;
+  EXPECT_EQ(again, first);
+  
+  sloth_arena_free(&arena);
+  EXPECT_EQ(arena.base, (Sloth_U8*)0);
+  EXPECT_EQ(arena.committed, 0);
+}
+#endif
+
 UTEST(widget, cache_pool)
 {
   Sloth_Ctx sloth = {};
@@ -365,6 +596,19 @@ UTEST(widget, cache_pool)
   Sloth_U32 cache_pool_size_after = (sloth.widget_caches.bucket_at * sloth.widget_caches.bucket_cap) + sloth.widget_caches.bucket_at_len;
   EXPECT_EQ(cache_pool_size_before, cache_pool_size_after);
   EXPECT_EQ(sloth.widget_caches.free_list, (Sloth_Widget_Cached*)0);
+  
+  // the bucket list grows past its first 32 buckets, and existing
+  // buckets stay where they are
+  Sloth_Widget_Cached* first = sloth.widget_caches.buckets[0];
+  Sloth_U32 past_initial = (33 * sloth.widget_caches.bucket_cap) - cache_pool_size_after;
+  for (Sloth_U32 i = 0; i < past_initial; i++)
+  {
+    sloth_widget_cached_pool_take(&sloth);
+  }
+  EXPECT_GT(sloth.widget_caches.buckets_cap, (Sloth_U32)32);
+  EXPECT_EQ(sloth.widget_caches.bucket_at, (Sloth_U32)32);
+  EXPECT_EQ(sloth.widget_caches.buckets[0], first);
+  sloth_widget_cached_pool_free(&sloth.widget_caches);
 }
 
 UTEST(widget, id)
@@ -387,9 +631,70 @@ UTEST(widget, id)
   EXPECT_NE(id2.id.value, id0.id.value);
   EXPECT_EQ(id2.display_len, 7);
   
+  // precomputed ids match the ids made from the same string
+  Sloth_ID id3 = SLOTH_ID("Test id##53");
+  EXPECT_EQ(id3.value, id0.id.value);
+  Sloth_ID_Result id4 = sloth_make_id_f(&arena, "Label###%d", 53);
+  EXPECT_EQ(SLOTH_ID("53").value, id4.id.value);
+  
+  // strings that don't need formatting aren't copied
+  Sloth_U32 arena_len_before = arena.curr_bucket_len;
+  Sloth_ID_Result id5 = sloth_make_id_f(&arena, "Constant##label");
+  EXPECT_EQ(arena.curr_bucket_len, arena_len_before);
+  EXPECT_EQ(id5.display_len, 8);
+  
+  // every tail length hashes differently
+  EXPECT_NE(SLOTH_ID("abcd").value, SLOTH_ID("abcde").value);
+  EXPECT_NE(SLOTH_ID("abcde").value, SLOTH_ID("abcdf").value);
+  EXPECT_NE(SLOTH_ID("").value, 0);
+  
   sloth_arena_free(&arena);
 }
 
+UTEST(widget, id_scopes)
+{
+  Sloth_Ctx sloth = {};
+  Sloth_Widget_Desc d = {};
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(&sloth, d, "root");
+  
+  // the same label in two scopes gets two ids
+  Sloth_ID row_ids[2];
+  for (Sloth_U32 i = 0; i < 2; i++)
+  {
+    sloth_push_id_scope(&sloth, (Sloth_ID){ i + 1 });
+    Sloth_Widget_Result row = sloth_push_widget(&sloth, d, "row");
+    row_ids[i] = row.widget->id;
+    
+    // precomputed ids are scoped the same way
+    Sloth_Widget_Result label = sloth_push_widget_id_label(&sloth, d, SLOTH_ID("label"), "label##not an id");
+    EXPECT_EQ(label.widget->id.value, sloth_id_combine(sloth.id_scopes[0], SLOTH_ID("label")).value);
+    EXPECT_EQ(sloth_widget_text(&sloth, label.widget)->glyphs_len, (Sloth_U32)16);
+    sloth_pop_widget(&sloth);
+    
+    // nested scopes combine with their parents
+    sloth_push_id_scope(&sloth, (Sloth_ID){ 7 });
+    Sloth_Widget_Result nested = sloth_push_widget(&sloth, d, "row");
+    EXPECT_NE(nested.widget->id.value, row_ids[i].value);
+    sloth_pop_widget(&sloth);
+    sloth_pop_id_scope(&sloth);
+    
+    sloth_pop_widget(&sloth);
+    sloth_pop_id_scope(&sloth);
+  }
+  EXPECT_NE(row_ids[0].value, row_ids[1].value);
+  
+  // outside of any scope, ids are just the hash of the label
+  Sloth_Widget_Result unscoped = sloth_push_widget(&sloth, d, "row");
+  EXPECT_EQ(unscoped.widget->id.value, SLOTH_ID("row").value);
+  sloth_pop_widget(&sloth);
+  
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
 UTEST(glyph, glyph_id)
 {
   // Glyph ID Tests
@@ -429,13 +734,14 @@ UTEST(glyph, glyph_store)
     .format = Sloth_GlyphData_RGBA8,
   };
   Sloth_Glyph_ID id_0 = sloth_register_glyph(&sloth, gd0);
-  Sloth_U32 last_glyph = sloth.glyph_atlases[atlas_i].last_glyph;
+  Sloth_Skyline_Node skyline_top = sloth.glyph_atlases[id_0.family].skyline[0];
   EXPECT_EQ(sloth.glyph_store.glyphs_table.used, 1);
   
   // testing adding the same glyph a second time. 
   Sloth_Glyph_ID id_01 = sloth_register_glyph(&sloth, gd0);
   EXPECT_EQ(id_01.value, id_0.value);
-  EXPECT_EQ(sloth.glyph_atlases[atlas_i].last_glyph, last_glyph);
+  EXPECT_EQ(sloth.glyph_atlases[id_0.family].skyline[0].y, skyline_top.y);
+  EXPECT_EQ(sloth.glyph_atlases[id_0.family].skyline[0].width, skyline_top.width);
   EXPECT_EQ(sloth.glyph_store.glyphs_table.used, 1); // no sprite was added
   
   Sloth_Glyph_Desc gd2 = gd0;
@@ -465,6 +771,90 @@ UTEST(glyph, glyph_store)
   sloth_ctx_free(&sloth);
 }
 
+UTEST(glyph, atlas_packing)
+{
+  Sloth_U32 pixels[4 * 4];
+  for (Sloth_U32 i = 0; i < 16; i++) pixels[i] = 0xFF00FF00 + i;
+  
+  Sloth_Ctx sloth = {};
+  Sloth_Glyph_Desc gd = {
+    .id = 1,
+    .data = (Sloth_U8*)pixels,
+    .src_width = 4,
+    .src_height = 4,
+    .stride = 4,
+    .format = Sloth_GlyphData_RGBA8,
+  };
+  Sloth_Glyph_Info small = sloth_lookup_glyph(&sloth, sloth_register_glyph(&sloth, gd));
+  EXPECT_EQ(small.glyph.offset_x, (Sloth_U32)1);
+  EXPECT_EQ(small.glyph.offset_y, (Sloth_U32)1);
+  Sloth_Glyph_Atlas* atlas = sloth.glyph_atlases + 0;
+  Sloth_U32 small_pixel_at = (small.glyph.offset_y * atlas->dim) + small.glyph.offset_x;
+  EXPECT_EQ(((Sloth_U32*)atlas->data)[small_pixel_at + 1], pixels[1]);
+  
+  // a tall glyph fills the rest of the first row, and the next small 
+  // glyph fills the gap above the first rather than starting a new row
+  gd.data = 0;
+  gd.id = 2;
+  gd.src_width = 1016;
+  gd.src_height = 500;
+  Sloth_Glyph_Info tall = sloth_lookup_glyph(&sloth, sloth_register_glyph(&sloth, gd));
+  EXPECT_EQ(tall.glyph.offset_x, (Sloth_U32)7);
+  EXPECT_EQ(tall.glyph.offset_y, (Sloth_U32)1);
+  gd.id = 3;
+  gd.src_width = 4;
+  gd.src_height = 4;
+  Sloth_Glyph_Info gap = sloth_lookup_glyph(&sloth, sloth_register_glyph(&sloth, gd));
+  EXPECT_EQ(gap.glyph.offset_x, (Sloth_U32)1);
+  EXPECT_EQ(gap.glyph.offset_y, (Sloth_U32)7);
+  
+  // big glyphs grow the atlas until it's SLOTH_GLYPH_ATLAS_MAX_DIM, and 
+  // then spill into a page of their own. Packed glyphs keep their pixels
+  gd.src_width = 1000;
+  gd.src_height = 1000;
+  Sloth_Glyph_ID spilled_id = {};
+  for (Sloth_U32 i = 0; i < 32 && sloth.glyph_atlases[0].next_page == 0; i++)
+  {
+    gd.id = 10 + i;
+    spilled_id = sloth_register_glyph(&sloth, gd);
+  }
+  atlas = sloth.glyph_atlases + 0; // moved when the page was added
+  EXPECT_EQ(atlas->dim, (Sloth_U32)SLOTH_GLYPH_ATLAS_MAX_DIM);
+  small_pixel_at = (small.glyph.offset_y * atlas->dim) + small.glyph.offset_x;
+  EXPECT_EQ(((Sloth_U32*)atlas->data)[small_pixel_at + 1], pixels[1]);
+  Sloth_Glyph_Info small_after = sloth_lookup_glyph(&sloth, sloth_make_glyph_id(0, 1));
+  EXPECT_EQ(small_after.glyph.offset_x, small.glyph.offset_x);
+#if SLOTH_ATLAS_MERGED
+  // uvs are into the merged texture, offset by the atlas's tile
+  Sloth_U32 tile_dim = sloth.glyph_atlases_tile_dim;
+  Sloth_U32 tiles_per_row = sloth.glyph_atlases_merged_tiles_per_row;
+  Sloth_R32 merged_dim = (Sloth_R32)sloth.glyph_atlases_merged_dim;
+  Sloth_U32 tile_x = (atlas->merged_tile % tiles_per_row) * tile_dim;
+  EXPECT_EQ(small_after.uv.value_max.x, (Sloth_R32)(tile_x + small.glyph.offset_x + small.glyph.src_width) / merged_dim);
+#else
+  EXPECT_EQ(small_after.uv.value_max.x, small.uv.value_max.x / 4);
+#endif
+  
+  Sloth_Glyph_Info spilled = sloth_lookup_glyph(&sloth, spilled_id);
+  EXPECT_EQ(atlas->next_page, (Sloth_U32)SLOTH_GLYPH_ATLAS_FIRST_PAGE);
+  EXPECT_EQ(spilled.glyph.atlas_index, (Sloth_U32)SLOTH_GLYPH_ATLAS_FIRST_PAGE);
+  Sloth_Glyph_Atlas* page = sloth.glyph_atlases + SLOTH_GLYPH_ATLAS_FIRST_PAGE;
+  EXPECT_EQ(page->id, (Sloth_U8)0);
+#if SLOTH_ATLAS_MERGED
+  // the page is the next tile along, and drawn with every other atlas
+  EXPECT_EQ(page->merged_tile, (Sloth_U32)1);
+  Sloth_U32 page_tile_x = (page->merged_tile % tiles_per_row) * tile_dim;
+  EXPECT_EQ(spilled.uv.value_max.x, (Sloth_R32)(page_tile_x + 1 + 1000) / merged_dim);
+  EXPECT_EQ(sloth_get_vibuffer_for_glyph(&sloth, spilled_id), sloth.vibuffers + 0);
+#else
+  EXPECT_EQ(spilled.uv.value_max.x, (Sloth_R32)(1 + 1000) / page->dim);
+  EXPECT_EQ(sloth_get_vibuffer_for_glyph(&sloth, spilled_id), sloth.vibuffers + SLOTH_GLYPH_ATLAS_FIRST_PAGE);
+#endif
+  
+  sloth_glyph_store_free(&sloth.glyph_store);
+  sloth_ctx_free(&sloth);
+}
+
 UTEST(layout, size)
 {
   // see @Maintenance tag in Sloth_Size_Box if this fails
@@ -486,7 +876,8 @@ UTEST(layout, size)
 UTEST(widget_tree, construction)
 {
   Sloth_Ctx sloth = {
-    .per_frame_memory.name = "pfm",
+    .per_frame_memory[0].name = "pfm0",
+    .per_frame_memory[1].name = "pfm1",
     .scratch.name = "scratch",
   };
   Sloth_Arena* s = &sloth.scratch;
@@ -524,7 +915,7 @@ UTEST(widget_tree, construction)
   sloth_pop_widget_safe(&sloth, r0); // root - won't pop
   
   // walking the tree
-  EXPECT_NE(sloth.widget_tree_root, (Sloth_Widget*)0);
+  EXPECT_NE(sloth.widget_tree_root, (Sloth_U32)0);
   EXPECT_EQ(sloth.widget_tree_depth_max, 3);
   sloth_test_widget_order_count = 0; // reset test
   sloth_tree_walk_preorder(&sloth, sloth_test_widget_order, (Sloth_U8*)&ids0_preorder);
@@ -548,7 +939,7 @@ UTEST(widget_tree, construction)
   sloth_pop_widget(&sloth); // root - won't pop
   
   // walking the tree
-  EXPECT_NE(sloth.widget_tree_root, (Sloth_Widget*)0);
+  EXPECT_NE(sloth.widget_tree_root, (Sloth_U32)0);
   sloth_test_widget_order_count = 0; // reset test
   sloth_tree_walk_preorder(&sloth, sloth_test_widget_order, (Sloth_U8*)&ids0_preorder);
   
@@ -618,30 +1009,724 @@ UTEST(layout, widget_sizing)
   sloth_pop_widget(&sloth);
   
   sloth_frame_advance(&sloth);
-  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
   
-  Sloth_Widget* root = sloth.widget_tree_next_child;
+  Sloth_Widget* root = sloth_widget_get(&sloth, sloth.widget_tree_root);
   EXPECT_EQ(root->cached->offset.x, 0); EXPECT_EQ(root->cached->offset.y, 0);
   EXPECT_EQ(root->cached->dim.x, 800); EXPECT_EQ(root->cached->dim.y, 900);
   
-  Sloth_Widget* ele0 = root->child_first;
+  Sloth_Widget* ele0 = sloth_widget_child_first(&sloth, root);
+  EXPECT_EQ(ele0->subtree_size, 1);
 #if DO_CLIP
   EXPECT_EQ(ele0->cached->offset.x, 0); EXPECT_EQ(ele0->cached->offset.y, 0);
   EXPECT_EQ(ele0->cached->dim.x, 800); EXPECT_EQ(ele0->cached->dim.y, 200);
 #endif
   
-  Sloth_Widget* ele1 = ele0->sibling_next;
+  Sloth_Widget* ele1 = sloth_widget_sibling_next(&sloth, ele0);
+  EXPECT_EQ(sloth_widget_sibling_prev(&sloth, ele1), ele0);
 #if DO_CLIP
   EXPECT_EQ(ele1->cached->offset.x, 0); EXPECT_EQ( ele1->cached->offset.y, 200);
   EXPECT_EQ(ele1->cached->dim.x, 800); EXPECT_EQ(ele1->cached->dim.y, 200);
 #endif
   
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(widget, interned_descriptors)
+{
+  Sloth_Ctx sloth = {};
+  sloth.desc_evict_after_frames = 2;
+  
+  Sloth_Widget_Style parent_style = {
+    .color_bg = 0x333333FF,
+    .color_text = 0xFFFFFFFF,
+  };
+  Sloth_U32 parent_handle = sloth_style_register(&sloth, parent_style, 0);
+  
+  // inherited fields are resolved when the style is registered
+  Sloth_Widget_Style child_style = {
+    .color_bg = 0xFF00FFFF,
+    .inherit = Sloth_StyleInherit_ColorText,
+  };
+  Sloth_U32 child_handle = sloth_style_register(&sloth, child_style, parent_handle);
+  Sloth_Widget_Style* child = (Sloth_Widget_Style*)sloth_desc_table_get(&sloth.styles, child_handle);
+  EXPECT_EQ(child->color_bg, (Sloth_U32)0xFF00FFFF);
+  EXPECT_EQ(child->color_text, (Sloth_U32)0xFFFFFFFF);
+  EXPECT_EQ(child->inherit, (Sloth_U32)0);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  Sloth_Widget_Desc row_desc = {
+    .layout.width = SLOTH_SIZE_PIXELS(100),
+    .style.color_bg = 0x00FF00FF,
+  };
+  Sloth_Widget_Desc root_desc = { .style_handle = parent_handle };
+  sloth_push_widget(&sloth, root_desc, "root");
+  Sloth_Widget_Result row0 = sloth_push_widget(&sloth, row_desc, "row0"); sloth_pop_widget(&sloth);
+  Sloth_Widget_Result row1 = sloth_push_widget(&sloth, row_desc, "row1"); sloth_pop_widget(&sloth);
+  
+  // identical descriptors share one record
+  Sloth_Widget* w0 = sloth_widget_get(&sloth, row0.widget_index);
+  Sloth_Widget* w1 = sloth_widget_get(&sloth, row1.widget_index);
+  EXPECT_EQ(w0->style_handle, w1->style_handle);
+  EXPECT_EQ(w0->layout_handle, w1->layout_handle);
+  EXPECT_NE(w0->style_handle, parent_handle);
+  
+  // changing one widget's style doesn't change the one it shared with
+  Sloth_Widget_Style s = *sloth_widget_style(&sloth, w1);
+  s.color_bg = 0x0000FFFF;
+  sloth_widget_style_set(&sloth, w1, s);
+  EXPECT_NE(w0->style_handle, w1->style_handle);
+  EXPECT_EQ(sloth_widget_style(&sloth, w0)->color_bg, (Sloth_U32)0x00FF00FF);
+  
+  // inheriting from the parent widget at push time
+  row_desc.style.inherit = Sloth_StyleInherit_ColorText;
+  Sloth_Widget_Result row2 = sloth_push_widget(&sloth, row_desc, "row2"); sloth_pop_widget(&sloth);
+  EXPECT_EQ(sloth_widget_style(&sloth, row2.widget)->color_text, (Sloth_U32)0xFFFFFFFF);
+  
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  // unused descriptors get evicted, registered ones don't
+  // an unchanged layout keeps the handle it had last frame
+  Sloth_U32 live_styles = sloth.styles.live;
+  Sloth_U32 root_layout = 0;
+  for (Sloth_U32 i = 0; i < 4; i++) 
+  {
+    sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+    Sloth_Widget_Result root = sloth_push_widget(&sloth, root_desc, "root");
+    if (i == 0) root_layout = root.widget->layout_handle;
+    EXPECT_EQ(root.widget->layout_handle, root_layout);
+    EXPECT_EQ(root.widget->cached->layout_handle, root_layout);
+    sloth_pop_widget(&sloth);
+    sloth_frame_advance(&sloth);
+  }
+  EXPECT_LT(sloth.styles.live, live_styles);
+  EXPECT_EQ(sloth.styles.live, (Sloth_U32)2);
+  EXPECT_EQ(sloth_desc_table_get(&sloth.styles, child_handle), (Sloth_U8*)child);
+  
+  // a changed one is interned again
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  root_desc.layout.width = SLOTH_SIZE_PIXELS(50);
+  Sloth_Widget_Result root = sloth_push_widget(&sloth, root_desc, "root");
+  EXPECT_NE(root.widget->layout_handle, root_layout);
+  EXPECT_EQ(root.widget->cached->layout_handle, root.widget->layout_handle);
+  EXPECT_EQ(sloth_widget_layout(&sloth, root.widget)->width.value, 50.0f);
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(widget, cache_eviction)
+{
+  Sloth_Ctx sloth = {};
+  sloth.widget_cache_evict_after_frames = 4;
+  
+  // a widget that is pushed every frame, next to one that gets
+  // a new id every frame, like a label formatted from a value
+  Sloth_Widget_Desc d = {};
+  Sloth_U32 value = 42;
+  for (Sloth_U32 frame = 0; frame < 64; frame++)
+  {
+    sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+    Sloth_Widget_Result root = sloth_push_widget(&sloth, d, "root");
+    if (frame == 0) sloth_persistent_value_set(&sloth, root.widget->id, Sloth_U32, &value);
+    sloth_push_widget_f(&sloth, d, "###transient_%d", frame);
+    sloth_pop_widget(&sloth);
+    sloth_pop_widget(&sloth);
+    sloth_frame_advance(&sloth);
+  }
+  
+  // transient caches are freed within 2 * 4 frames of their last use
+  EXPECT_LE(sloth.widget_cache_lut.used, (Sloth_U32)(1 + (2 * 4) + 1));
+  Sloth_U32 pool_len = (sloth.widget_caches.bucket_at * sloth.widget_caches.bucket_cap) + sloth.widget_caches.bucket_at_len;
+  EXPECT_LE(pool_len, (Sloth_U32)(1 + (2 * 4) + 2));
+  
+  // the root's cache was kept alive by being pushed every frame
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  Sloth_Widget_Result root = sloth_push_widget(&sloth, d, "root");
+  Sloth_U32 fallback = 0;
+  Sloth_U32* cached = sloth_persistent_value_get(&sloth, root.widget->id, Sloth_U32, &fallback);
+  EXPECT_EQ(*cached, value);
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(widget, text_last_frame)
+{
+  Sloth_Ctx sloth = {};
+  Sloth_Widget_Desc d = {};
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(&sloth, d, "root");
+  Sloth_Widget_Result label = sloth_push_widget(&sloth, d, "hello###label");
+  sloth_pop_widget(&sloth);
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  Sloth_Widget_Text text = *sloth_widget_text(&sloth, label.widget);
+  EXPECT_EQ(text.glyphs_len, (Sloth_U32)5);
+  Sloth_Glyph_Layout first = text.glyphs[0];
+  Sloth_Glyph_Layout last = text.glyphs[4];
+  
+  // last frame's glyphs are still intact after the next frame has
+  // been prepared and has pushed text of its own
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(&sloth, d, "root");
+  label = sloth_push_widget(&sloth, d, "a much longer label###label");
+  Sloth_Widget_Text* prev = sloth_widget_text_last_frame(&sloth, label.widget);
+  EXPECT_EQ(prev->glyphs, text.glyphs);
+  EXPECT_EQ(prev->glyphs_len, (Sloth_U32)5);
+  EXPECT_EQ(prev->glyphs[0].glyph_id.value, first.glyph_id.value);
+  EXPECT_EQ(prev->glyphs[4].glyph_id.value, last.glyph_id.value);
+  EXPECT_EQ(prev->glyphs[4].bounds.value_min.x, last.bounds.value_min.x);
+  EXPECT_NE(sloth_widget_text(&sloth, label.widget)->glyphs, text.glyphs);
+  EXPECT_NE(sloth_frame_arena(&sloth), sloth_last_frame_arena(&sloth));
+  sloth_pop_widget(&sloth);
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  // an id that skips a frame has no last frame text when it comes
+  // back, since the arena its old glyphs were in has been reused
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(&sloth, d, "root");
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(&sloth, d, "root");
+  label = sloth_push_widget(&sloth, d, "hello###label");
+  prev = sloth_widget_text_last_frame(&sloth, label.widget);
+  EXPECT_EQ(prev->glyphs_len, (Sloth_U32)0);
+  EXPECT_EQ(prev->glyphs, (Sloth_Glyph_Layout*)0);
+  sloth_pop_widget(&sloth);
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(widget, text_layout_cache)
+{
+  Sloth_Ctx sloth = {};
+  Sloth_Widget* w = 0;
+  Sloth_Widget_Cached* cached = 0;
+  
+  cached = sloth_test_text_frame(&sloth, "hello world", 0, 64, 0, 0)->cached;
+  Sloth_U32 key = cached->text_layout_hash;
+  EXPECT_NE(key, (Sloth_U32)0);
+  EXPECT_EQ(cached->text_layout_len, (Sloth_U32)11);
+  
+  // unchanged text reuses the retained layout rather than redoing it
+  cached->text_layout_dim.x = 777;
+  w = sloth_test_text_frame(&sloth, "hello world", 0, 64, 0, 0);
+  cached = w->cached;
+  Sloth_V2 dim = sloth_widget_text(&sloth, w)->dim;
+  EXPECT_EQ(dim.x, 777.0f);
+  EXPECT_EQ(cached->text_layout_hash, key);
+  
+  // changing the text or the width it wraps at lays it out again
+  w = sloth_test_text_frame(&sloth, "hello there", 0, 64, 0, 0);
+  cached = w->cached;
+  dim = sloth_widget_text(&sloth, w)->dim;
+  EXPECT_NE(dim.x, 777.0f);
+  EXPECT_NE(cached->text_layout_hash, key);
+  Sloth_U32 text_key = cached->text_layout_hash;
+  
+  cached = sloth_test_text_frame(&sloth, "hello there", 0, 32, 0, 0)->cached;
+  EXPECT_NE(cached->text_layout_hash, text_key);
+  
+  // registering a glyph invalidates every retained layout
+  Sloth_U32 width_key = cached->text_layout_hash;
+  sloth.glyph_store.generation += 1;
+  cached = sloth_test_text_frame(&sloth, "hello there", 0, 32, 0, 0)->cached;
+  EXPECT_NE(cached->text_layout_hash, width_key);
+  
+  // a retained layout is only reused if its whole key matches, not 
+  // just the hash, and it was made from the same glyphs
+  cached->text_layout_dim.x = 777;
+  cached->text_layout_key.bounds_max_x += 1;
+  w = sloth_test_text_frame(&sloth, "hello there", 0, 32, 0, 0);
+  cached = w->cached;
+  dim = sloth_widget_text(&sloth, w)->dim;
+  EXPECT_NE(dim.x, 777.0f);
+  
+  cached->text_layout_dim.x = 777;
+  cached->text_layout_glyphs[0].glyph_id.value ^= 1;
+  w = sloth_test_text_frame(&sloth, "hello there", 0, 32, 0, 0);
+  cached = w->cached;
+  dim = sloth_widget_text(&sloth, w)->dim;
+  EXPECT_NE(dim.x, 777.0f);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+void
+sloth_test_atlas_updated(Sloth_Ctx* sloth, Sloth_U32 atlas_index, Sloth_Glyph_Atlas_Dirty_Rect* rects, Sloth_U32 rects_len) {}
+
+static Sloth_U32 sloth_test_glyphs_rasterized = 0;
+static Sloth_U32 sloth_test_glyph_batches = 0;
+
+// Registers codepoint as an 8x12 block that advances 9 pixels
+Sloth_Glyph_ID
+sloth_test_register_glyph(Sloth_Ctx* sloth, Sloth_Font_ID font_id, Sloth_U32 codepoint)
+{
+  static Sloth_U8 pixels[8 * 12];
+  Sloth_Glyph_Desc gd = {
+    .id = codepoint,
+    .data = pixels,
+    .src_width = 8,
+    .src_height = 12,
+    .stride = 8,
+    .format = Sloth_GlyphData_Alpha8,
+    .cursor_to_next_glyph = 9,
+  };
+  sloth_test_glyphs_rasterized += 1;
+  return sloth_register_glyph(sloth, gd);
+}
+
+// Registers every glyph the text line tests use
+void
+sloth_test_register_block_glyphs(Sloth_Ctx* sloth)
+{
+  sloth->renderer_atlas_updated = sloth_test_atlas_updated;
+  char* codepoints = "abcd \n";
+  for (char* c = codepoints; *c; c++)
+  {
+    sloth_test_register_glyph(sloth, (Sloth_Font_ID){}, (Sloth_U32)*c);
+  }
+}
+
+UTEST(text, line_breaking)
+{
+  Sloth_Ctx sloth = {};
+  sloth_test_register_block_glyphs(&sloth);
+  Sloth_Widget* w = 0;
+  
+  // breaks after the last space that fits, leaving it on the line
+  w = sloth_test_text_frame(&sloth, "aaa bbb cc", 0, 40, 0, 0);
+  Sloth_Widget_Text* t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(t->lines_len, (Sloth_U32)3);
+  EXPECT_EQ(t->lines[0].first, (Sloth_U32)0);
+  EXPECT_EQ(t->lines[0].one_past_last, (Sloth_U32)4);
+  EXPECT_EQ(t->lines[1].first, (Sloth_U32)4);
+  EXPECT_EQ(t->lines[1].one_past_last, (Sloth_U32)8);
+  EXPECT_EQ(t->lines[2].first, (Sloth_U32)8);
+  EXPECT_EQ(t->lines[2].one_past_last, (Sloth_U32)10);
+  EXPECT_EQ(t->lines[0].width, 35.0f);
+  EXPECT_EQ(t->lines[2].width, 17.0f);
+  EXPECT_EQ(t->lines[1].baseline, t->lines[0].baseline + 12);
+  EXPECT_EQ(t->lines[2].baseline, t->lines[0].baseline + 24);
+  EXPECT_EQ(t->dim.x, 35.0f);
+  EXPECT_EQ(t->dim.y, 36.0f);
+  EXPECT_TRUE((t->glyphs[4].flags & Sloth_GlyphLayout_IsLineStart) != 0);
+  EXPECT_EQ(t->glyphs[4].bounds.value_min.x, t->glyphs[0].bounds.value_min.x);
+  
+  // newlines end their line, and words longer than a line are 
+  // broken wherever they overflow
+  w = sloth_test_text_frame(&sloth, "ab\naaaaa", 0, 20, 0, 0);
+  t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(t->lines_len, (Sloth_U32)4);
+  EXPECT_EQ(t->lines[0].one_past_last, (Sloth_U32)3);
+  EXPECT_EQ(t->lines[0].width, 17.0f);
+  EXPECT_EQ(t->lines[1].first, (Sloth_U32)3);
+  EXPECT_EQ(t->lines[1].one_past_last, (Sloth_U32)5);
+  EXPECT_EQ(t->lines[2].one_past_last, (Sloth_U32)7);
+  EXPECT_EQ(t->lines[3].one_past_last, (Sloth_U32)8);
+  
+  // a glyph wider than the line stays on its own line rather than
+  // opening empty ones, and spaces may hang past the edge
+  w = sloth_test_text_frame(&sloth, "a b", 0, 4, 0, 0);
+  t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(t->lines_len, (Sloth_U32)2);
+  EXPECT_EQ(t->lines[0].one_past_last, (Sloth_U32)2);
+  
+  // every line is aligned, including the last
+  w = sloth_test_text_frame(&sloth, "aa", 0, 40, Sloth_TextStyle_Align_Center, 0);
+  t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(t->lines_len, (Sloth_U32)1);
+  EXPECT_EQ(t->glyphs[0].bounds.value_min.x - w->cached->bounds.value_min.x, 11.5f);
+  w = sloth_test_text_frame(&sloth, "aa", 0, 40, Sloth_TextStyle_Align_Right, 0);
+  t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(t->glyphs[1].bounds.value_max.x - w->cached->bounds.value_min.x, 40.0f);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(text, long_text)
+{
+  Sloth_Ctx sloth = {};
+  sloth_test_register_block_glyphs(&sloth);
+  Sloth_Widget* lw = 0;
+  Sloth_Widget* w = 0;
+  
+  // visible lines are laid out exactly as regular text would be
+  char* short_text = "aaa bbb cc\nab\naaaaa";
+  Sloth_U32 short_len = 19;
+  w = sloth_test_text_frame(&sloth, short_text, short_len, 40, 0, &lw);
+  Sloth_Widget_Text* lt = sloth_widget_text(&sloth, lw);
+  Sloth_Widget_Text* t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(lt->dim.x, t->dim.x);
+  EXPECT_EQ(lt->dim.y, t->dim.y);
+  EXPECT_EQ(lt->lines_len, t->lines_len);
+  EXPECT_EQ(lt->glyphs_len, t->glyphs_len);
+  for (Sloth_U32 i = 0; i < lt->glyphs_len && i < t->glyphs_len; i++)
+  {
+    EXPECT_EQ(lt->glyphs[i].bounds.value_min.x - lw->cached->bounds.value_min.x, 
+              t->glyphs[i].bounds.value_min.x - w->cached->bounds.value_min.x);
+    EXPECT_EQ(lt->glyphs[i].bounds.value_min.y, t->glyphs[i].bounds.value_min.y);
+    EXPECT_EQ(lt->glyphs[i].flags, t->glyphs[i].flags);
+  }
+  
+  // of 2001 lines, only the ones inside the 120 pixel tall root, 
+  // and one more, get glyphs
+  static char long_text[10010];
+  for (Sloth_U32 i = 0; i < 10010; i++) long_text[i] = "abcd\n"[i % 5];
+  w = sloth_test_text_frame(&sloth, long_text, 10000, 40, 0, &lw);
+  lt = sloth_widget_text(&sloth, lw);
+  EXPECT_EQ(lw->cached->long_text->lines_len, (Sloth_U32)2001);
+  EXPECT_EQ(lt->dim.y, 2001 * 12.0f);
+  EXPECT_EQ(lt->long_text_first_visible_line, (Sloth_U32)0);
+  EXPECT_EQ(lt->lines_len, (Sloth_U32)12);
+  EXPECT_EQ(lt->glyphs_len, (Sloth_U32)60);
+  EXPECT_TRUE((lt->glyphs[0].flags & Sloth_GlyphLayout_Draw) != 0);
+  EXPECT_TRUE((lt->glyphs[55].flags & Sloth_GlyphLayout_Draw) == 0);
+  
+  // appending to the same text extends the index
+  w = sloth_test_text_frame(&sloth, long_text, 10010, 40, 0, &lw);
+  EXPECT_EQ(lw->cached->long_text->lines_len, (Sloth_U32)2003);
+  EXPECT_EQ(lw->cached->long_text->indexed_len, (Sloth_U32)10010);
+  
+  // editing the last line in place is caught, even though the text
+  // neither moved nor shrank
+  static char edited[] = "ab\nabc";
+  w = sloth_test_text_frame(&sloth, edited, 0, 40, 0, &lw);
+  EXPECT_EQ(lw->cached->long_text->lines_len, (Sloth_U32)2);
+  edited[4] = '\n';
+  w = sloth_test_text_frame(&sloth, edited, 0, 40, 0, &lw);
+  EXPECT_EQ(lw->cached->long_text->lines_len, (Sloth_U32)3);
+  
+  // line height comes from the first codepoint, even when it isn't ascii
+  static Sloth_U8 tall_pixels[8 * 16];
+  Sloth_Glyph_Desc tall = {
+    .id = 0xE9,
+    .data = tall_pixels,
+    .src_width = 8,
+    .src_height = 16,
+    .stride = 8,
+    .format = Sloth_GlyphData_Alpha8,
+    .cursor_to_next_glyph = 9,
+  };
+  sloth_register_glyph(&sloth, tall);
+  w = sloth_test_text_frame(&sloth, "\xC3\xA9" "a", 3, 40, 0, &lw);
+  EXPECT_EQ(lw->cached->long_text->line_advance, 16.0f);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(text, utf8)
+{
+  // e acute, euro sign, grinning face
+  char* valid = "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+  Sloth_U32 at = 0;
+  EXPECT_EQ(sloth_utf8_decode(valid, 9, &at), (Sloth_U32)0xE9);
+  EXPECT_EQ(at, (Sloth_U32)2);
+  EXPECT_EQ(sloth_utf8_decode(valid, 9, &at), (Sloth_U32)0x20AC);
+  EXPECT_EQ(sloth_utf8_decode(valid, 9, &at), (Sloth_U32)0x1F600);
+  EXPECT_EQ(at, (Sloth_U32)9);
+  EXPECT_EQ(sloth_utf8_glyph_count(valid, 9), (Sloth_U32)3);
+  
+  // leading continuation, truncated, overlong, surrogate, and a
+  // stray continuation which is dropped
+  char* invalid = "\x80" "\xE2\x82" "a" "\xC0\xAF" "\xED\xA0\x80" "b\x80";
+  Sloth_U32 invalid_len = 11;
+  Sloth_U32 expected[] = { 0xFFFD, 0xFFFD, 'a', 0xFFFD, 0xFFFD, 'b' };
+  Sloth_U32 decoded = 0;
+  at = 0;
+  while (at < invalid_len && decoded < 6)
+  {
+    EXPECT_EQ(sloth_utf8_decode(invalid, invalid_len, &at), expected[decoded]);
+    decoded += 1;
+  }
+  EXPECT_EQ(at, invalid_len);
+  EXPECT_EQ(decoded, (Sloth_U32)6);
+  EXPECT_EQ(sloth_utf8_glyph_count(invalid, invalid_len), (Sloth_U32)6);
+  
+  // long enough to take the simd paths, with multibyte glyphs
+  // straddling 16 byte blocks
+  char mixed[100];
+  Sloth_U32 mixed_glyphs = 0;
+  for (Sloth_U32 i = 0; i + 2 <= 100; mixed_glyphs++)
+  {
+    if (mixed_glyphs % 7 == 6) { mixed[i++] = (char)0xC3; mixed[i++] = (char)0xA9; }
+    else mixed[i++] = 'a';
+  }
+  Sloth_U32 mixed_len = 0;
+  for (Sloth_U32 g = 0; g < mixed_glyphs; g++) mixed_len += (g % 7 == 6) ? 2 : 1;
+  EXPECT_EQ(sloth_utf8_glyph_count(mixed, mixed_len), mixed_glyphs);
+  
+  // widgets get one glyph per codepoint
+  Sloth_Ctx sloth = {};
+  sloth_test_register_block_glyphs(&sloth);
+  Sloth_Widget* w = 0;
+  w = sloth_test_text_frame(&sloth, "a\xC3\xA9" "b\xE2\x82\xAC", 0, 100, 0, 0);
+  Sloth_Widget_Text* t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(t->glyphs_len, (Sloth_U32)4);
+  EXPECT_EQ(t->glyphs_cap, (Sloth_U32)4);
+  EXPECT_TRUE(sloth_glyph_id_matches_charcode(t->glyphs[1].glyph_id, 0xE9));
+  EXPECT_TRUE(sloth_glyph_id_matches_charcode(t->glyphs[3].glyph_id, 0x20AC));
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+void
+sloth_test_register_glyphs(Sloth_Ctx* sloth, Sloth_Glyph_Request* requests, Sloth_U32 requests_len)
+{
+  sloth_test_glyph_batches += 1;
+  for (Sloth_U32 i = 0; i < requests_len; i++) 
+  {
+    sloth_test_register_glyph(sloth, requests[i].font, requests[i].codepoint);
+  }
+}
+
+UTEST(text, glyph_requests)
+{
+  Sloth_Ctx sloth = {};
+  sloth.renderer_atlas_updated = sloth_test_atlas_updated;
+  sloth.font_renderer_register_glyph = sloth_test_register_glyph;
+  sloth_test_glyphs_rasterized = 0;
+  
+  // unseen codepoints wait for sloth_frame_advance, once each. 
+  // "root" and "abca" have 6 between them
+  Sloth_Widget* w = 0;
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_push_widget(&sloth, (Sloth_Widget_Desc){}, "root");
+  sloth_push_widget(&sloth, (Sloth_Widget_Desc){}, "abca");
+  sloth_pop_widget(&sloth);
+  EXPECT_EQ(sloth.glyph_requests_len, (Sloth_U32)6);
+  EXPECT_EQ(sloth_test_glyphs_rasterized, (Sloth_U32)0);
+  sloth_pop_widget(&sloth);
+  sloth_frame_advance(&sloth);
+  EXPECT_EQ(sloth_test_glyphs_rasterized, (Sloth_U32)6);
+  EXPECT_EQ(sloth.glyph_requests_len, (Sloth_U32)0);
+  
+  w = sloth_test_text_frame(&sloth, "abca", 0, 100, 0, 0);
+  Sloth_Widget_Text* t = sloth_widget_text(&sloth, w);
+  EXPECT_EQ(sloth_test_glyphs_rasterized, (Sloth_U32)6);
+  EXPECT_EQ(t->dim.x, 35.0f);
+  
+  // renderers that can take the whole batch get it in one call
+  sloth.font_renderer_register_glyphs = sloth_test_register_glyphs;
+  sloth_test_text_frame(&sloth, "abcd ab", 0, 100, 0, 0);
+  EXPECT_EQ(sloth_test_glyphs_rasterized, (Sloth_U32)8);
+  EXPECT_EQ(sloth_test_glyph_batches, (Sloth_U32)1);
+  sloth_test_text_frame(&sloth, "abcd ab", 0, 100, 0, 0);
+  EXPECT_EQ(sloth_test_glyph_batches, (Sloth_U32)1);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+static Sloth_U32 sloth_test_atlas_uploads = 0;
+static Sloth_U32 sloth_test_atlas_uploaded_bytes = 0;
+
+// A renderer that uploads exactly the rects it's given
+void
+sloth_test_atlas_upload(Sloth_Ctx* sloth, Sloth_U32 atlas_index, Sloth_Glyph_Atlas_Dirty_Rect* rects, Sloth_U32 rects_len)
+{
+  sloth_test_atlas_uploads += 1;
+  for (Sloth_U32 i = 0; i < rects_len; i++)
+  {
+    sloth_test_atlas_uploaded_bytes += rects[i].width * rects[i].height * sizeof(Sloth_U32);
+  }
+}
+
+UTEST(render, atlas_dirty_rects)
+{
+  Sloth_Ctx sloth = {};
+  sloth.renderer_atlas_updated = sloth_test_atlas_upload;
+  sloth.font_renderer_register_glyph = sloth_test_register_glyph;
+  sloth_test_atlas_uploads = 0;
+  sloth_test_atlas_uploaded_bytes = 0;
+  
+  // a new atlas is uploaded whole
+  sloth_test_text_frame(&sloth, "ab", 0, 100, 0, 0);
+  Sloth_Glyph_Atlas* atlas = sloth.glyph_atlases + 0;
+  Sloth_U32 atlas_size = atlas->dim * atlas->dim * sizeof(Sloth_U32);
+  EXPECT_EQ(sloth_test_atlas_uploads, (Sloth_U32)1);
+  EXPECT_EQ(sloth_test_atlas_uploaded_bytes, atlas_size);
+  
+  // after that, only new glyphs and their aprons are. Each 8x12 
+  // glyph is a 10x14 rect
+  Sloth_U32 glyph_size = 10 * 14 * sizeof(Sloth_U32);
+  sloth_test_atlas_uploads = 0;
+  sloth_test_atlas_uploaded_bytes = 0;
+  sloth_test_text_frame(&sloth, "abcd", 0, 100, 0, 0);
+  EXPECT_EQ(sloth_test_atlas_uploads, (Sloth_U32)1);
+  EXPECT_EQ(sloth_test_atlas_uploaded_bytes, 2 * glyph_size);
+  
+  sloth_test_atlas_uploads = 0;
+  sloth_test_text_frame(&sloth, "abcd", 0, 100, 0, 0);
+  EXPECT_EQ(sloth_test_atlas_uploads, (Sloth_U32)0);
+  
+  // past SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX rects, new ones are merged
+  // into existing ones, which covers more than was written but still
+  // less than the whole atlas
+  Sloth_U32 glyphs = SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX * 2;
+  for (Sloth_U32 i = 0; i < glyphs; i++) {
+    sloth_test_register_glyph(&sloth, (Sloth_Font_ID){}, 0x100 + i);
+  }
+  EXPECT_EQ(atlas->dirty_rects_len, (Sloth_U32)SLOTH_GLYPH_ATLAS_DIRTY_RECTS_MAX);
+  sloth_test_atlas_uploaded_bytes = 0;
+  sloth_test_text_frame(&sloth, "abcd", 0, 100, 0, 0);
+  EXPECT_GE(sloth_test_atlas_uploaded_bytes, glyphs * glyph_size);
+  EXPECT_LT(sloth_test_atlas_uploaded_bytes, atlas_size);
+  EXPECT_EQ(atlas->dirty_rects_len, (Sloth_U32)0);
+  
+  // glyphs added to a grown atlas don't downgrade it from a whole upload
+  sloth_glyph_atlas_resize(atlas, atlas->dim * 2);
+  sloth_test_register_glyph(&sloth, (Sloth_Font_ID){}, 0x200);
+  EXPECT_EQ(atlas->dirty_state, Sloth_GlyphAtlas_Dirty_Grow);
+  sloth_test_atlas_uploaded_bytes = 0;
+  sloth_test_text_frame(&sloth, "abcd", 0, 100, 0, 0);
+  EXPECT_EQ(sloth_test_atlas_uploaded_bytes, atlas_size * 4);
+  
+  sloth_frame_prepare(&sloth, (Sloth_Frame_Desc){});
+  sloth_ctx_free(&sloth);
+}
+
+UTEST(text, glyph_cache)
+{
+  Sloth_Ctx sloth = {};
+  sloth.renderer_atlas_updated = sloth_test_atlas_updated;
+  sloth.font_renderer_register_glyph = sloth_test_register_glyph;
+  sloth.font_renderer_register_glyphs = sloth_test_register_glyphs;
+  sloth_test_glyphs_rasterized = 0;
+  sloth_test_glyph_batches = 0;
+  
+  // digits overlap ascii, and the last range takes the store past 
+  // its first 256 glyphs
+  Sloth_Codepoint_Range ranges[] = {
+    SLOTH_CODEPOINTS_ASCII,
+    SLOTH_CODEPOINTS_DIGITS,
+    SLOTH_CODEPOINTS_LATIN1,
+    { 0x100, 0x180 },
+  };
+  Sloth_Font_ID font = {};
+  sloth_font_prewarm(&sloth, font, ranges, 4);
+  Sloth_Glyph_Store* store = &sloth.glyph_store;
+  EXPECT_EQ(store->glyphs_table.used, (Sloth_U32)(95 + 96 + 128));
+  EXPECT_EQ(sloth_test_glyphs_rasterized, store->glyphs_table.used);
+  EXPECT_EQ(sloth_test_glyph_batches, (Sloth_U32)1);
+  for (Sloth_U32 i = 0; i < store->glyphs_table.used; i++)
+  {
+    Sloth_U8* glyph = sloth_hashtable_get(&store->glyphs_table, store->ids[i].value);
+    EXPECT_EQ(glyph, (Sloth_U8*)(store->glyphs + i));
+  }
+  
+  Sloth_U32 size = sloth_glyph_cache_size(&sloth);
+  Sloth_U8* cache = (Sloth_U8*)malloc(size);
+  EXPECT_EQ(sloth_glyph_cache_write(&sloth, cache, size - 1), (Sloth_U32)0);
+  EXPECT_EQ(sloth_glyph_cache_write(&sloth, cache, size), size);
+  
+  // a store that already has glyphs can't be loaded into
+  EXPECT_FALSE(sloth_glyph_cache_load(&sloth, cache, size));
+  
+  Sloth_Ctx loaded = {};
+  EXPECT_FALSE(sloth_glyph_cache_load(&loaded, cache, size - 1));
+  cache[0] += 1;
+  EXPECT_FALSE(sloth_glyph_cache_load(&loaded, cache, size));
+  cache[0] -= 1;
+  EXPECT_EQ(loaded.glyph_store.glyphs_table.used, (Sloth_U32)0);
+  EXPECT_TRUE(sloth_glyph_cache_load(&loaded, cache, size));
+  
+  Sloth_Glyph_Store* loaded_store = &loaded.glyph_store;
+  EXPECT_EQ(loaded_store->glyphs_table.used, store->glyphs_table.used);
+  for (Sloth_U32 i = 0; i < store->glyphs_table.used; i++)
+  {
+    Sloth_Glyph* a = (Sloth_Glyph*)sloth_hashtable_get(&store->glyphs_table, store->ids[i].value);
+    Sloth_Glyph* b = (Sloth_Glyph*)sloth_hashtable_get(&loaded_store->glyphs_table, store->ids[i].value);
+    ASSERT_TRUE(b != 0);
+    EXPECT_EQ(a->offset_x, b->offset_x);
+    EXPECT_EQ(a->offset_y, b->offset_y);
+    EXPECT_EQ(a->src_width, b->src_width);
+    EXPECT_EQ(a->x_advance, b->x_advance);
+  }
+  
+  Sloth_Glyph_Atlas* atlas = sloth.glyph_atlases;
+  Sloth_Glyph_Atlas* loaded_atlas = loaded.glyph_atlases;
+  EXPECT_EQ(loaded_atlas->dim, atlas->dim);
+  EXPECT_EQ(loaded_atlas->skyline_len, atlas->skyline_len);
+  EXPECT_EQ(memcmp(loaded_atlas->skyline, atlas->skyline, atlas->skyline_len * sizeof(Sloth_Skyline_Node)), 0);
+  EXPECT_EQ(memcmp(loaded_atlas->data, atlas->data, atlas->dim * atlas->dim * 4), 0);
+  
+  // glyphs registered after loading carry on from the cached ones
+  loaded.font_renderer_register_glyph = sloth_test_register_glyph;
+  sloth_test_register_glyph(&loaded, font, 0x200);
+  sloth_test_register_glyph(&sloth, font, 0x200);
+  Sloth_U32 last = store->glyphs_table.used - 1;
+  EXPECT_EQ(loaded_store->glyphs[last].offset_x, store->glyphs[last].offset_x);
+  EXPECT_EQ(loaded_store->glyphs[last].offset_y, store->glyphs[last].offset_y);
+  
+  free(cache);
+  sloth_glyph_store_free(store);
+  sloth_glyph_store_free(loaded_store);
+  sloth_ctx_free(&loaded);
   sloth_ctx_free(&sloth);
 }
 
 #define SLOTH_IMPLEMENTATION 1
 #include "../src/sloth.h"
 
+UTEST(text, glyph_cache_atlas_dim)
+{
+  Sloth_Ctx sloth = {};
+  Sloth_Glyph_Desc gd = {
+    .id = 1,
+    .src_width = 4,
+    .src_height = 4,
+    .format = Sloth_GlyphData_RGBA8,
+  };
+  sloth_register_glyph(&sloth, gd);
+  Sloth_U32 size = sloth_glyph_cache_size(&sloth);
+  Sloth_U8* cache = (Sloth_U8*)malloc(size);
+  EXPECT_EQ(sloth_glyph_cache_write(&sloth, cache, size), size);
+  
+  // an atlas dim past SLOTH_GLYPH_ATLAS_MAX_DIM is rejected before
+  // dim * dim * 4 is computed. 65536 * 65536 * 4 wraps to 0 in a U32
+  Sloth_Glyph_Cache_Atlas_* cached = (Sloth_Glyph_Cache_Atlas_*)(cache + sizeof(Sloth_Glyph_Cache_Header_));
+  Sloth_U32 dim = cached->dim;
+  Sloth_U32 bad_dims[] = { 65536, SLOTH_GLYPH_ATLAS_MAX_DIM * 2, dim + 1 };
+  for (Sloth_U32 i = 0; i < 3; i++)
+  {
+    Sloth_Ctx loaded = {};
+    cached->dim = bad_dims[i];
+    EXPECT_FALSE(sloth_glyph_cache_load(&loaded, cache, size));
+    EXPECT_EQ(loaded.glyph_atlases_cap, (Sloth_U32)0);
+    sloth_ctx_free(&loaded);
+  }
+  
+  Sloth_Ctx loaded = {};
+  cached->dim = dim;
+  EXPECT_TRUE(sloth_glyph_cache_load(&loaded, cache, size));
+  
+  free(cache);
+  sloth_glyph_store_free(&sloth.glyph_store);
+  sloth_glyph_store_free(&loaded.glyph_store);
+  sloth_ctx_free(&loaded);
+  sloth_ctx_free(&sloth);
+}
+
 UTEST(math, is_pow2)
 {
   EXPECT_TRUE(sloth_is_pow2(2048));
@@ -660,4 +1745,166 @@ UTEST(math, remap)
   EXPECT_EQ(v2, 6.5f);
 }
 
+UTEST(render, vertex_layout)
+{
+  Sloth_VIBuffer vibuf = {};
+  Sloth_Rect bounds = {
+    .value_min = { .x = 10, .y = 20 },
+    .value_max = { .x = 30, .y = 40 },
+  };
+  Sloth_V2 uv_min = { .x = 0.25f, .y = 0 };
+  Sloth_V2 uv_max = { .x = 1, .y = 0.5f };
+  Sloth_U32 v0 = sloth_render_quad_ptc(&vibuf, bounds, 0.5f, uv_min, uv_max, 0x336699FF);
+  EXPECT_EQ(v0, (Sloth_U32)0);
+  EXPECT_EQ(vibuf.verts_len, (Sloth_U32)(4 * SLOTH_VERTEX_STRIDE));
+  EXPECT_EQ(vibuf.indices_len, (Sloth_U32)6);
+  
+  Sloth_R32* v2 = vibuf.verts + (2 * SLOTH_VERTEX_STRIDE);
+  EXPECT_EQ(v2[0], 30.0f);
+  EXPECT_EQ(v2[1], 40.0f);
+  EXPECT_EQ(v2[2], 0.5f);
+#if SLOTH_VERTEX_PACKED
+  Sloth_U16 uv[2];
+  sloth_copy_memory(uv, v2 + 3, sizeof(uv));
+  EXPECT_EQ(uv[0], (Sloth_U16)65535);
+  EXPECT_EQ(uv[1], (Sloth_U16)32768);
+  Sloth_U8* color = (Sloth_U8*)(v2 + 4);
+  EXPECT_EQ(color[0], (Sloth_U8)0x33);
+  EXPECT_EQ(color[1], (Sloth_U8)0x66);
+  EXPECT_EQ(color[2], (Sloth_U8)0x99);
+  EXPECT_EQ(color[3], (Sloth_U8)0xFF);
+#else
+  EXPECT_EQ(v2[3], 1.0f);
+  EXPECT_EQ(v2[4], 0.5f);
+  EXPECT_EQ(v2[5], 0x33 / 255.0f);
+  EXPECT_EQ(v2[8], 1.0f);
+#endif
+  
+  sloth_vibuffer_free(&vibuf);
+}
+
+UTEST(render, vibuffer_batches)
+{
+  Sloth_VIBuffer vibuf = {};
+  Sloth_Rect bounds = {
+    .value_min = { .x = 0, .y = 0 },
+    .value_max = { .x = 1, .y = 1 },
+  };
+  Sloth_V2 uv = { .x = 0, .y = 0 };
+  
+  // a single vert leaves the remaining quads misaligned with the
+  // batch boundary, so a quad would straddle it if it weren't reserved
+  sloth_vibuffer_push_vert(&vibuf, 0, 0, 0, 0, 0, sloth_vertex_color(0xFFFFFFFF));
+  Sloth_U32 quads = SLOTH_VIBUFFER_BATCH_VERTS / 4;
+  Sloth_U32 last_v0 = 0;
+  for (Sloth_U32 i = 0; i < quads; i++) {
+    last_v0 = sloth_render_quad_ptc(&vibuf, bounds, 0, uv, uv, 0xFFFFFFFF);
+  }
+  EXPECT_EQ(vibuf.verts_len / SLOTH_VERTEX_STRIDE, 1 + (quads * 4));
+  EXPECT_EQ(vibuf.indices_len, quads * 6);
+  
+  ASSERT_EQ(vibuf.batches_len, (Sloth_U32)2);
+  Sloth_VIBuffer_Batch b1 = vibuf.batches[1];
+  EXPECT_EQ(vibuf.batches[0].first_vert, (Sloth_U32)0);
+  EXPECT_EQ(vibuf.batches[0].first_index, (Sloth_U32)0);
+  EXPECT_EQ(b1.first_vert, last_v0);
+  EXPECT_EQ(b1.first_index, (quads - 1) * 6);
+  EXPECT_EQ(sloth_vibuffer_batch_indices_len(&vibuf, 0), (quads - 1) * 6);
+  EXPECT_EQ(sloth_vibuffer_batch_indices_len(&vibuf, 1), (Sloth_U32)6);
+  
+  // indices are relative to their batch's first vert
+  Sloth_U16* last_quad = vibuf.indices + b1.first_index;
+  EXPECT_EQ(last_quad[0], (Sloth_U16)0);
+  EXPECT_EQ(last_quad[1], (Sloth_U16)1);
+  EXPECT_EQ(last_quad[2], (Sloth_U16)2);
+  EXPECT_EQ(last_quad[5], (Sloth_U16)3);
+  Sloth_U16* prev_quad = vibuf.indices + b1.first_index - 6;
+  EXPECT_EQ(prev_quad[1], (Sloth_U16)(last_v0 - 3));
+  
+  sloth_vibuffer_reset(&vibuf);
+  EXPECT_EQ(vibuf.batches_len, (Sloth_U32)0);
+  sloth_render_quad_ptc(&vibuf, bounds, 0, uv, uv, 0xFFFFFFFF);
+  EXPECT_EQ(vibuf.batches_len, (Sloth_U32)1);
+  EXPECT_EQ(vibuf.indices[3], (Sloth_U16)0);
+  
+  sloth_vibuffer_free(&vibuf);
+}
+
+UTEST(render, atlas_merged)
+{
+  Sloth_Ctx sloth = {};
+  Sloth_Glyph_Desc gd = {
+    .id = 1,
+    .src_width = 4,
+    .src_height = 4,
+    .format = Sloth_GlyphData_RGBA8,
+  };
+  Sloth_Glyph_ID a = sloth_register_glyph(&sloth, gd);
+  EXPECT_EQ(sloth.glyph_atlases_merged_dim, (Sloth_U32)SLOTH_GLYPH_ATLAS_START_DIM);
+  
+  // a second, bigger atlas sets the tile size for every atlas, and 
+  // is placed in the next tile along
+  gd.family = 1;
+  gd.src_width = SLOTH_GLYPH_ATLAS_START_DIM;
+  Sloth_Glyph_ID b = sloth_register_glyph(&sloth, gd);
+  Sloth_U32 tile_dim = SLOTH_GLYPH_ATLAS_START_DIM * 2;
+  EXPECT_EQ(sloth.glyph_atlases[1].dim, tile_dim);
+  EXPECT_EQ(sloth.glyph_atlases_tile_dim, tile_dim);
+  EXPECT_EQ(sloth.glyph_atlases_merged_dim, tile_dim * 2);
+  
+  Sloth_U32 x, y;
+  sloth_glyph_atlas_merged_origin_(&sloth, sloth.glyph_atlases + 1, &x, &y);
+  EXPECT_EQ(x, tile_dim);
+  EXPECT_EQ(y, (Sloth_U32)0);
+  
+  // a third wraps to the next row
+  gd.family = 2;
+  gd.src_width = 4;
+  sloth_register_glyph(&sloth, gd);
+  sloth_glyph_atlas_merged_origin_(&sloth, sloth.glyph_atlases + 2, &x, &y);
+  EXPECT_EQ(x, (Sloth_U32)0);
+  EXPECT_EQ(y, tile_dim);
+  
+#if SLOTH_ATLAS_MERGED
+  Sloth_Glyph_Info info = sloth_lookup_glyph(&sloth, b);
+  EXPECT_EQ(info.uv.value_min.x, (Sloth_R32)(tile_dim + 1) / (tile_dim * 2));
+  EXPECT_EQ(info.uv.value_min.y, (Sloth_R32)1 / (tile_dim * 2));
+  EXPECT_EQ(sloth_get_vibuffer_for_glyph(&sloth, b), sloth.vibuffers + 0);
+#else
+  EXPECT_EQ(sloth_get_vibuffer_for_glyph(&sloth, b), sloth.vibuffers + 1);
+#endif
+  EXPECT_EQ(sloth_get_vibuffer_for_glyph(&sloth, a), sloth.vibuffers + 0);
+  
+  // rows are ceil(sqrt(tiles)) long, so five tiles are three rows
+  // of three rather than four of four
+  gd.family = 3;
+  sloth_register_glyph(&sloth, gd);
+  gd.family = 4;
+  sloth_register_glyph(&sloth, gd);
+  EXPECT_EQ(sloth.glyph_atlases_merged_tiles_per_row, (Sloth_U32)3);
+  EXPECT_EQ(sloth.glyph_atlases_merged_dim, tile_dim * 3);
+  sloth_glyph_atlas_merged_origin_(&sloth, sloth.glyph_atlases + 4, &x, &y);
+  EXPECT_EQ(x, tile_dim);
+  EXPECT_EQ(y, tile_dim);
+  EXPECT_TRUE(sloth.glyph_atlases_merged);
+  
+  // past the renderer's max texture size, every atlas is drawn from 
+  // its own texture again, and has to be uploaded again
+  for (Sloth_U32 i = 0; i < 5; i++) sloth.glyph_atlases[i].dirty_state = Sloth_GlyphAtlas_Clean;
+  sloth.glyph_atlases_merged_max_dim = tile_dim * 2;
+  gd.family = 5;
+  sloth_register_glyph(&sloth, gd);
+  EXPECT_FALSE(sloth.glyph_atlases_merged);
+  EXPECT_EQ(sloth.glyph_atlases_merged_dim, (Sloth_U32)0);
+  Sloth_Glyph_Info unmerged = sloth_lookup_glyph(&sloth, b);
+  EXPECT_EQ(unmerged.uv.value_min.x, (Sloth_R32)1 / tile_dim);
+  EXPECT_EQ(sloth_get_vibuffer_for_glyph(&sloth, b), sloth.vibuffers + 1);
+#if SLOTH_ATLAS_MERGED
+  EXPECT_EQ(sloth.glyph_atlases[1].dirty_state, Sloth_GlyphAtlas_Dirty_Grow);
+#endif
+  
+  sloth_glyph_store_free(&sloth.glyph_store);
+  sloth_ctx_free(&sloth);
+}
+
 UTEST_MAIN();
@@ -29,10 +29,10 @@ sloth_test_strings_equal(char* a, char* b)
 
 // Naive string sizing
 Sloth_V2
-sloth_test_get_text_size(Sloth_Widget* widget)
+sloth_test_get_text_size(Sloth_Ctx* sloth, Sloth_Widget* widget)
 {
   Sloth_V2 result = {
-    .x = widget->text_len * 14,
+    .x = sloth_widget_text(sloth, widget)->glyphs_len * 14,
     .y = 14,
   };
   return result;
@@ -58,7 +58,7 @@ sloth_inspector_find_widget(Sloth_Ctx* sloth, Sloth_ID id)
 {
   Sloth_Widget* result = 0;
   Sloth_Widget_Pool pool = sloth->widgets;
-  for (Sloth_U32 i = 0; i < pool.len; i++)
+  for (Sloth_U32 i = 1; i < pool.len; i++) // index 0 is reserved
   {
     Sloth_Widget* at = pool.values + i;
     if (sloth_ids_equal(at->id, id)) {
@@ -166,6 +166,8 @@ sloth_inspector_print_widget_style(Sloth_Ctx* sloth, Sloth_Widget_Style style, c
 }
 
 static Sloth_Widget sloth_inspector_last_hot_widget;
+static Sloth_Widget_Layout sloth_inspector_last_hot_widget_layout;
+static Sloth_Widget_Style sloth_inspector_last_hot_widget_style;
 static Sloth_Bool   sloth_inspector_show_texture_atlas;
 static Sloth_U32    sloth_inspector_active_atlas;
 
@@ -177,6 +179,8 @@ sloth_inspector_prepare(Sloth_Ctx* sloth)
     Sloth_Widget* lhw = sloth_inspector_find_widget(sloth, sloth->hot_widget);
     if (lhw) {
       sloth_inspector_last_hot_widget = *lhw;
+      sloth_inspector_last_hot_widget_layout = *sloth_widget_layout(sloth, lhw);
+      sloth_inspector_last_hot_widget_style = *sloth_widget_style(sloth, lhw);
     }
   }
 }
@@ -221,6 +225,21 @@ sloth_inspector_onscreen(Sloth_Ctx* sloth)
       Sloth_V2 uv_min, uv_max;
       uv_min.x = 0; uv_min.y = 0;
       uv_max.x = 1; uv_max.y = 1;
+#if SLOTH_ATLAS_MERGED
+      // the atlas is one tile of the merged texture
+      if (sloth->glyph_atlases_merged) {
+        if (atlas->data) {
+          Sloth_U32 tile_x, tile_y;
+          sloth_glyph_atlas_merged_origin_(sloth, atlas, &tile_x, &tile_y);
+          Sloth_R32 merged_dim = (Sloth_R32)sloth->glyph_atlases_merged_dim;
+          uv_min.x = tile_x / merged_dim;
+          uv_min.y = tile_y / merged_dim;
+          uv_max.x = (tile_x + atlas->dim) / merged_dim;
+          uv_max.y = (tile_y + atlas->dim) / merged_dim;
+        }
+        vibuf = sloth->vibuffers + 0;
+      }
+#endif
       sloth_render_quad_ptc(vibuf, tex_bounds, 0, uv_min, uv_max, 0xFFFFFFFF);
     }
     
@@ -228,8 +247,8 @@ sloth_inspector_onscreen(Sloth_Ctx* sloth)
       Sloth_Widget hot_widget = sloth_inspector_last_hot_widget;
       sloth_cmp_text_f(sloth, 0, 0xFFFFFFFF, "Hot Widget##si");
       sloth_cmp_text_f(sloth, 0, 0xFFFFFFFF, "ID: %u##si", hot_widget.id);
-      sloth_inspector_print_widget_layout(sloth, hot_widget.layout, "Layout", "hot_widget");
-      sloth_inspector_print_widget_style(sloth, hot_widget.style, "Style", "hot_widget");
+      sloth_inspector_print_widget_layout(sloth, sloth_inspector_last_hot_widget_layout, "Layout", "hot_widget");
+      sloth_inspector_print_widget_style(sloth, sloth_inspector_last_hot_widget_style, "Style", "hot_widget");
     }
   }
   sloth_pop_widget_safe(sloth, r0);
@@ -205,7 +205,7 @@ sp_init(Sloth_Ctx* sloth, SP_U32 frames_cap)
   
   sp_pctx_ = SP_MALLOC(Sloth_Profiler_Ctx, 1);
   *sp_pctx_ = (Sloth_Profiler_Ctx){
-    // Sloth_Hashtable has a default size of 2048
+    // Sloth_Hashtable allocates itself on first use
     .scope_ids = {},
     .scopes = SP_MALLOC(Sloth_Profiler_Scope, 2048),
     .scopes_cap = 2048,
@@ -522,15 +522,18 @@ sp_button_f(char* fmt, ...)
   
   va_list args; va_start(args, fmt);
   Sloth_Widget_Result r = sloth_push_widget_v(sp_ctx_, desc, fmt, args);
-  if (sloth_ids_equal(r.widget->id, sp_ctx_->hot_widget)) {
-    r.widget->style.color_bg = 0xFFFFFFFF;
-    r.widget->style.color_text = 0x000000FF;
+  Sloth_Widget_Style style = *sloth_widget_style(sp_ctx_, r.widget);
+  bool is_hot = sloth_ids_equal(r.widget->id, sp_ctx_->hot_widget);
+  if (is_hot) {
+    style.color_bg = 0xFFFFFFFF;
+    style.color_text = 0x000000FF;
   }
   if (r.clicked) {
     result = true;
-    r.widget->style.color_bg = 0x00FFFFFF;
-    r.widget->style.color_text = 0x000000FF;
+    style.color_bg = 0x00FFFFFF;
+    style.color_text = 0x000000FF;
   }
+  if (is_hot || r.clicked) sloth_widget_style_set(sp_ctx_, r.widget, style);
   sloth_pop_widget(sp_ctx_);
   va_end(args);
   
@@ -616,10 +619,14 @@ sp_frame_bar(SP_U32 frame_i)
     for (SP_U32 i = 0; i < sp_pctx_->frames_cap; i++) {
       r = sloth_push_widget_f(sp_ctx_, frame_box_desc, "###frame_bar_%d", i);
       if (i == frame_i) {
-        r.widget->style.color_bg = 0x00FFFFFF;
+        Sloth_Widget_Style style = *sloth_widget_style(sp_ctx_, r.widget);
+        style.color_bg = 0x00FFFFFF;
+        sloth_widget_style_set(sp_ctx_, r.widget, style);
       }
       if (sloth_ids_equal(r.widget->id, sp_ctx_->hot_widget)) {
-        r.widget->style.color_bg = 0x00FF00FF;
+        Sloth_Widget_Style style = *sloth_widget_style(sp_ctx_, r.widget);
+        style.color_bg = 0x00FF00FF;
+        sloth_widget_style_set(sp_ctx_, r.widget, style);
         popup_frame = i;
         if (sloth_mouse_button_is_down(sp_ctx_->mouse_button_l))
         {
@@ -676,6 +683,52 @@ sp_frame_header(Sloth_Profiler_Frame* frame, SP_U32 frame_i)
   sloth_pop_widget(sp_ctx_);
 }
 
+void
+sp_hashtable_stats_row(char* name, Sloth_Hashtable* table)
+{
+  Sloth_Widget_Desc row_desc = {
+    .layout = {
+      .width = SLOTH_SIZE_PERCENT_OF_PARENT(1),
+      .height = SLOTH_SIZE_TEXT_CONTENT(),
+      .margin = sloth_size_box_uniform_pixels(4),
+    },
+    .style = {
+      .color_text = 0xFFFFFFFF,
+    },
+  };
+  
+  Sloth_Hashtable_Stats stats = sloth_hashtable_stats(table);
+  sloth_push_widget_f(sp_ctx_, row_desc, "%s: %u/%u (%.2f load, %u rehashes) probes avg %.2f max %u###profiler_table_%s",
+    name, stats.used, stats.cap, stats.load, stats.rehashes, 
+    stats.lookup_probe_avg, stats.lookup_probe_max, name);
+  sloth_pop_widget(sp_ctx_);
+  
+  // per frame lookup stats
+  sloth_hashtable_stats_reset(table);
+}
+
+// frame is the cycle making up the last full frame. Rows for frames
+// that had to grow the arena are red
+void
+sp_arena_stats_row(char* name, Sloth_Arena_Stats stats, Sloth_Arena_Cycle_Stats frame)
+{
+  Sloth_Widget_Desc row_desc = {
+    .layout = {
+      .width = SLOTH_SIZE_PERCENT_OF_PARENT(1),
+      .height = SLOTH_SIZE_TEXT_CONTENT(),
+      .margin = sloth_size_box_uniform_pixels(4),
+    },
+    .style = {
+      .color_text = frame.grows > 0 ? 0xFF6060FF : 0xFFFFFFFF,
+    },
+  };
+  
+  sloth_push_widget_f(sp_ctx_, row_desc, "%s: %.1fkb in %u pushes, peak %.1fkb (max %.1fkb), %u grows, %.1fkb wasted, %.1fkb committed###profiler_arena_%s",
+    name, frame.pushed / 1024.0, frame.pushes, frame.peak / 1024.0, stats.peak_max / 1024.0,
+    frame.grows, frame.wasted / 1024.0, stats.committed / 1024.0, name);
+  sloth_pop_widget(sp_ctx_);
+}
+
 Sloth_U32 sp_calls_visualized = 0;
 
 void
@@ -871,6 +924,14 @@ sp_draw()
   {
     pause_recording = sp_frame_bar(frame_i);    
     sp_frame_header(frame, frame_i);
+    sp_hashtable_stats_row("widget_cache_lut", &sp_ctx_->widget_cache_lut);
+    sp_hashtable_stats_row("glyphs_table", &sp_ctx_->glyph_store.glyphs_table);
+    // the last frame arena hasn't been cleared since last frame, 
+    // while scratch was cleared at the start of this one
+    Sloth_Arena_Stats frame_stats = sloth_arena_stats(sloth_last_frame_arena(sp_ctx_));
+    Sloth_Arena_Stats scratch_stats = sloth_arena_stats(&sp_ctx_->scratch);
+    sp_arena_stats_row("frame_memory", frame_stats, frame_stats.cycle);
+    sp_arena_stats_row("scratch", scratch_stats, scratch_stats.last_cycle);
     sp_flame_graph(frame, 800 - 32);
     
     Sloth_Widget_Desc d = {